@@ -45,7 +45,7 @@ check_early_opts (int        *argc,
    * replace it into an escaped string suitable to pass as the value
    * for `-c 'command ...'.
    *
-   * However, if we see --tab, --new-window, or --tab-with-profile,
+   * However, if we see --tab, --new-window, --tab-with-profile, or --layout,
    * then we will not use standalone mode.
    */
   for (int i = 0; i < *argc; i++)
@@ -54,6 +54,7 @@ check_early_opts (int        *argc,
 
       if (g_str_equal (arg, "--tab") ||
           g_str_equal (arg , "--new-window") ||
+          (g_str_equal (arg, "--layout") || g_str_has_prefix (arg, "--layout=")) ||
           (g_str_equal (arg, "--tab-with-profile") || g_str_has_prefix (arg, "--tab-with-profile=")))
         ignore_standalone = TRUE;
 
@@ -0,0 +1,264 @@
+#!/usr/bin/env python3
+#
+# compile_palettes.py
+#
+# Copyright 2025 Christian Hergert <chergert@redhat.com>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+
+# Compiles .palette files into a static table of PtyxisPaletteTableEntry
+# so that they do not need to be parsed at runtime. Only the colors found
+# in the file are stored. Derived colors are filled in by PtyxisPalette
+# when a palette is materialized so that logic lives in one place.
+
+import math
+import os
+import struct
+import sys
+
+REQUIRED = ['Foreground', 'Background'] + ['Color%d' % i for i in range(16)]
+
+# Must match PtyxisPaletteKey in ptyxis-palette-private.h
+OPTIONAL = [
+    ('TitlebarForeground', 'titlebar_foreground'),
+    ('TitlebarBackground', 'titlebar_background'),
+    ('BellForeground', 'scarves[PTYXIS_PALETTE_SCARF_VISUAL_BELL].foreground'),
+    ('BellBackground', 'scarves[PTYXIS_PALETTE_SCARF_VISUAL_BELL].background'),
+    ('SuperuserForeground', 'scarves[PTYXIS_PALETTE_SCARF_SUPERUSER].foreground'),
+    ('SuperuserBackground', 'scarves[PTYXIS_PALETTE_SCARF_SUPERUSER].background'),
+    ('RemoteForeground', 'scarves[PTYXIS_PALETTE_SCARF_REMOTE].foreground'),
+    ('RemoteBackground', 'scarves[PTYXIS_PALETTE_SCARF_REMOTE].background'),
+]
+
+ZERO = (0.0, 0.0, 0.0, 0.0)
+
+
+class PaletteError(Exception):
+    pass
+
+
+def load_key_file(path):
+    groups = {}
+    group = None
+
+    with open(path, encoding='utf-8') as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            if line.startswith('[') and line.endswith(']'):
+                group = groups.setdefault(line[1:-1], {})
+                continue
+            if group is None or '=' not in line:
+                raise PaletteError('"%s" is not a valid key file' % path)
+            key, value = line.split('=', 1)
+            group[key.strip()] = value.strip()
+
+    return groups
+
+
+def parse_color(path, group, key, value):
+    # Only the forms used by palettes are supported, anything
+    # else fails the build rather than silently differing from
+    # gdk_rgba_parse() at runtime.
+    if value.startswith('#'):
+        digits = value[1:]
+        try:
+            if len(digits) in (3, 4):
+                parts = [int(c, 16) / 15.0 for c in digits]
+            elif len(digits) in (6, 8):
+                parts = [int(digits[i:i+2], 16) / 255.0 for i in range(0, len(digits), 2)]
+            else:
+                parts = None
+        except ValueError:
+            parts = None
+        if parts is not None:
+            if len(parts) == 3:
+                parts.append(1.0)
+            return tuple(parts)
+
+    raise PaletteError('"%s" is not a valid color for %s in section %s of "%s"' % (value, key, group, path))
+
+
+def get_color(path, groups, group, key, required):
+    value = groups[group].get(key)
+    if value is None:
+        if required:
+            raise PaletteError('"%s" is missing %s key in %s section' % (path, key, group))
+        return None
+    return parse_color(path, group, key, value)
+
+
+def to_float(value):
+    # GdkRGBA stores floats, so round the same way the runtime would
+    return struct.unpack('f', struct.pack('f', value))[0]
+
+
+def is_dark(color):
+    r = to_float(color[0]) * 255.0
+    g = to_float(color[1]) * 255.0
+    b = to_float(color[2]) * 255.0
+    return math.sqrt(0.299 * (r * r) + 0.587 * (g * g) + 0.114 * (b * b)) <= 127.5
+
+
+def load_face(path, groups, group):
+    if group not in groups:
+        raise PaletteError('"%s" is missing %s section' % (path, group))
+
+    face = {}
+    present = 0
+
+    cursor_bg = get_color(path, groups, group, 'CursorBackground', False)
+    if cursor_bg is None:
+        cursor_bg = get_color(path, groups, group, 'Cursor', False)
+    face['cursor_bg'] = cursor_bg or ZERO
+    face['cursor_fg'] = get_color(path, groups, group, 'CursorForeround', False) or ZERO
+
+    face['foreground'] = get_color(path, groups, group, 'Foreground', True)
+    face['background'] = get_color(path, groups, group, 'Background', True)
+    face['indexed'] = [get_color(path, groups, group, 'Color%d' % i, True) for i in range(16)]
+
+    for bit, (key, member) in enumerate(OPTIONAL):
+        color = get_color(path, groups, group, key, False)
+        if color is not None:
+            face[member] = color
+            present |= 1 << bit
+
+    return face, present
+
+
+def get_boolean(groups, key):
+    return groups['Palette'].get(key, 'false').lower() in ('true', '1')
+
+
+def load_palette(path):
+    groups = load_key_file(path)
+
+    if 'Palette' not in groups:
+        raise PaletteError('"%s" is missing Palette section' % path)
+    if 'Name' not in groups['Palette']:
+        raise PaletteError('"%s" is missing Name key of Palette section' % path)
+
+    base = os.path.basename(path)
+    if not base.endswith('.palette'):
+        raise PaletteError('"%s" does not have suffix .palette' % path)
+
+    has_light = 'Light' in groups
+    has_dark = 'Dark' in groups
+
+    if not has_light and not has_dark:
+        face, present = load_face(path, groups, 'Palette')
+        faces = [(face, present), (face, present)]
+        has_dark = is_dark(face['background'])
+        has_light = not has_dark
+    else:
+        faces = [load_face(path, groups, 'Light'),
+                 load_face(path, groups, 'Dark')]
+
+    return {
+        'id': base[:-len('.palette')],
+        'name': groups['Palette']['Name'],
+        'faces': faces,
+        'is_primary': get_boolean(groups, 'Primary'),
+        'use_system_accent': get_boolean(groups, 'UseSystemAccent'),
+        'has_dark': has_dark,
+        'has_light': has_light,
+    }
+
+
+def c_string(s):
+    out = []
+    for b in s.encode('utf-8'):
+        c = chr(b)
+        if c in '"\\':
+            out.append('\\' + c)
+        elif 0x20 <= b < 0x7f and c != '?':
+            out.append(c)
+        else:
+            out.append('\\%03o' % b)
+    return '"' + ''.join(out) + '"'
+
+
+def c_color(color):
+    return '{ %s }' % ', '.join(repr(float(x)) for x in color)
+
+
+def write_face(out, face, present):
+    out.write('        {\n')
+    out.write('          .background = %s,\n' % c_color(face['background']))
+    out.write('          .foreground = %s,\n' % c_color(face['foreground']))
+    out.write('          .cursor_bg = %s,\n' % c_color(face['cursor_bg']))
+    out.write('          .cursor_fg = %s,\n' % c_color(face['cursor_fg']))
+    out.write('          .indexed = {\n')
+    for color in face['indexed']:
+        out.write('            %s,\n' % c_color(color))
+    out.write('          },\n')
+    for key, member in OPTIONAL:
+        if member in face:
+            out.write('          .%s = %s,\n' % (member, c_color(face[member])))
+    out.write('        },\n')
+
+
+def main(argv):
+    if len(argv) < 3 or argv[1] != '--output':
+        sys.stderr.write('usage: %s --output FILE PALETTE...\n' % argv[0])
+        return 1
+
+    try:
+        palettes = [load_palette(path) for path in argv[3:]]
+    except (OSError, PaletteError) as e:
+        sys.stderr.write('%s\n' % e)
+        return 1
+
+    # Sorted by name only to keep the generated file stable, the order
+    # shown to users comes from sorting together with user palettes at
+    # runtime. A secondary index by id is used for lookups.
+    palettes.sort(key=lambda p: (p['name'].casefold(), p['id']))
+    by_id = sorted(range(len(palettes)), key=lambda i: palettes[i]['id'].encode('utf-8'))
+
+    with open(argv[2], 'w', encoding='utf-8') as out:
+        out.write('/* Generated by compile_palettes.py, do not edit */\n\n')
+        out.write('#include "config.h"\n\n')
+        out.write('#include "ptyxis-palette-private.h"\n\n')
+        out.write('const PtyxisPaletteTableEntry ptyxis_palette_table[] = {\n')
+        for p in palettes:
+            out.write('  {\n')
+            out.write('    .data = {\n')
+            out.write('      .id = %s,\n' % c_string(p['id']))
+            out.write('      .name = %s,\n' % c_string(p['name']))
+            out.write('      .faces = {\n')
+            for face, present in p['faces']:
+                write_face(out, face, present)
+            out.write('      },\n')
+            out.write('    },\n')
+            out.write('    .present = { 0x%x, 0x%x },\n' % (p['faces'][0][1], p['faces'][1][1]))
+            out.write('    .is_primary = %d,\n' % p['is_primary'])
+            out.write('    .use_system_accent = %d,\n' % p['use_system_accent'])
+            out.write('    .has_dark = %d,\n' % p['has_dark'])
+            out.write('    .has_light = %d,\n' % p['has_light'])
+            out.write('  },\n')
+        out.write('};\n\n')
+        out.write('const guint ptyxis_palette_table_len = G_N_ELEMENTS (ptyxis_palette_table);\n\n')
+        out.write('const guint16 ptyxis_palette_table_by_id[] = {\n')
+        for i in by_id:
+            out.write('  %d,\n' % i)
+        out.write('};\n')
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
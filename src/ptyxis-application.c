@@ -31,10 +31,13 @@
 #include "ptyxis-build-ident.h"
 #include "ptyxis-client.h"
 #include "ptyxis-container-menu.h"
+#include "ptyxis-layout.h"
+#include "ptyxis-palette.h"
 #include "ptyxis-preferences-window.h"
 #include "ptyxis-profile-menu.h"
 #include "ptyxis-session.h"
 #include "ptyxis-settings.h"
+#include "ptyxis-tabs-service.h"
 #include "ptyxis-util.h"
 #include "ptyxis-window.h"
 
@@ -44,23 +47,28 @@
 
 struct _PtyxisApplication
 {
-  AdwApplication       parent_instance;
-  GListStore          *profiles;
-  PtyxisSettings      *settings;
-  PtyxisShortcuts     *shortcuts;
-  PtyxisContainerMenu *container_menu;
-  PtyxisProfileMenu   *profile_menu;
-  char                *next_title_prefix;
-  char                *system_font_name;
-  GDBusProxy          *portal;
-  PtyxisClient        *client;
-  GHashTable          *exited;
-  GVariant            *session;
-  GFileMonitor        *xdg_terminals_list_monitor;
-  guint                has_restored_session : 1;
-  guint                overlay_scrollbars : 1;
-  guint                client_is_fallback : 1;
-  guint                maximize : 1;
+  AdwApplication          parent_instance;
+  GListStore             *profiles;
+  PtyxisSettings         *settings;
+  PtyxisShortcuts        *shortcuts;
+  PtyxisScrollbackBudget *scrollback_budget;
+  PtyxisBroadcast        *broadcast;
+  PtyxisStallMonitor     *stall_monitor;
+  PtyxisTabPool          *tab_pool;
+  PtyxisTabsService      *tabs_service;
+  PtyxisContainerMenu    *container_menu;
+  PtyxisProfileMenu      *profile_menu;
+  char                   *next_title_prefix;
+  char                   *system_font_name;
+  GDBusProxy             *portal;
+  PtyxisClient           *client;
+  GHashTable             *exited;
+  GVariant               *session;
+  GFileMonitor           *xdg_terminals_list_monitor;
+  guint                   has_restored_session : 1;
+  guint                   overlay_scrollbars : 1;
+  guint                   client_is_fallback : 1;
+  guint                   maximize : 1;
 };
 
 static void ptyxis_application_about             (GSimpleAction *action,
@@ -399,6 +407,7 @@ ptyxis_application_command_line (GApplication            *app,
   PtyxisApplication *self = (PtyxisApplication *)app;
   g_autofree char *new_tab_with_profile = NULL;
   g_autofree char *working_directory = NULL;
+  g_autofree char *layout = NULL;
   g_autofree char *command = NULL;
   g_autofree char *cwd_uri = NULL;
   g_autofree char *title = NULL;
@@ -485,6 +494,19 @@ ptyxis_application_command_line (GApplication            *app,
     {
       g_action_group_activate_action (G_ACTION_GROUP (self), "preferences", NULL);
     }
+  else if (g_variant_dict_lookup (dict, "layout", "^ay", &layout))
+    {
+      g_autoptr(GFile) file = g_application_command_line_create_file_for_arg (cmdline, layout);
+      g_autoptr(GError) error = NULL;
+
+      if (!ptyxis_layout_load_file (file, &error))
+        {
+          g_application_command_line_printerr (cmdline,
+                                               _("Cannot open layout: %s\n"),
+                                               error->message);
+          return EXIT_FAILURE;
+        }
+    }
   else if (g_variant_dict_contains (dict, "execute") &&
            g_variant_dict_lookup (dict, "execute", "s", &command))
     {
@@ -850,6 +872,18 @@ ptyxis_application_client_process_exited_cb (PtyxisApplication *self,
                          GINT_TO_POINTER (exit_code));
 }
 
+static gboolean
+ptyxis_application_load_palettes_cb (gpointer user_data)
+{
+  /* Creates the list of all palettes which starts scanning the user
+   * palettes directory on a worker thread. Only the active palette
+   * is needed before this to draw the first frame.
+   */
+  ptyxis_palette_get_all ();
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 ptyxis_application_startup (GApplication *application)
 {
@@ -862,6 +896,7 @@ ptyxis_application_startup (GApplication *application)
   g_autoptr(GError) error = NULL;
   g_autoptr(GFile) xdg_terminals_list = NULL;
   AdwStyleManager *style_manager;
+  const char *stall_monitor;
   gboolean sandbox_agent;
 
   g_assert (PTYXIS_IS_APPLICATION (self));
@@ -875,8 +910,23 @@ ptyxis_application_startup (GApplication *application)
   self->profiles = g_list_store_new (PTYXIS_TYPE_PROFILE);
   self->settings = ptyxis_settings_new ();
   self->shortcuts = ptyxis_shortcuts_new (NULL);
+  self->scrollback_budget = ptyxis_scrollback_budget_new (self->settings);
+  self->broadcast = ptyxis_broadcast_new ();
   self->xdg_terminals_list_monitor = g_file_monitor (xdg_terminals_list, 0, NULL, NULL);
 
+  /* Opt-in watchdog so that CI and bug reports can catch main loop stalls.
+   * The value is the threshold in milliseconds (defaulting to one frame).
+   */
+  if ((stall_monitor = g_getenv ("PTYXIS_STALL_MONITOR")))
+    {
+      guint64 threshold = g_ascii_strtoull (stall_monitor, NULL, 10);
+
+      if (threshold == 0 || threshold > G_MAXUINT)
+        threshold = 16;
+
+      self->stall_monitor = ptyxis_stall_monitor_new (threshold);
+    }
+
   /* Load the session state so it's available if we need it */
   if ((session_bytes = g_file_load_bytes (session_file, NULL, NULL, NULL)))
     {
@@ -1003,6 +1053,16 @@ ptyxis_application_startup (GApplication *application)
   g_object_bind_property (self->settings, "interface-style",
                           style_manager, "color-scheme",
                           G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
+
+  /* Low priority so that it runs after the first window has painted */
+  g_idle_add_full (G_PRIORITY_LOW,
+                   ptyxis_application_load_palettes_cb,
+                   NULL, NULL);
+
+  /* Profiles are loaded now, so tabs for the default profile can be
+   * created ahead of time (also at low priority).
+   */
+  self->tab_pool = ptyxis_tab_pool_new (self->settings);
 }
 
 static void
@@ -1019,6 +1079,10 @@ ptyxis_application_shutdown (GApplication *application)
   g_clear_object (&self->profiles);
   g_clear_object (&self->portal);
   g_clear_object (&self->shortcuts);
+  g_clear_object (&self->scrollback_budget);
+  g_clear_object (&self->broadcast);
+  g_clear_object (&self->stall_monitor);
+  g_clear_object (&self->tab_pool);
   g_clear_object (&self->settings);
   g_clear_object (&self->client);
   g_clear_pointer (&self->next_title_prefix, g_free);
@@ -1027,6 +1091,49 @@ ptyxis_application_shutdown (GApplication *application)
   g_clear_pointer (&self->system_font_name, g_free);
 }
 
+static gboolean
+ptyxis_application_dbus_register (GApplication     *application,
+                                  GDBusConnection  *connection,
+                                  const char       *object_path,
+                                  GError          **error)
+{
+  PtyxisApplication *self = (PtyxisApplication *)application;
+
+  g_assert (PTYXIS_IS_APPLICATION (self));
+  g_assert (G_IS_DBUS_CONNECTION (connection));
+  g_assert (object_path != NULL);
+
+  if (!G_APPLICATION_CLASS (ptyxis_application_parent_class)->dbus_register (application, connection, object_path, error))
+    return FALSE;
+
+  self->tabs_service = ptyxis_tabs_service_new ();
+
+  return g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self->tabs_service),
+                                           connection,
+                                           object_path,
+                                           error);
+}
+
+static void
+ptyxis_application_dbus_unregister (GApplication    *application,
+                                    GDBusConnection *connection,
+                                    const char      *object_path)
+{
+  PtyxisApplication *self = (PtyxisApplication *)application;
+
+  g_assert (PTYXIS_IS_APPLICATION (self));
+  g_assert (G_IS_DBUS_CONNECTION (connection));
+  g_assert (object_path != NULL);
+
+  if (self->tabs_service != NULL)
+    {
+      g_dbus_interface_skeleton_unexport (G_DBUS_INTERFACE_SKELETON (self->tabs_service));
+      g_clear_object (&self->tabs_service);
+    }
+
+  G_APPLICATION_CLASS (ptyxis_application_parent_class)->dbus_unregister (application, connection, object_path);
+}
+
 static void
 ptyxis_application_get_property (GObject    *object,
                                  guint       prop_id,
@@ -1071,6 +1178,8 @@ ptyxis_application_class_init (PtyxisApplicationClass *klass)
   app_class->shutdown = ptyxis_application_shutdown;
   app_class->command_line = ptyxis_application_command_line;
   app_class->open = ptyxis_application_open;
+  app_class->dbus_register = ptyxis_application_dbus_register;
+  app_class->dbus_unregister = ptyxis_application_dbus_unregister;
 
   properties[PROP_DEFAULT_PROFILE] =
     g_param_spec_object ("default-profile", NULL, NULL,
@@ -1122,6 +1231,8 @@ ptyxis_application_init (PtyxisApplication *self)
     { "tab", 0, 0, G_OPTION_ARG_NONE, NULL, N_("New terminal tab in active window") },
     { "tab-with-profile", 0, 0, G_OPTION_ARG_STRING, NULL, N_("New terminal tab in active window using the profile UUID"), N_("PROFILE_UUID") },
 
+    { "layout", 0, 0, G_OPTION_ARG_FILENAME, NULL, N_("Open the windows and tabs described in a JSON layout FILE"), N_("FILE") },
+
     { "title", 'T', 0, G_OPTION_ARG_STRING, NULL, N_("Set title for new tab") },
     { "maximize", 0, 0, G_OPTION_ARG_NONE, NULL, N_("Maximize a newly created window") },
 
@@ -1140,7 +1251,11 @@ ptyxis_application_init (PtyxisApplication *self)
   g_string_append_c (summary, '\n');
   g_string_append_printf (summary, "  %s\n", _("Run Custom Command in New Window"));
   g_string_append (summary, "    ptyxis -x \"bash -c 'sleep 3'\"\n");
-  g_string_append (summary, "    ptyxis -- bash -c 'sleep 3'");
+  g_string_append (summary, "    ptyxis -- bash -c 'sleep 3'\n");
+
+  g_string_append_c (summary, '\n');
+  g_string_append_printf (summary, "  %s\n", _("Open Windows and Tabs from a Layout"));
+  g_string_append (summary, "    ptyxis --layout workspace.json");
 
   g_application_set_option_context_parameter_string (G_APPLICATION (self), _("[-- COMMAND ARGUMENTS]"));
   g_application_add_main_option_entries (G_APPLICATION (self), main_entries);
@@ -1683,6 +1798,72 @@ ptyxis_application_get_shortcuts (PtyxisApplication *self)
   return self->shortcuts;
 }
 
+/**
+ * ptyxis_application_get_scrollback_budget:
+ * @self: a #PtyxisApplication
+ *
+ * Gets the manager used to keep scrollback across all tabs within
+ * the configured memory budget.
+ *
+ * Returns: (transfer none) (nullable): a #PtyxisScrollbackBudget
+ */
+PtyxisScrollbackBudget *
+ptyxis_application_get_scrollback_budget (PtyxisApplication *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_APPLICATION (self), NULL);
+
+  return self->scrollback_budget;
+}
+
+/**
+ * ptyxis_application_get_tab_pool:
+ * @self: a #PtyxisApplication
+ *
+ * Gets the pool of tabs created ahead of time for the default profile.
+ *
+ * Returns: (transfer none) (nullable): a #PtyxisTabPool
+ */
+PtyxisTabPool *
+ptyxis_application_get_tab_pool (PtyxisApplication *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_APPLICATION (self), NULL);
+
+  return self->tab_pool;
+}
+
+/**
+ * ptyxis_application_get_stall_monitor:
+ * @self: a #PtyxisApplication
+ *
+ * Gets the main loop stall monitor, which is only created when the
+ * `PTYXIS_STALL_MONITOR` environment variable is set.
+ *
+ * Returns: (transfer none) (nullable): a #PtyxisStallMonitor or %NULL
+ */
+PtyxisStallMonitor *
+ptyxis_application_get_stall_monitor (PtyxisApplication *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_APPLICATION (self), NULL);
+
+  return self->stall_monitor;
+}
+
+/**
+ * ptyxis_application_get_broadcast:
+ * @self: a #PtyxisApplication
+ *
+ * Gets the tab groups used to broadcast input across windows.
+ *
+ * Returns: (transfer none): a #PtyxisBroadcast
+ */
+PtyxisBroadcast *
+ptyxis_application_get_broadcast (PtyxisApplication *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_APPLICATION (self), NULL);
+
+  return self->broadcast;
+}
+
 void
 ptyxis_application_report_error (PtyxisApplication *self,
                                  GType              subsystem,
@@ -1703,13 +1884,60 @@ ptyxis_application_report_error (PtyxisApplication *self,
            error->message);
 }
 
+static void
+ptyxis_application_create_pty_cb (GObject      *object,
+                                  GAsyncResult *result,
+                                  gpointer      user_data)
+{
+  PtyxisClient *client = (PtyxisClient *)object;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GTask) task = user_data;
+  VtePty *pty;
+
+  g_assert (PTYXIS_IS_CLIENT (client));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (G_IS_TASK (task));
+
+  if (!(pty = ptyxis_client_create_pty_finish (client, result, &error)))
+    g_task_return_error (task, g_steal_pointer (&error));
+  else
+    g_task_return_pointer (task, pty, g_object_unref);
+}
+
+void
+ptyxis_application_create_pty_async (PtyxisApplication   *self,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (PTYXIS_IS_APPLICATION (self));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, ptyxis_application_create_pty_async);
+
+  ptyxis_client_create_pty_async (self->client,
+                                  cancellable,
+                                  ptyxis_application_create_pty_cb,
+                                  g_steal_pointer (&task));
+}
+
+/**
+ * ptyxis_application_create_pty_finish:
+ *
+ * Returns: (transfer full): a #VtePty or %NULL and @error is set
+ */
 VtePty *
-ptyxis_application_create_pty (PtyxisApplication  *self,
-                               GError            **error)
+ptyxis_application_create_pty_finish (PtyxisApplication  *self,
+                                      GAsyncResult       *result,
+                                      GError            **error)
 {
   g_return_val_if_fail (PTYXIS_IS_APPLICATION (self), NULL);
+  g_return_val_if_fail (G_IS_TASK (result), NULL);
 
-  return ptyxis_client_create_pty (self->client, error);
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 typedef struct _Spawn
@@ -2034,13 +2262,63 @@ ptyxis_application_wait_finish (PtyxisApplication  *self,
   return g_task_propagate_int (G_TASK (result), error);
 }
 
+static void
+ptyxis_application_discover_current_container_cb (GObject      *object,
+                                                  GAsyncResult *result,
+                                                  gpointer      user_data)
+{
+  PtyxisClient *client = (PtyxisClient *)object;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GTask) task = user_data;
+  PtyxisIpcContainer *container;
+
+  g_assert (PTYXIS_IS_CLIENT (client));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (G_IS_TASK (task));
+
+  if (!(container = ptyxis_client_discover_current_container_finish (client, result, &error)))
+    g_task_return_error (task, g_steal_pointer (&error));
+  else
+    g_task_return_pointer (task, container, g_object_unref);
+}
+
+void
+ptyxis_application_discover_current_container_async (PtyxisApplication   *self,
+                                                     VtePty              *pty,
+                                                     GCancellable        *cancellable,
+                                                     GAsyncReadyCallback  callback,
+                                                     gpointer             user_data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (PTYXIS_IS_APPLICATION (self));
+  g_return_if_fail (VTE_IS_PTY (pty));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, ptyxis_application_discover_current_container_async);
+
+  ptyxis_client_discover_current_container_async (self->client,
+                                                  pty,
+                                                  cancellable,
+                                                  ptyxis_application_discover_current_container_cb,
+                                                  g_steal_pointer (&task));
+}
+
+/**
+ * ptyxis_application_discover_current_container_finish:
+ *
+ * Returns: (transfer full): a #PtyxisIpcContainer or %NULL and @error is set
+ */
 PtyxisIpcContainer *
-ptyxis_application_discover_current_container (PtyxisApplication *self,
-                                               VtePty            *pty)
+ptyxis_application_discover_current_container_finish (PtyxisApplication  *self,
+                                                      GAsyncResult       *result,
+                                                      GError            **error)
 {
   g_return_val_if_fail (PTYXIS_IS_APPLICATION (self), NULL);
+  g_return_val_if_fail (G_IS_TASK (result), NULL);
 
-  return ptyxis_client_discover_current_container (self->client, pty);
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 static void
@@ -23,9 +23,13 @@
 #include <adwaita.h>
 
 #include "ptyxis-agent-ipc.h"
+#include "ptyxis-broadcast.h"
 #include "ptyxis-profile.h"
+#include "ptyxis-scrollback-budget.h"
 #include "ptyxis-settings.h"
 #include "ptyxis-shortcuts.h"
+#include "ptyxis-stall-monitor.h"
+#include "ptyxis-tab-pool.h"
 
 G_BEGIN_DECLS
 
@@ -40,6 +44,10 @@ const char         *ptyxis_application_get_user_data_dir          (PtyxisApplica
 const char         *ptyxis_application_get_os_name                (PtyxisApplication    *self);
 PtyxisSettings     *ptyxis_application_get_settings               (PtyxisApplication    *self);
 PtyxisShortcuts    *ptyxis_application_get_shortcuts              (PtyxisApplication    *self);
+PtyxisScrollbackBudget *ptyxis_application_get_scrollback_budget  (PtyxisApplication    *self);
+PtyxisStallMonitor     *ptyxis_application_get_stall_monitor      (PtyxisApplication    *self);
+PtyxisTabPool          *ptyxis_application_get_tab_pool           (PtyxisApplication    *self);
+PtyxisBroadcast        *ptyxis_application_get_broadcast          (PtyxisApplication    *self);
 const char         *ptyxis_application_get_system_font_name       (PtyxisApplication    *self);
 gboolean            ptyxis_application_get_overlay_scrollbars     (PtyxisApplication    *self);
 gboolean            ptyxis_application_control_is_pressed         (PtyxisApplication    *self);
@@ -61,7 +69,12 @@ PtyxisIpcContainer *ptyxis_application_lookup_container           (PtyxisApplica
 void                ptyxis_application_report_error               (PtyxisApplication    *self,
                                                                    GType                 subsystem,
                                                                    const GError         *error);
-VtePty             *ptyxis_application_create_pty                 (PtyxisApplication    *self,
+void                ptyxis_application_create_pty_async           (PtyxisApplication    *self,
+                                                                   GCancellable         *cancellable,
+                                                                   GAsyncReadyCallback   callback,
+                                                                   gpointer              user_data);
+VtePty             *ptyxis_application_create_pty_finish          (PtyxisApplication    *self,
+                                                                   GAsyncResult         *result,
                                                                    GError              **error);
 void                ptyxis_application_spawn_async                (PtyxisApplication    *self,
                                                                    PtyxisIpcContainer   *container,
@@ -83,8 +96,14 @@ void                ptyxis_application_wait_async                 (PtyxisApplica
 int                 ptyxis_application_wait_finish                (PtyxisApplication    *self,
                                                                    GAsyncResult         *result,
                                                                    GError              **error);
-PtyxisIpcContainer *ptyxis_application_discover_current_container (PtyxisApplication    *self,
-                                                                   VtePty               *pty);
+void                ptyxis_application_discover_current_container_async  (PtyxisApplication    *self,
+                                                                          VtePty               *pty,
+                                                                          GCancellable         *cancellable,
+                                                                          GAsyncReadyCallback   callback,
+                                                                          gpointer              user_data);
+PtyxisIpcContainer *ptyxis_application_discover_current_container_finish (PtyxisApplication    *self,
+                                                                          GAsyncResult         *result,
+                                                                          GError              **error);
 PtyxisIpcContainer *ptyxis_application_find_container_by_name     (PtyxisApplication    *self,
                                                                    const char           *runtime,
                                                                    const char           *name);
@@ -0,0 +1,297 @@
+/*
+ * ptyxis-broadcast.c
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include "ptyxis-broadcast.h"
+#include "ptyxis-terminal-private.h"
+
+struct _PtyxisBroadcast
+{
+  GObject     parent_instance;
+
+  /* PtyxisTab -> group number, for every tab in a group */
+  GHashTable *groups;
+
+  /* Members of each group, in the order they joined */
+  GPtrArray  *members[PTYXIS_BROADCAST_N_GROUPS];
+
+  /* Bit (1 << group) is set when input broadcast is enabled */
+  guint       enabled;
+
+  guint       in_fan_out : 1;
+};
+
+enum {
+  CHANGED,
+  N_SIGNALS
+};
+
+G_DEFINE_FINAL_TYPE (PtyxisBroadcast, ptyxis_broadcast, G_TYPE_OBJECT)
+
+static guint signals[N_SIGNALS];
+
+static void
+ptyxis_broadcast_commit_cb (PtyxisBroadcast *self,
+                            const char      *text,
+                            guint            size,
+                            PtyxisTerminal  *terminal)
+{
+  GPtrArray *members;
+  PtyxisTab *tab;
+  guint group;
+
+  g_assert (PTYXIS_IS_BROADCAST (self));
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  /* Feeding the other members emits ::commit on each of them too, so
+   * ignore everything while we are the ones writing.
+   */
+  if (self->in_fan_out || size == 0)
+    return;
+
+  /* Only what the user types or pastes is broadcast, never replies VTE
+   * makes to the application nor input fed over D-Bus.
+   */
+  if (!_ptyxis_terminal_is_user_input (terminal))
+    return;
+
+  if (!(tab = PTYXIS_TAB (gtk_widget_get_ancestor (GTK_WIDGET (terminal), PTYXIS_TYPE_TAB))))
+    return;
+
+  group = GPOINTER_TO_UINT (g_hash_table_lookup (self->groups, tab));
+
+  if (group == 0 || !ptyxis_broadcast_get_enabled (self, group))
+    return;
+
+  members = self->members[group - 1];
+
+  /* The focused terminal has already processed the key or paste and
+   * handed us the bytes destined for its PTY. Write those same bytes to
+   * each other member directly rather than synthesizing key events so
+   * the cost per member is a single write().
+   */
+  self->in_fan_out = TRUE;
+
+  for (guint i = 0; i < members->len; i++)
+    {
+      PtyxisTab *member = g_ptr_array_index (members, i);
+      VteTerminal *other;
+
+      if (member == tab)
+        continue;
+
+      other = VTE_TERMINAL (ptyxis_tab_get_terminal (member));
+
+      if (vte_terminal_get_input_enabled (other))
+        vte_terminal_feed_child (other, text, size);
+    }
+
+  self->in_fan_out = FALSE;
+}
+
+static void
+ptyxis_broadcast_dispose (GObject *object)
+{
+  PtyxisBroadcast *self = (PtyxisBroadcast *)object;
+
+  for (guint i = 0; i < PTYXIS_BROADCAST_N_GROUPS; i++)
+    {
+      while (self->members[i] != NULL && self->members[i]->len > 0)
+        ptyxis_broadcast_remove_tab (self, g_ptr_array_index (self->members[i], 0));
+    }
+
+  G_OBJECT_CLASS (ptyxis_broadcast_parent_class)->dispose (object);
+}
+
+static void
+ptyxis_broadcast_finalize (GObject *object)
+{
+  PtyxisBroadcast *self = (PtyxisBroadcast *)object;
+
+  for (guint i = 0; i < PTYXIS_BROADCAST_N_GROUPS; i++)
+    g_clear_pointer (&self->members[i], g_ptr_array_unref);
+
+  g_clear_pointer (&self->groups, g_hash_table_unref);
+
+  G_OBJECT_CLASS (ptyxis_broadcast_parent_class)->finalize (object);
+}
+
+static void
+ptyxis_broadcast_class_init (PtyxisBroadcastClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = ptyxis_broadcast_dispose;
+  object_class->finalize = ptyxis_broadcast_finalize;
+
+  /**
+   * PtyxisBroadcast::changed:
+   * @self: a #PtyxisBroadcast
+   * @group: the group which changed
+   *
+   * Emitted when the members of @group or whether input is broadcast
+   * to @group changes.
+   */
+  signals[CHANGED] =
+    g_signal_new_class_handler ("changed",
+                                G_TYPE_FROM_CLASS (klass),
+                                G_SIGNAL_RUN_LAST,
+                                NULL,
+                                NULL, NULL,
+                                NULL,
+                                G_TYPE_NONE, 1, G_TYPE_UINT);
+}
+
+static void
+ptyxis_broadcast_init (PtyxisBroadcast *self)
+{
+  self->groups = g_hash_table_new (NULL, NULL);
+
+  for (guint i = 0; i < PTYXIS_BROADCAST_N_GROUPS; i++)
+    self->members[i] = g_ptr_array_new ();
+}
+
+PtyxisBroadcast *
+ptyxis_broadcast_new (void)
+{
+  return g_object_new (PTYXIS_TYPE_BROADCAST, NULL);
+}
+
+/**
+ * ptyxis_broadcast_get_group:
+ * @self: a #PtyxisBroadcast
+ * @tab: a #PtyxisTab
+ *
+ * Gets the group @tab belongs to.
+ *
+ * Returns: the group number, or 0 if @tab is not in a group
+ */
+guint
+ptyxis_broadcast_get_group (PtyxisBroadcast *self,
+                            PtyxisTab       *tab)
+{
+  g_return_val_if_fail (PTYXIS_IS_BROADCAST (self), 0);
+  g_return_val_if_fail (PTYXIS_IS_TAB (tab), 0);
+
+  return GPOINTER_TO_UINT (g_hash_table_lookup (self->groups, tab));
+}
+
+/**
+ * ptyxis_broadcast_set_group:
+ * @self: a #PtyxisBroadcast
+ * @tab: a #PtyxisTab
+ * @group: a group number from 1 to %PTYXIS_BROADCAST_N_GROUPS, or 0
+ *
+ * Moves @tab into @group, or out of any group if @group is 0.
+ *
+ * Groups span all windows of the application.
+ */
+void
+ptyxis_broadcast_set_group (PtyxisBroadcast *self,
+                            PtyxisTab       *tab,
+                            guint            group)
+{
+  PtyxisTerminal *terminal;
+  guint old_group;
+
+  g_return_if_fail (PTYXIS_IS_BROADCAST (self));
+  g_return_if_fail (PTYXIS_IS_TAB (tab));
+  g_return_if_fail (group <= PTYXIS_BROADCAST_N_GROUPS);
+
+  old_group = ptyxis_broadcast_get_group (self, tab);
+
+  if (old_group == group)
+    return;
+
+  terminal = ptyxis_tab_get_terminal (tab);
+
+  if (old_group != 0)
+    {
+      g_ptr_array_remove (self->members[old_group - 1], tab);
+      g_hash_table_remove (self->groups, tab);
+      g_signal_handlers_disconnect_by_func (terminal,
+                                            G_CALLBACK (ptyxis_broadcast_commit_cb),
+                                            self);
+    }
+
+  if (group != 0)
+    {
+      g_ptr_array_add (self->members[group - 1], tab);
+      g_hash_table_insert (self->groups, tab, GUINT_TO_POINTER (group));
+      g_signal_connect_object (terminal,
+                               "commit",
+                               G_CALLBACK (ptyxis_broadcast_commit_cb),
+                               self,
+                               G_CONNECT_SWAPPED);
+    }
+
+  if (old_group != 0)
+    g_signal_emit (self, signals[CHANGED], 0, old_group);
+
+  if (group != 0)
+    g_signal_emit (self, signals[CHANGED], 0, group);
+}
+
+void
+ptyxis_broadcast_remove_tab (PtyxisBroadcast *self,
+                             PtyxisTab       *tab)
+{
+  ptyxis_broadcast_set_group (self, tab, 0);
+}
+
+gboolean
+ptyxis_broadcast_get_enabled (PtyxisBroadcast *self,
+                              guint            group)
+{
+  g_return_val_if_fail (PTYXIS_IS_BROADCAST (self), FALSE);
+  g_return_val_if_fail (group <= PTYXIS_BROADCAST_N_GROUPS, FALSE);
+
+  return group != 0 && (self->enabled & (1 << group)) != 0;
+}
+
+/**
+ * ptyxis_broadcast_set_enabled:
+ * @self: a #PtyxisBroadcast
+ * @group: a group number from 1 to %PTYXIS_BROADCAST_N_GROUPS
+ * @enabled: if input should be broadcast
+ *
+ * Sets whether input to any member of @group is also written to every
+ * other member of @group.
+ */
+void
+ptyxis_broadcast_set_enabled (PtyxisBroadcast *self,
+                              guint            group,
+                              gboolean         enabled)
+{
+  g_return_if_fail (PTYXIS_IS_BROADCAST (self));
+  g_return_if_fail (group > 0 && group <= PTYXIS_BROADCAST_N_GROUPS);
+
+  if (enabled == ptyxis_broadcast_get_enabled (self, group))
+    return;
+
+  if (enabled)
+    self->enabled |= (1 << group);
+  else
+    self->enabled &= ~(1 << group);
+
+  g_signal_emit (self, signals[CHANGED], 0, group);
+}
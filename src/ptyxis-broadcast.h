@@ -0,0 +1,48 @@
+/*
+ * ptyxis-broadcast.h
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "ptyxis-tab.h"
+
+G_BEGIN_DECLS
+
+#define PTYXIS_BROADCAST_N_GROUPS 4
+
+#define PTYXIS_TYPE_BROADCAST (ptyxis_broadcast_get_type())
+
+G_DECLARE_FINAL_TYPE (PtyxisBroadcast, ptyxis_broadcast, PTYXIS, BROADCAST, GObject)
+
+PtyxisBroadcast *ptyxis_broadcast_new         (void);
+guint            ptyxis_broadcast_get_group   (PtyxisBroadcast *self,
+                                               PtyxisTab       *tab);
+void             ptyxis_broadcast_set_group   (PtyxisBroadcast *self,
+                                               PtyxisTab       *tab,
+                                               guint            group);
+void             ptyxis_broadcast_remove_tab  (PtyxisBroadcast *self,
+                                               PtyxisTab       *tab);
+gboolean         ptyxis_broadcast_get_enabled (PtyxisBroadcast *self,
+                                               guint            group);
+void             ptyxis_broadcast_set_enabled (PtyxisBroadcast *self,
+                                               guint            group,
+                                               gboolean         enabled);
+
+G_END_DECLS
@@ -482,40 +482,80 @@ ptyxis_client_force_exit (PtyxisClient *self)
   g_subprocess_force_exit (self->subprocess);
 }
 
-VtePty *
-ptyxis_client_create_pty (PtyxisClient  *self,
-                          GError       **error)
+static void
+ptyxis_client_create_pty_cb (GObject      *object,
+                             GAsyncResult *result,
+                             gpointer      user_data)
 {
-  g_autoptr(GVariant) out_fd = NULL;
+  PtyxisIpcAgent *agent = (PtyxisIpcAgent *)object;
   g_autoptr(GUnixFDList) out_fd_list = NULL;
+  g_autoptr(GVariant) out_fd = NULL;
   g_autoptr(VtePty) pty = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GTask) task = user_data;
   int fd;
-  int handle;
 
-  g_return_val_if_fail (PTYXIS_IS_CLIENT (self), NULL);
+  g_assert (PTYXIS_IPC_IS_AGENT (agent));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (G_IS_TASK (task));
 
-  if (self->subprocess == NULL || self->proxy == NULL)
+  if (!ptyxis_ipc_agent_call_create_pty_finish (agent, &out_fd, &out_fd_list, result, &error) ||
+      -1 == (fd = g_unix_fd_list_get (out_fd_list, g_variant_get_handle (out_fd), &error)) ||
+      !(pty = vte_pty_new_foreign_sync (fd, NULL, &error)))
     {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_CLOSED,
-                           "The connection to the agent has closed");
-      return NULL;
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
     }
 
-  if (!ptyxis_ipc_agent_call_create_pty_sync (self->proxy, NULL, &out_fd, &out_fd_list,
-                                              NULL, error))
-    return NULL;
+  vte_pty_set_utf8 (pty, TRUE, NULL);
 
-  handle = g_variant_get_handle (out_fd);
-  fd = g_unix_fd_list_get (out_fd_list, handle, error);
-  if (fd == -1)
-    return NULL;
+  g_task_return_pointer (task, g_steal_pointer (&pty), g_object_unref);
+}
+
+void
+ptyxis_client_create_pty_async (PtyxisClient        *self,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (PTYXIS_IS_CLIENT (self));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, ptyxis_client_create_pty_async);
 
-  if ((pty = vte_pty_new_foreign_sync (fd, NULL, error)))
-    vte_pty_set_utf8 (pty, TRUE, NULL);
+  if (self->subprocess == NULL || self->proxy == NULL)
+    {
+      g_task_return_new_error (task,
+                               G_IO_ERROR,
+                               G_IO_ERROR_CLOSED,
+                               "The connection to the agent has closed");
+      return;
+    }
 
-  return g_steal_pointer (&pty);
+  ptyxis_ipc_agent_call_create_pty (self->proxy,
+                                    NULL,
+                                    cancellable,
+                                    ptyxis_client_create_pty_cb,
+                                    g_steal_pointer (&task));
+}
+
+/**
+ * ptyxis_client_create_pty_finish:
+ *
+ * Returns: (transfer full): a #VtePty or %NULL and @error is set
+ */
+VtePty *
+ptyxis_client_create_pty_finish (PtyxisClient  *self,
+                                 GAsyncResult  *result,
+                                 GError       **error)
+{
+  g_return_val_if_fail (PTYXIS_IS_CLIENT (self), NULL);
+  g_return_val_if_fail (G_IS_TASK (result), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 static void
@@ -591,17 +631,31 @@ maybe_extract_path_from_uri (GFile      *file,
   return g_file_peek_path (file);
 }
 
-void
-ptyxis_client_spawn_async (PtyxisClient        *self,
-                           PtyxisIpcContainer  *container,
-                           PtyxisProfile       *profile,
-                           const char          *default_shell,
-                           const char          *last_working_directory_uri,
-                           VtePty              *pty,
-                           const char * const  *alt_argv,
-                           GCancellable        *cancellable,
-                           GAsyncReadyCallback  callback,
-                           gpointer             user_data)
+typedef struct _ClientSpawn
+{
+  PtyxisIpcContainer *container;
+  PtyxisProfile      *profile;
+  char               *default_shell;
+  char               *last_working_directory_uri;
+  char              **alt_argv;
+  int                 pty_fd;
+} ClientSpawn;
+
+static void
+client_spawn_free (ClientSpawn *spawn)
+{
+  g_clear_object (&spawn->container);
+  g_clear_object (&spawn->profile);
+  g_clear_pointer (&spawn->default_shell, g_free);
+  g_clear_pointer (&spawn->last_working_directory_uri, g_free);
+  g_clear_pointer (&spawn->alt_argv, g_strfreev);
+  g_clear_fd (&spawn->pty_fd, NULL);
+  g_free (spawn);
+}
+
+static void
+ptyxis_client_spawn_with_environ (GTask *task,
+                                  GStrv  proxy_env)
 {
   g_autofree char *custom_command = NULL;
   g_autofree char *arg0 = NULL;
@@ -611,54 +665,26 @@ ptyxis_client_spawn_async (PtyxisClient        *self,
   g_autoptr(GError) error = NULL;
   g_autoptr(GFile) last_directory = NULL;
   g_autoptr(GUnixFDList) fd_list = NULL;
-  g_autoptr(GTask) task = NULL;
-  g_auto(GStrv) env = NULL;
+  g_auto(GStrv) env = proxy_env;
   g_auto(GStrv) full_argv = NULL;
-  g_autofd int pty_fd = -1;
+  const char * const *alt_argv;
+  const char *last_working_directory_uri;
+  const char *default_shell;
+  PtyxisIpcContainer *container;
+  PtyxisProfile *profile;
+  ClientSpawn *spawn;
   const char *cwd = NULL;
   char vte_version[32];
   int handle;
 
-  g_return_if_fail (PTYXIS_IS_CLIENT (self));
-  g_return_if_fail (PTYXIS_IPC_IS_CONTAINER (container));
-  g_return_if_fail (PTYXIS_IS_PROFILE (profile));
-  g_return_if_fail (VTE_IS_PTY (pty));
-  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
-
-  if (default_shell != NULL && default_shell[0] == 0)
-    default_shell = NULL;
-
-  task = g_task_new (self, cancellable, callback, user_data);
-  g_task_set_source_tag (task, ptyxis_client_spawn_async);
-
-  if (self->subprocess == NULL || self->proxy == NULL)
-    {
-      g_task_return_new_error (task,
-                               G_IO_ERROR,
-                               G_IO_ERROR_CLOSED,
-                               "The connection to the agent has closed");
-      return;
-    }
-
-  if (-1 == (pty_fd = ptyxis_client_create_pty_producer (self, pty, &error)))
-    {
-      g_task_return_error (task, g_steal_pointer (&error));
-      return;
-    }
-
-  /* Make sure that the child PTY FD is blocking as most things
-   * will expect that by default. We continue to keep our consumer
-   * FD non-blocking for how we use it.
-   */
-  if (!g_unix_set_fd_nonblocking (pty_fd, FALSE, &error))
-    {
-      g_warning ("Failed to set child PTY FD non-blocking: %s",
-                 error->message);
-      g_clear_error (&error);
-    }
+  g_assert (G_IS_TASK (task));
 
-  if (ptyxis_profile_get_use_proxy (profile))
-    env = ptyxis_client_discover_proxy_environment (self, NULL, NULL);
+  spawn = g_task_get_task_data (task);
+  container = spawn->container;
+  profile = spawn->profile;
+  default_shell = spawn->default_shell;
+  last_working_directory_uri = spawn->last_working_directory_uri;
+  alt_argv = (const char * const *)spawn->alt_argv;
 
   env = g_environ_setenv (env, "PTYXIS_PROFILE", ptyxis_profile_get_uuid (profile), TRUE);
   env = g_environ_setenv (env, "PTYXIS_VERSION", PACKAGE_VERSION, TRUE);
@@ -748,7 +774,7 @@ ptyxis_client_spawn_async (PtyxisClient        *self,
 
   fd_list = g_unix_fd_list_new ();
 
-  if (-1 == (handle = g_unix_fd_list_append (fd_list, pty_fd, &error)))
+  if (-1 == (handle = g_unix_fd_list_append (fd_list, spawn->pty_fd, &error)))
     {
       g_task_return_error (task, g_steal_pointer (&error));
       return;
@@ -776,9 +802,152 @@ ptyxis_client_spawn_async (PtyxisClient        *self,
                                    g_variant_builder_end (g_steal_pointer (&fd_builder)),
                                    g_variant_builder_end (g_steal_pointer (&env_builder)),
                                    fd_list,
-                                   cancellable,
+                                   g_task_get_cancellable (task),
                                    ptyxis_client_spawn_cb,
-                                   g_steal_pointer (&task));
+                                   g_object_ref (task));
+}
+
+static void
+ptyxis_client_spawn_proxy_environment_cb (GObject      *object,
+                                          GAsyncResult *result,
+                                          gpointer      user_data)
+{
+  PtyxisClient *self = (PtyxisClient *)object;
+  g_autoptr(GTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  char **env;
+
+  g_assert (PTYXIS_IS_CLIENT (self));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (G_IS_TASK (task));
+
+  /* Failure to discover the proxy is not fatal to spawning */
+  if (!(env = ptyxis_client_discover_proxy_environment_finish (self, result, &error)))
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          g_task_return_error (task, g_steal_pointer (&error));
+          return;
+        }
+    }
+
+  ptyxis_client_spawn_with_environ (task, env);
+}
+
+static void
+ptyxis_client_spawn_create_pty_producer_cb (GObject      *object,
+                                            GAsyncResult *result,
+                                            gpointer      user_data)
+{
+  PtyxisIpcAgent *agent = (PtyxisIpcAgent *)object;
+  g_autoptr(GUnixFDList) out_fd_list = NULL;
+  g_autoptr(GVariant) out_fd = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GTask) task = user_data;
+  PtyxisClient *self;
+  ClientSpawn *spawn;
+
+  g_assert (PTYXIS_IPC_IS_AGENT (agent));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (G_IS_TASK (task));
+
+  self = g_task_get_source_object (task);
+  spawn = g_task_get_task_data (task);
+
+  g_assert (PTYXIS_IS_CLIENT (self));
+  g_assert (spawn != NULL);
+
+  if (!ptyxis_ipc_agent_call_create_pty_producer_finish (agent, &out_fd, &out_fd_list, result, &error) ||
+      -1 == (spawn->pty_fd = g_unix_fd_list_get (out_fd_list, g_variant_get_handle (out_fd), &error)))
+    {
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
+    }
+
+  /* Make sure that the child PTY FD is blocking as most things
+   * will expect that by default. We continue to keep our consumer
+   * FD non-blocking for how we use it.
+   */
+  if (!g_unix_set_fd_nonblocking (spawn->pty_fd, FALSE, &error))
+    {
+      g_warning ("Failed to set child PTY FD non-blocking: %s",
+                 error->message);
+      g_clear_error (&error);
+    }
+
+  if (ptyxis_profile_get_use_proxy (spawn->profile))
+    ptyxis_client_discover_proxy_environment_async (self,
+                                                    g_task_get_cancellable (task),
+                                                    ptyxis_client_spawn_proxy_environment_cb,
+                                                    g_object_ref (task));
+  else
+    ptyxis_client_spawn_with_environ (task, NULL);
+}
+
+void
+ptyxis_client_spawn_async (PtyxisClient        *self,
+                           PtyxisIpcContainer  *container,
+                           PtyxisProfile       *profile,
+                           const char          *default_shell,
+                           const char          *last_working_directory_uri,
+                           VtePty              *pty,
+                           const char * const  *alt_argv,
+                           GCancellable        *cancellable,
+                           GAsyncReadyCallback  callback,
+                           gpointer             user_data)
+{
+  g_autoptr(GUnixFDList) in_fd_list = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GTask) task = NULL;
+  ClientSpawn *spawn;
+  int in_handle;
+
+  g_return_if_fail (PTYXIS_IS_CLIENT (self));
+  g_return_if_fail (PTYXIS_IPC_IS_CONTAINER (container));
+  g_return_if_fail (PTYXIS_IS_PROFILE (profile));
+  g_return_if_fail (VTE_IS_PTY (pty));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  if (default_shell != NULL && default_shell[0] == 0)
+    default_shell = NULL;
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, ptyxis_client_spawn_async);
+
+  if (self->subprocess == NULL || self->proxy == NULL)
+    {
+      g_task_return_new_error (task,
+                               G_IO_ERROR,
+                               G_IO_ERROR_CLOSED,
+                               "The connection to the agent has closed");
+      return;
+    }
+
+  spawn = g_new0 (ClientSpawn, 1);
+  spawn->container = g_object_ref (container);
+  spawn->profile = g_object_ref (profile);
+  spawn->default_shell = g_strdup (default_shell);
+  spawn->last_working_directory_uri = g_strdup (last_working_directory_uri);
+  spawn->alt_argv = g_strdupv ((char **)alt_argv);
+  spawn->pty_fd = -1;
+  g_task_set_task_data (task, spawn, (GDestroyNotify)client_spawn_free);
+
+  in_fd_list = g_unix_fd_list_new ();
+  if (-1 == (in_handle = g_unix_fd_list_append (in_fd_list, vte_pty_get_fd (pty), &error)))
+    {
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
+    }
+
+  /* Create the producer side of the PTY which will be mapped to the
+   * stdin/stdout/stderr of the child process.
+   */
+  ptyxis_ipc_agent_call_create_pty_producer (self->proxy,
+                                             g_variant_new_handle (in_handle),
+                                             in_fd_list,
+                                             cancellable,
+                                             ptyxis_client_spawn_create_pty_producer_cb,
+                                             g_steal_pointer (&task));
 }
 
 PtyxisIpcProcess *
@@ -852,90 +1021,107 @@ ptyxis_client_discover_shell_finish (PtyxisClient  *client,
   return g_task_propagate_pointer (G_TASK (result), error);
 }
 
-int
-ptyxis_client_create_pty_producer (PtyxisClient  *self,
-                                   VtePty        *pty,
-                                   GError       **error)
+static void
+ptyxis_client_discover_current_container_cb (GObject      *object,
+                                             GAsyncResult *result,
+                                             gpointer      user_data)
 {
-  g_autoptr(GUnixFDList) in_fd_list = NULL;
-  g_autoptr(GUnixFDList) out_fd_list = NULL;
-  g_autoptr(GVariant) out_fd = NULL;
-  g_autofd int fd = -1;
-  int in_handle;
-  int out_handle;
-  int pty_fd;
+  PtyxisIpcAgent *agent = (PtyxisIpcAgent *)object;
+  g_autofree char *object_path = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GTask) task = user_data;
+  PtyxisClient *self;
 
-  g_return_val_if_fail (PTYXIS_IS_CLIENT (self), -1);
-  g_return_val_if_fail (VTE_IS_PTY (pty), -1);
+  g_assert (PTYXIS_IPC_IS_AGENT (agent));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (G_IS_TASK (task));
 
-  if (self->subprocess == NULL || self->proxy == NULL)
+  self = g_task_get_source_object (task);
+
+  g_assert (PTYXIS_IS_CLIENT (self));
+
+  if (!ptyxis_ipc_agent_call_discover_current_container_finish (agent, &object_path, NULL, result, &error))
     {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_CLOSED,
-                           "The connection to the agent has closed");
-      return -1;
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
     }
 
-  pty_fd = vte_pty_get_fd (pty);
-
-  in_fd_list = g_unix_fd_list_new ();
-  if (-1 == (in_handle = g_unix_fd_list_append (in_fd_list, pty_fd, error)))
-    return -1;
-
-  if (!ptyxis_ipc_agent_call_create_pty_producer_sync (self->proxy,
-                                                       g_variant_new_handle (in_handle),
-                                                       in_fd_list,
-                                                       &out_fd,
-                                                       &out_fd_list,
-                                                       NULL,
-                                                       error))
-    return -1;
+  for (guint i = 0; i < self->containers->len; i++)
+    {
+      PtyxisIpcContainer *container = g_ptr_array_index (self->containers, i);
 
-  out_handle = g_variant_get_handle (out_fd);
-  if (-1 == (fd = g_unix_fd_list_get (out_fd_list, out_handle, error)))
-    return -1;
+      if (g_strcmp0 (object_path,
+                     g_dbus_proxy_get_object_path (G_DBUS_PROXY (container))) == 0)
+        {
+          g_task_return_pointer (task, g_object_ref (container), g_object_unref);
+          return;
+        }
+    }
 
-  return g_steal_fd (&fd);
+  g_task_return_new_error (task,
+                           G_IO_ERROR,
+                           G_IO_ERROR_NOT_FOUND,
+                           "No such container \"%s\"",
+                           object_path);
 }
 
-PtyxisIpcContainer *
-ptyxis_client_discover_current_container (PtyxisClient *self,
-                                          VtePty       *pty)
+void
+ptyxis_client_discover_current_container_async (PtyxisClient        *self,
+                                                VtePty              *pty,
+                                                GCancellable        *cancellable,
+                                                GAsyncReadyCallback  callback,
+                                                gpointer             user_data)
 {
-  g_autofree char *object_path = NULL;
   g_autoptr(GUnixFDList) in_fd_list = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GTask) task = NULL;
   int in_handle;
-  int pty_fd;
-
-  g_return_val_if_fail (PTYXIS_IS_CLIENT (self), NULL);
-  g_return_val_if_fail (VTE_IS_PTY (pty), NULL);
 
-  pty_fd = vte_pty_get_fd (pty);
+  g_return_if_fail (PTYXIS_IS_CLIENT (self));
+  g_return_if_fail (VTE_IS_PTY (pty));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  in_fd_list = g_unix_fd_list_new ();
-  if (-1 == (in_handle = g_unix_fd_list_append (in_fd_list, pty_fd, NULL)))
-    return NULL;
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, ptyxis_client_discover_current_container_async);
 
-  if (ptyxis_ipc_agent_call_discover_current_container_sync (self->proxy,
-                                                             g_variant_new_handle (in_handle),
-                                                             in_fd_list,
-                                                             &object_path,
-                                                             NULL,
-                                                             NULL,
-                                                             NULL))
+  if (self->subprocess == NULL || self->proxy == NULL)
     {
-      for (guint i = 0; i < self->containers->len; i++)
-        {
-          PtyxisIpcContainer *container = g_ptr_array_index (self->containers, i);
+      g_task_return_new_error (task,
+                               G_IO_ERROR,
+                               G_IO_ERROR_CLOSED,
+                               "The connection to the agent has closed");
+      return;
+    }
 
-          if (g_strcmp0 (object_path,
-                         g_dbus_proxy_get_object_path (G_DBUS_PROXY (container))) == 0)
-            return g_object_ref (container);
-        }
+  in_fd_list = g_unix_fd_list_new ();
+  if (-1 == (in_handle = g_unix_fd_list_append (in_fd_list, vte_pty_get_fd (pty), &error)))
+    {
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
     }
 
-  return NULL;
+  ptyxis_ipc_agent_call_discover_current_container (self->proxy,
+                                                    g_variant_new_handle (in_handle),
+                                                    in_fd_list,
+                                                    cancellable,
+                                                    ptyxis_client_discover_current_container_cb,
+                                                    g_steal_pointer (&task));
+}
+
+/**
+ * ptyxis_client_discover_current_container_finish:
+ *
+ * Returns: (transfer full): a #PtyxisIpcContainer or %NULL and @error is set
+ */
+PtyxisIpcContainer *
+ptyxis_client_discover_current_container_finish (PtyxisClient  *self,
+                                                 GAsyncResult  *result,
+                                                 GError       **error)
+{
+  g_return_val_if_fail (PTYXIS_IS_CLIENT (self), NULL);
+  g_return_val_if_fail (G_IS_TASK (result), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 const char *
@@ -954,20 +1140,69 @@ ptyxis_client_get_user_data_dir (PtyxisClient *self)
   return ptyxis_ipc_agent_get_user_data_dir (self->proxy);
 }
 
-char **
-ptyxis_client_discover_proxy_environment (PtyxisClient  *self,
-                                          GCancellable  *cancellable,
-                                          GError       **error)
+static void
+ptyxis_client_discover_proxy_environment_cb (GObject      *object,
+                                             GAsyncResult *result,
+                                             gpointer      user_data)
 {
-  char **ret = NULL;
+  PtyxisIpcAgent *agent = (PtyxisIpcAgent *)object;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GTask) task = user_data;
+  char **env = NULL;
 
-  g_return_val_if_fail (PTYXIS_IS_CLIENT (self), NULL);
-  g_return_val_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable), NULL);
+  g_assert (PTYXIS_IPC_IS_AGENT (agent));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (G_IS_TASK (task));
+
+  if (!ptyxis_ipc_agent_call_discover_proxy_environment_finish (agent, &env, result, &error))
+    g_task_return_error (task, g_steal_pointer (&error));
+  else
+    g_task_return_pointer (task, env, (GDestroyNotify)g_strfreev);
+}
 
-  if (ptyxis_ipc_agent_call_discover_proxy_environment_sync (self->proxy, &ret, cancellable, error))
-    return ret;
+void
+ptyxis_client_discover_proxy_environment_async (PtyxisClient        *self,
+                                                GCancellable        *cancellable,
+                                                GAsyncReadyCallback  callback,
+                                                gpointer             user_data)
+{
+  g_autoptr(GTask) task = NULL;
 
-  return NULL;
+  g_return_if_fail (PTYXIS_IS_CLIENT (self));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, ptyxis_client_discover_proxy_environment_async);
+
+  if (self->subprocess == NULL || self->proxy == NULL)
+    {
+      g_task_return_new_error (task,
+                               G_IO_ERROR,
+                               G_IO_ERROR_CLOSED,
+                               "The connection to the agent has closed");
+      return;
+    }
+
+  ptyxis_ipc_agent_call_discover_proxy_environment (self->proxy,
+                                                    cancellable,
+                                                    ptyxis_client_discover_proxy_environment_cb,
+                                                    g_steal_pointer (&task));
+}
+
+/**
+ * ptyxis_client_discover_proxy_environment_finish:
+ *
+ * Returns: (transfer full): an environment array or %NULL and @error is set
+ */
+char **
+ptyxis_client_discover_proxy_environment_finish (PtyxisClient  *self,
+                                                 GAsyncResult  *result,
+                                                 GError       **error)
+{
+  g_return_val_if_fail (PTYXIS_IS_CLIENT (self), NULL);
+  g_return_val_if_fail (G_IS_TASK (result), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 gboolean
@@ -37,14 +37,20 @@ PtyxisClient       *ptyxis_client_new                        (gboolean
                                                               GError              **error);
 const char         *ptyxis_client_get_user_data_dir          (PtyxisClient         *self);
 void                ptyxis_client_force_exit                 (PtyxisClient         *self);
-VtePty             *ptyxis_client_create_pty                 (PtyxisClient         *self,
-                                                              GError              **error);
-int                 ptyxis_client_create_pty_producer        (PtyxisClient         *self,
-                                                              VtePty               *pty,
-                                                              GError              **error);
-char              **ptyxis_client_discover_proxy_environment (PtyxisClient         *self,
+void                ptyxis_client_create_pty_async           (PtyxisClient         *self,
                                                               GCancellable         *cancellable,
+                                                              GAsyncReadyCallback   callback,
+                                                              gpointer              user_data);
+VtePty             *ptyxis_client_create_pty_finish          (PtyxisClient         *self,
+                                                              GAsyncResult         *result,
                                                               GError              **error);
+void                ptyxis_client_discover_proxy_environment_async  (PtyxisClient         *self,
+                                                                     GCancellable         *cancellable,
+                                                                     GAsyncReadyCallback   callback,
+                                                                     gpointer              user_data);
+char              **ptyxis_client_discover_proxy_environment_finish (PtyxisClient         *self,
+                                                                     GAsyncResult         *result,
+                                                                     GError              **error);
 void                ptyxis_client_discover_shell_async       (PtyxisClient         *self,
                                                               GCancellable         *cancellable,
                                                               GAsyncReadyCallback   callback,
@@ -65,8 +71,14 @@ void                ptyxis_client_spawn_async                (PtyxisClient
 PtyxisIpcProcess   *ptyxis_client_spawn_finish               (PtyxisClient         *self,
                                                               GAsyncResult         *result,
                                                               GError              **error);
-PtyxisIpcContainer *ptyxis_client_discover_current_container (PtyxisClient         *self,
-                                                              VtePty               *pty);
+void                ptyxis_client_discover_current_container_async  (PtyxisClient         *self,
+                                                                     VtePty               *pty,
+                                                                     GCancellable         *cancellable,
+                                                                     GAsyncReadyCallback   callback,
+                                                                     gpointer              user_data);
+PtyxisIpcContainer *ptyxis_client_discover_current_container_finish (PtyxisClient         *self,
+                                                                     GAsyncResult         *result,
+                                                                     GError              **error);
 const char         *ptyxis_client_get_os_name                (PtyxisClient         *self);
 gboolean            ptyxis_client_ping                       (PtyxisClient         *self,
                                                               GError              **error);
@@ -0,0 +1,186 @@
+/*
+ * ptyxis-command-history.c
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include "ptyxis-command-history.h"
+
+/* Commands are collected from the shell integration sequences as they
+ * arrive so that anything wanting to know what ran, for how long and
+ * how it exited can look here instead of asking the agent.
+ */
+struct _PtyxisCommandHistory
+{
+  /* Newest first */
+  GQueue queue;
+  guint  max_commands;
+  guint  running : 1;
+};
+
+static void
+ptyxis_command_free (PtyxisCommand *command)
+{
+  g_clear_pointer (&command->command_line, g_free);
+  g_free (command);
+}
+
+PtyxisCommandHistory *
+ptyxis_command_history_new (guint max_commands)
+{
+  PtyxisCommandHistory *self;
+
+  g_return_val_if_fail (max_commands > 0, NULL);
+
+  self = g_new0 (PtyxisCommandHistory, 1);
+  self->max_commands = max_commands;
+  g_queue_init (&self->queue);
+
+  return self;
+}
+
+void
+ptyxis_command_history_free (PtyxisCommandHistory *self)
+{
+  if (self == NULL)
+    return;
+
+  g_queue_clear_full (&self->queue, (GDestroyNotify)ptyxis_command_free);
+  g_free (self);
+}
+
+/**
+ * ptyxis_command_history_get_nth:
+ * @self: a #PtyxisCommandHistory
+ * @nth: the position starting from the most recent command
+ *
+ * Returns: (transfer none) (nullable): a #PtyxisCommand or %NULL
+ */
+const PtyxisCommand *
+ptyxis_command_history_get_nth (PtyxisCommandHistory *self,
+                                guint                 nth)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  return g_queue_peek_nth (&self->queue, nth);
+}
+
+/**
+ * ptyxis_command_history_get_running:
+ * @self: a #PtyxisCommandHistory
+ *
+ * Returns: (transfer none) (nullable): the command which has started
+ *   but not yet returned to the prompt, or %NULL
+ */
+const PtyxisCommand *
+ptyxis_command_history_get_running (PtyxisCommandHistory *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  if (self->running)
+    return g_queue_peek_head (&self->queue);
+
+  return NULL;
+}
+
+/**
+ * ptyxis_command_history_begin:
+ * @self: a #PtyxisCommandHistory
+ * @command_line: (nullable): the command text if known
+ * @begin_time: monotonic time the command started
+ *
+ * Records the start of a new command. A command which never reported
+ * returning to the prompt is finished with an unknown exit status.
+ *
+ * Returns: (transfer none): the new running command
+ */
+const PtyxisCommand *
+ptyxis_command_history_begin (PtyxisCommandHistory *self,
+                              const char           *command_line,
+                              gint64                begin_time)
+{
+  PtyxisCommand *command;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  if (self->running)
+    ptyxis_command_history_end (self, -1, begin_time);
+
+  command = g_new0 (PtyxisCommand, 1);
+  command->command_line = g_strdup (command_line);
+  command->begin_time = begin_time;
+  command->exit_status = -1;
+
+  g_queue_push_head (&self->queue, command);
+  self->running = TRUE;
+
+  while (self->queue.length > self->max_commands)
+    ptyxis_command_free (g_queue_pop_tail (&self->queue));
+
+  return command;
+}
+
+/**
+ * ptyxis_command_history_end:
+ * @self: a #PtyxisCommandHistory
+ * @exit_status: the exit status or -1 if unknown
+ * @end_time: monotonic time the shell returned to the prompt
+ *
+ * Returns: (transfer none) (nullable): the command which finished or
+ *   %NULL if no command was running
+ */
+const PtyxisCommand *
+ptyxis_command_history_end (PtyxisCommandHistory *self,
+                            int                   exit_status,
+                            gint64                end_time)
+{
+  PtyxisCommand *command;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  if (!self->running)
+    return NULL;
+
+  command = g_queue_peek_head (&self->queue);
+  command->end_time = MAX (end_time, command->begin_time);
+  command->exit_status = exit_status;
+
+  self->running = FALSE;
+
+  return command;
+}
+
+/**
+ * ptyxis_command_get_duration:
+ * @command: a #PtyxisCommand
+ *
+ * Returns: the duration in usec, or the time elapsed so far if the
+ *   command is still running
+ */
+gint64
+ptyxis_command_get_duration (const PtyxisCommand *command)
+{
+  g_return_val_if_fail (command != NULL, 0);
+
+  if (command->end_time == 0)
+    return g_get_monotonic_time () - command->begin_time;
+
+  return command->end_time - command->begin_time;
+}
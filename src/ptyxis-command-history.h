@@ -0,0 +1,56 @@
+/*
+ * ptyxis-command-history.h
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _PtyxisCommand
+{
+  /* Text of the command as typed at the prompt, or %NULL if unknown */
+  char   *command_line;
+  /* Monotonic time in usec, @end_time is zero while still running */
+  gint64  begin_time;
+  gint64  end_time;
+  /* Exit status reported by the shell, or -1 if unknown */
+  int     exit_status;
+} PtyxisCommand;
+
+typedef struct _PtyxisCommandHistory PtyxisCommandHistory;
+
+PtyxisCommandHistory *ptyxis_command_history_new         (guint                 max_commands);
+void                  ptyxis_command_history_free        (PtyxisCommandHistory *self);
+const PtyxisCommand  *ptyxis_command_history_get_nth     (PtyxisCommandHistory *self,
+                                                          guint                 nth);
+const PtyxisCommand  *ptyxis_command_history_get_running (PtyxisCommandHistory *self);
+const PtyxisCommand  *ptyxis_command_history_begin       (PtyxisCommandHistory *self,
+                                                          const char           *command_line,
+                                                          gint64                begin_time);
+const PtyxisCommand  *ptyxis_command_history_end         (PtyxisCommandHistory *self,
+                                                          int                   exit_status,
+                                                          gint64                end_time);
+gint64                ptyxis_command_get_duration        (const PtyxisCommand  *command);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (PtyxisCommandHistory, ptyxis_command_history_free)
+
+G_END_DECLS
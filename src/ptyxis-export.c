@@ -0,0 +1,381 @@
+/*
+ * ptyxis-export.c
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include "ptyxis-export.h"
+#include "ptyxis-util.h"
+
+/* Rows are extracted from VTE on the main thread CHUNK_ROWS at a time
+ * and handed to a worker thread which compresses and writes them. The
+ * producer pauses while MAX_QUEUED chunks are waiting so that memory use
+ * stays bounded regardless of how large the scrollback is.
+ */
+#define CHUNK_ROWS    1000
+#define MAX_QUEUED    8
+#define RESUME_QUEUED 2
+
+#define HTML_HEADER \
+  "<!DOCTYPE html>\n" \
+  "<html>\n" \
+  "<head>\n" \
+  "<meta charset=\"utf-8\">\n" \
+  "<style>pre { margin: 0; }</style>\n" \
+  "</head>\n" \
+  "<body>\n"
+#define HTML_FOOTER \
+  "</body>\n" \
+  "</html>\n"
+
+typedef struct _PtyxisExport
+{
+  /* Only accessed from the main thread */
+  VteTerminal        *terminal;
+  PtyxisExportFormat  format;
+  PtyxisExportFlags   flags;
+  gint64              next_row;
+  gint64              end_row;
+  guint               produce_source;
+  guint               finished_producing : 1;
+
+  /* Only accessed from the worker thread once it has started */
+  GOutputStream      *stream;
+  GError             *error;
+
+  /* Shared between threads */
+  GAsyncQueue        *queue;
+  int                 paused;
+  int                 failed;
+} PtyxisExport;
+
+static gboolean ptyxis_export_produce_cb (gpointer data);
+
+static void
+ptyxis_export_free (PtyxisExport *state)
+{
+  g_clear_object (&state->terminal);
+  g_clear_object (&state->stream);
+  g_clear_error (&state->error);
+  g_clear_pointer (&state->queue, g_async_queue_unref);
+  g_free (state);
+}
+
+static void
+ptyxis_export_finish_producing (PtyxisExport *state)
+{
+  g_assert (state != NULL);
+  g_assert (!state->finished_producing);
+
+  state->finished_producing = TRUE;
+
+  if (state->format == PTYXIS_EXPORT_FORMAT_HTML && !g_atomic_int_get (&state->failed))
+    g_async_queue_push (state->queue, g_bytes_new_static (HTML_FOOTER, strlen (HTML_FOOTER)));
+
+  /* An empty chunk tells the worker there is nothing more to write */
+  g_async_queue_push (state->queue, g_bytes_new (NULL, 0));
+}
+
+static gboolean
+ptyxis_export_resume_cb (gpointer data)
+{
+  GTask *task = data;
+  PtyxisExport *state = g_task_get_task_data (task);
+
+  g_assert (G_IS_TASK (task));
+
+  if (!state->finished_producing && state->produce_source == 0)
+    state->produce_source = g_idle_add_full (G_PRIORITY_LOW,
+                                             ptyxis_export_produce_cb,
+                                             g_object_ref (task),
+                                             g_object_unref);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+ptyxis_export_produce_cb (gpointer data)
+{
+  GTask *task = data;
+  PtyxisExport *state = g_task_get_task_data (task);
+  VteFormat format;
+  gint64 lower;
+  gint64 end_row;
+  gsize len = 0;
+  char *text;
+  long columns;
+
+  g_assert (G_IS_TASK (task));
+  g_assert (!state->finished_producing);
+
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (task)) ||
+      g_atomic_int_get (&state->failed))
+    goto finish;
+
+  /* Skip anything which has fallen out of the scrollback since */
+  ptyxis_vte_get_row_bounds (state->terminal, &lower, NULL, NULL);
+  state->next_row = MAX (state->next_row, lower);
+
+  if (state->next_row >= state->end_row)
+    goto finish;
+
+  if (state->format == PTYXIS_EXPORT_FORMAT_HTML)
+    format = VTE_FORMAT_HTML;
+  else
+    format = VTE_FORMAT_TEXT;
+
+  end_row = MIN (state->next_row + CHUNK_ROWS, state->end_row);
+  columns = vte_terminal_get_column_count (state->terminal);
+  text = vte_terminal_get_text_range_format (state->terminal,
+                                             format,
+                                             state->next_row, 0,
+                                             end_row - 1, columns,
+                                             &len);
+  state->next_row = end_row;
+
+  if (text != NULL && len > 0)
+    g_async_queue_push (state->queue, g_bytes_new_take (text, len));
+  else
+    g_free (text);
+
+  if (state->next_row >= state->end_row)
+    goto finish;
+
+  /* Wait for the worker to catch up. It may have drained the queue
+   * before seeing @paused, so check again after setting it.
+   */
+  if (g_async_queue_length (state->queue) >= MAX_QUEUED)
+    {
+      g_atomic_int_set (&state->paused, TRUE);
+
+      if (g_async_queue_length (state->queue) >= MAX_QUEUED ||
+          !g_atomic_int_compare_and_exchange (&state->paused, TRUE, FALSE))
+        {
+          state->produce_source = 0;
+          return G_SOURCE_REMOVE;
+        }
+    }
+
+  return G_SOURCE_CONTINUE;
+
+finish:
+  ptyxis_export_finish_producing (state);
+  state->produce_source = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+ptyxis_export_complete_cb (gpointer data)
+{
+  GTask *task = data;
+  PtyxisExport *state = g_task_get_task_data (task);
+
+  g_assert (G_IS_TASK (task));
+
+  if (state->error != NULL)
+    g_task_return_error (task, g_steal_pointer (&state->error));
+  else
+    g_task_return_boolean (task, TRUE);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+ptyxis_export_worker (gpointer data)
+{
+  GTask *task = data;
+  PtyxisExport *state = g_task_get_task_data (task);
+  GCancellable *cancellable = g_task_get_cancellable (task);
+
+  g_assert (G_IS_TASK (task));
+  g_assert (G_IS_OUTPUT_STREAM (state->stream));
+
+  for (;;)
+    {
+      g_autoptr(GBytes) bytes = g_async_queue_pop (state->queue);
+      gconstpointer buf;
+      gsize len;
+
+      buf = g_bytes_get_data (bytes, &len);
+
+      if (len == 0)
+        break;
+
+      /* Keep draining after a failure so the producer can finish */
+      if (state->error == NULL &&
+          !g_output_stream_write_all (state->stream, buf, len, NULL, cancellable, &state->error))
+        g_atomic_int_set (&state->failed, TRUE);
+
+      if (g_async_queue_length (state->queue) <= RESUME_QUEUED &&
+          g_atomic_int_compare_and_exchange (&state->paused, TRUE, FALSE))
+        g_idle_add_full (G_PRIORITY_LOW,
+                         ptyxis_export_resume_cb,
+                         g_object_ref (task),
+                         g_object_unref);
+    }
+
+  if (state->error == NULL)
+    {
+      g_output_stream_close (state->stream, cancellable, &state->error);
+    }
+  else
+    {
+      g_autoptr(GCancellable) discard = g_cancellable_new ();
+
+      /* Closing with a cancelled cancellable discards the temporary
+       * file instead of replacing the destination with partial output.
+       */
+      g_cancellable_cancel (discard);
+      g_output_stream_close (state->stream, discard, NULL);
+    }
+
+  /* Complete from the main thread so that the terminal is released there */
+  g_idle_add_full (G_PRIORITY_DEFAULT,
+                   ptyxis_export_complete_cb,
+                   task,
+                   g_object_unref);
+
+  return NULL;
+}
+
+static void
+ptyxis_export_replace_cb (GObject      *object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  GFile *file = (GFile *)object;
+  g_autoptr(GFileOutputStream) stream = NULL;
+  g_autoptr(GTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  PtyxisExport *state;
+  GThread *thread;
+
+  g_assert (G_IS_FILE (file));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (G_IS_TASK (task));
+
+  state = g_task_get_task_data (task);
+
+  if (!(stream = g_file_replace_finish (file, result, &error)))
+    {
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
+    }
+
+  if (state->flags & PTYXIS_EXPORT_FLAGS_COMPRESS)
+    {
+      g_autoptr(GZlibCompressor) compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1);
+
+      state->stream = g_converter_output_stream_new (G_OUTPUT_STREAM (stream),
+                                                     G_CONVERTER (compressor));
+    }
+  else
+    {
+      state->stream = G_OUTPUT_STREAM (g_object_ref (stream));
+    }
+
+  if (state->format == PTYXIS_EXPORT_FORMAT_HTML)
+    g_async_queue_push (state->queue, g_bytes_new_static (HTML_HEADER, strlen (HTML_HEADER)));
+
+  if (!(thread = g_thread_try_new ("[ptyxis-export]",
+                                   ptyxis_export_worker,
+                                   g_object_ref (task),
+                                   &error)))
+    {
+      g_object_unref (task);
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
+    }
+
+  g_thread_unref (thread);
+
+  state->produce_source = g_idle_add_full (G_PRIORITY_LOW,
+                                           ptyxis_export_produce_cb,
+                                           g_object_ref (task),
+                                           g_object_unref);
+}
+
+/**
+ * ptyxis_export_async:
+ * @terminal: a #VteTerminal
+ * @file: the file to write to
+ * @format: the format to write the contents in
+ * @flags: flags for the export
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: a #GAsyncReadyCallback
+ * @user_data: closure data for @callback
+ *
+ * Writes the scrollback and visible contents of @terminal to @file.
+ *
+ * Unlike vte_terminal_write_contents_sync(), which serializes the whole
+ * buffer in one go, rows are extracted in small batches from the main
+ * loop while compression and I/O happen on a worker thread. Output
+ * written to @terminal after the export started is not included.
+ *
+ * If the export fails or is cancelled, @file is left untouched.
+ */
+void
+ptyxis_export_async (VteTerminal         *terminal,
+                     GFile               *file,
+                     PtyxisExportFormat   format,
+                     PtyxisExportFlags    flags,
+                     GCancellable        *cancellable,
+                     GAsyncReadyCallback  callback,
+                     gpointer             user_data)
+{
+  g_autoptr(GTask) task = NULL;
+  PtyxisExport *state;
+
+  g_return_if_fail (VTE_IS_TERMINAL (terminal));
+  g_return_if_fail (G_IS_FILE (file));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  state = g_new0 (PtyxisExport, 1);
+  state->terminal = g_object_ref (terminal);
+  state->format = format;
+  state->flags = flags;
+  ptyxis_vte_get_row_bounds (terminal, &state->next_row, NULL, &state->end_row);
+  state->queue = g_async_queue_new_full ((GDestroyNotify)g_bytes_unref);
+
+  task = g_task_new (terminal, cancellable, callback, user_data);
+  g_task_set_source_tag (task, ptyxis_export_async);
+  g_task_set_task_data (task, state, (GDestroyNotify)ptyxis_export_free);
+
+  g_file_replace_async (file,
+                        NULL,
+                        FALSE,
+                        G_FILE_CREATE_REPLACE_DESTINATION,
+                        G_PRIORITY_DEFAULT,
+                        cancellable,
+                        ptyxis_export_replace_cb,
+                        g_steal_pointer (&task));
+}
+
+gboolean
+ptyxis_export_finish (VteTerminal   *terminal,
+                      GAsyncResult  *result,
+                      GError       **error)
+{
+  g_return_val_if_fail (VTE_IS_TERMINAL (terminal), FALSE);
+  g_return_val_if_fail (G_IS_TASK (result), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
@@ -0,0 +1,51 @@
+/*
+ * ptyxis-export.h
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <vte/vte.h>
+
+G_BEGIN_DECLS
+
+typedef enum _PtyxisExportFormat
+{
+  PTYXIS_EXPORT_FORMAT_TEXT,
+  PTYXIS_EXPORT_FORMAT_HTML,
+} PtyxisExportFormat;
+
+typedef enum _PtyxisExportFlags
+{
+  PTYXIS_EXPORT_FLAGS_NONE     = 0,
+  PTYXIS_EXPORT_FLAGS_COMPRESS = 1 << 0,
+} PtyxisExportFlags;
+
+void     ptyxis_export_async  (VteTerminal          *terminal,
+                               GFile                *file,
+                               PtyxisExportFormat    format,
+                               PtyxisExportFlags     flags,
+                               GCancellable         *cancellable,
+                               GAsyncReadyCallback   callback,
+                               gpointer              user_data);
+gboolean ptyxis_export_finish (VteTerminal          *terminal,
+                               GAsyncResult         *result,
+                               GError              **error);
+
+G_END_DECLS
@@ -21,19 +21,35 @@
 
 #include "config.h"
 
+#include <glib/gi18n.h>
+
 #include "ptyxis-find-bar.h"
+#include "ptyxis-search-index.h"
 #include "ptyxis-util.h"
 
+#define QUERY_DELAY_MSEC 250
+#define MAX_RESULT_ROWS  500
+#define CONTEXT_CHARS    20
+
 struct _PtyxisFindBar
 {
-  GtkWidget        parent_instance;
-
-  PtyxisTerminal  *terminal;
-
-  GtkEntry        *entry;
-  GtkCheckButton  *use_regex;
-  GtkCheckButton  *whole_words;
-  GtkCheckButton  *match_case;
+  GtkWidget          parent_instance;
+
+  PtyxisTerminal    *terminal;
+  PtyxisSearchIndex *index;
+  GCancellable      *cancellable;
+  GArray            *matches;
+  guint              position;
+  guint              query_source;
+
+  GtkEntry          *entry;
+  GtkCheckButton    *use_regex;
+  GtkCheckButton    *whole_words;
+  GtkCheckButton    *match_case;
+  GtkLabel          *matches_label;
+  GtkToggleButton   *show_results;
+  GtkScrolledWindow *results_scroller;
+  GtkListBox        *results;
 };
 
 enum {
@@ -96,6 +112,351 @@ ptyxis_find_bar_get_search (PtyxisFindBar *self,
   return g_strdup (text);
 }
 
+static void
+ptyxis_find_bar_update_label (PtyxisFindBar *self)
+{
+  g_autofree char *label = NULL;
+  guint n_matches;
+
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+
+  if (self->matches == NULL)
+    {
+      gtk_widget_set_visible (GTK_WIDGET (self->matches_label), FALSE);
+      return;
+    }
+
+  n_matches = self->matches->len;
+
+  if (self->position < n_matches)
+    /* translators: the first %u is the current match and the second is the total number of matches */
+    label = g_strdup_printf (_("%u of %u"), self->position + 1, n_matches);
+  else
+    label = g_strdup_printf (g_dngettext (GETTEXT_PACKAGE, "%u match", "%u matches", n_matches),
+                             n_matches);
+
+  gtk_label_set_label (self->matches_label, label);
+  gtk_widget_set_visible (GTK_WIDGET (self->matches_label), TRUE);
+}
+
+static void
+ptyxis_find_bar_jump (PtyxisFindBar *self,
+                      guint          position)
+{
+  const PtyxisSearchMatch *match;
+  GtkListBoxRow *row;
+  VteTerminal *terminal;
+  gint64 top_row;
+  guint first;
+
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+
+  if (self->terminal == NULL ||
+      self->matches == NULL ||
+      position >= self->matches->len)
+    return;
+
+  terminal = VTE_TERMINAL (self->terminal);
+  self->position = position;
+  match = &g_array_index (self->matches, PtyxisSearchMatch, position);
+
+  /* The index only tells us where to look. Without a selection VTE
+   * searches forward from the top of the view, so start there and let
+   * it select and highlight the match as usual. Matches above the
+   * match row may still be in view if the scrollback ends below it.
+   */
+  vte_terminal_unselect_all (terminal);
+  ptyxis_vte_scroll_to_row (terminal, match->row);
+  ptyxis_vte_get_row_bounds (terminal, NULL, &top_row, NULL);
+
+  first = position;
+  while (first > 0 &&
+         g_array_index (self->matches, PtyxisSearchMatch, first - 1).row >= top_row)
+    first--;
+
+  for (guint i = first; i <= position; i++)
+    {
+      if (!vte_terminal_search_find_next (terminal))
+        break;
+    }
+
+  if ((row = gtk_list_box_get_row_at_index (self->results, position)))
+    gtk_list_box_select_row (self->results, row);
+
+  ptyxis_find_bar_update_label (self);
+}
+
+static GtkWidget *
+ptyxis_find_bar_create_row (const PtyxisSearchMatch *match)
+{
+  g_autofree char *text = NULL;
+  const char *begin;
+  GtkWidget *label;
+
+  g_assert (match != NULL);
+  g_assert (match->text != NULL);
+
+  /* Show a bit of leading context so the match itself is visible */
+  begin = match->text + match->offset;
+  for (guint i = 0; i < CONTEXT_CHARS && begin > match->text; i++)
+    begin = g_utf8_find_prev_char (match->text, begin);
+
+  if (begin > match->text)
+    text = g_strconcat ("…", begin, NULL);
+  else
+    text = g_strdup (begin);
+
+  label = g_object_new (GTK_TYPE_LABEL,
+                        "label", text,
+                        "xalign", .0f,
+                        "single-line-mode", TRUE,
+                        "ellipsize", PANGO_ELLIPSIZE_END,
+                        NULL);
+  gtk_widget_add_css_class (label, "monospace");
+
+  return label;
+}
+
+static gboolean
+ptyxis_find_bar_match_equal (const PtyxisSearchMatch *a,
+                             const PtyxisSearchMatch *b)
+{
+  return a->row == b->row &&
+         a->offset == b->offset &&
+         a->length == b->length &&
+         g_strcmp0 (a->text, b->text) == 0;
+}
+
+static void
+ptyxis_find_bar_update_rows (PtyxisFindBar *self,
+                             GArray        *old_matches,
+                             GArray        *new_matches)
+{
+  guint n_old;
+  guint n_new;
+  guint n_keep = 0;
+
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+
+  n_old = old_matches ? MIN (old_matches->len, MAX_RESULT_ROWS) : 0;
+  n_new = new_matches ? MIN (new_matches->len, MAX_RESULT_ROWS) : 0;
+
+  /* New output only adds matches at the end, so usually most of the
+   * existing rows can be kept as they are.
+   */
+  while (n_keep < MIN (n_old, n_new) &&
+         ptyxis_find_bar_match_equal (&g_array_index (old_matches, PtyxisSearchMatch, n_keep),
+                                      &g_array_index (new_matches, PtyxisSearchMatch, n_keep)))
+    n_keep++;
+
+  for (guint i = n_old; i > n_keep; i--)
+    gtk_list_box_remove (self->results,
+                         GTK_WIDGET (gtk_list_box_get_row_at_index (self->results, i - 1)));
+
+  for (guint i = n_keep; i < n_new; i++)
+    gtk_list_box_append (self->results,
+                         ptyxis_find_bar_create_row (&g_array_index (new_matches, PtyxisSearchMatch, i)));
+}
+
+static void
+ptyxis_find_bar_set_matches (PtyxisFindBar *self,
+                             GArray        *matches)
+{
+  guint position = G_MAXUINT;
+
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+
+  /* Try to keep our place when the results are refreshed because
+   * new output was indexed.
+   */
+  if (matches != NULL &&
+      self->matches != NULL &&
+      self->position < self->matches->len)
+    {
+      const PtyxisSearchMatch *current = &g_array_index (self->matches, PtyxisSearchMatch, self->position);
+
+      for (guint i = 0; i < matches->len; i++)
+        {
+          const PtyxisSearchMatch *match = &g_array_index (matches, PtyxisSearchMatch, i);
+
+          if (match->row == current->row && match->offset == current->offset)
+            {
+              position = i;
+              break;
+            }
+        }
+    }
+
+  ptyxis_find_bar_update_rows (self, self->matches, matches);
+
+  g_clear_pointer (&self->matches, g_array_unref);
+  self->matches = matches ? g_array_ref (matches) : NULL;
+  self->position = position;
+
+  gtk_list_box_unselect_all (self->results);
+
+  gtk_widget_set_sensitive (GTK_WIDGET (self->show_results),
+                            self->matches != NULL && self->matches->len > 0);
+
+  if (self->position != G_MAXUINT)
+    {
+      GtkListBoxRow *row;
+
+      if ((row = gtk_list_box_get_row_at_index (self->results, self->position)))
+        gtk_list_box_select_row (self->results, row);
+    }
+
+  ptyxis_find_bar_update_label (self);
+}
+
+static void
+ptyxis_find_bar_query_cb (GObject      *object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  PtyxisSearchIndex *index = (PtyxisSearchIndex *)object;
+  g_autoptr(PtyxisFindBar) self = user_data;
+  g_autoptr(GArray) matches = NULL;
+  g_autoptr(GError) error = NULL;
+
+  g_assert (PTYXIS_IS_SEARCH_INDEX (index));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+
+  if (!(matches = ptyxis_search_index_query_finish (index, result, &error)))
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_debug ("Failed to query search index: %s", error->message);
+      return;
+    }
+
+  if (index != self->index)
+    return;
+
+  ptyxis_find_bar_set_matches (self, matches);
+}
+
+static void ptyxis_find_bar_queue_query (PtyxisFindBar *self);
+
+static void
+ptyxis_find_bar_query (PtyxisFindBar *self)
+{
+  g_autoptr(GRegex) regex = NULL;
+  g_autofree char *query = NULL;
+  GRegexCompileFlags compile_flags = G_REGEX_OPTIMIZE;
+  const char *literal = NULL;
+  const char *text;
+  guint flags = 0;
+
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+
+  g_clear_handle_id (&self->query_source, g_source_remove);
+
+  g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+
+  if (self->terminal == NULL ||
+      !(query = ptyxis_find_bar_get_search (self, &flags)))
+    {
+      ptyxis_find_bar_set_matches (self, NULL);
+      return;
+    }
+
+  if (flags & VTE_PCRE2_CASELESS)
+    compile_flags |= G_REGEX_CASELESS;
+
+  /* Patterns only PCRE2 understands still work with find next/previous */
+  if (!(regex = g_regex_new (query, compile_flags, 0, NULL)))
+    {
+      ptyxis_find_bar_set_matches (self, NULL);
+      return;
+    }
+
+  /* The index folds ASCII case only, so we can only narrow by the
+   * literal text when that is enough to find every match.
+   */
+  text = gtk_editable_get_text (GTK_EDITABLE (self->entry));
+  if (!gtk_check_button_get_active (self->use_regex) &&
+      (gtk_check_button_get_active (self->match_case) || g_str_is_ascii (text)))
+    literal = text;
+
+  if (self->index == NULL)
+    {
+      self->index = ptyxis_search_index_new (VTE_TERMINAL (self->terminal));
+      g_signal_connect_object (self->index,
+                               "changed",
+                               G_CALLBACK (ptyxis_find_bar_queue_query),
+                               self,
+                               G_CONNECT_SWAPPED);
+    }
+
+  self->cancellable = g_cancellable_new ();
+
+  ptyxis_search_index_query_async (self->index,
+                                   regex,
+                                   literal,
+                                   self->cancellable,
+                                   ptyxis_find_bar_query_cb,
+                                   g_object_ref (self));
+}
+
+static gboolean
+ptyxis_find_bar_query_source_func (gpointer data)
+{
+  PtyxisFindBar *self = data;
+
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+
+  self->query_source = 0;
+
+  if (gtk_widget_get_mapped (GTK_WIDGET (self)))
+    ptyxis_find_bar_query (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ptyxis_find_bar_queue_query (PtyxisFindBar *self)
+{
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+
+  if (self->query_source == 0)
+    self->query_source = g_timeout_add_full (G_PRIORITY_LOW,
+                                             QUERY_DELAY_MSEC,
+                                             ptyxis_find_bar_query_source_func,
+                                             self, NULL);
+}
+
+static void
+ptyxis_find_bar_clear_index (PtyxisFindBar *self)
+{
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+
+  g_clear_handle_id (&self->query_source, g_source_remove);
+  g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+
+  if (self->index != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (self->index,
+                                            G_CALLBACK (ptyxis_find_bar_queue_query),
+                                            self);
+      g_clear_object (&self->index);
+    }
+}
+
+static void
+ptyxis_find_bar_row_activated_cb (PtyxisFindBar *self,
+                                  GtkListBoxRow *row,
+                                  GtkListBox    *list_box)
+{
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+  g_assert (GTK_IS_LIST_BOX_ROW (row));
+  g_assert (GTK_IS_LIST_BOX (list_box));
+
+  ptyxis_find_bar_jump (self, gtk_list_box_row_get_index (row));
+}
+
 static void
 ptyxis_find_bar_next (GtkWidget  *widget,
                       const char *action_name,
@@ -105,7 +466,14 @@ ptyxis_find_bar_next (GtkWidget  *widget,
 
   g_assert (PTYXIS_IS_FIND_BAR (self));
 
-  if (self->terminal != NULL)
+  if (self->matches != NULL && self->matches->len > 0)
+    {
+      if (self->position >= self->matches->len)
+        ptyxis_find_bar_jump (self, 0);
+      else
+        ptyxis_find_bar_jump (self, (self->position + 1) % self->matches->len);
+    }
+  else if (self->terminal != NULL)
     vte_terminal_search_find_next (VTE_TERMINAL (self->terminal));
 }
 
@@ -118,7 +486,16 @@ ptyxis_find_bar_previous (GtkWidget  *widget,
 
   g_assert (PTYXIS_IS_FIND_BAR (self));
 
-  if (self->terminal != NULL)
+  if (self->matches != NULL && self->matches->len > 0)
+    {
+      guint n_matches = self->matches->len;
+
+      if (self->position >= n_matches)
+        ptyxis_find_bar_jump (self, n_matches - 1);
+      else
+        ptyxis_find_bar_jump (self, (self->position + n_matches - 1) % n_matches);
+    }
+  else if (self->terminal != NULL)
     vte_terminal_search_find_previous (VTE_TERMINAL (self->terminal));
 }
 
@@ -143,6 +520,35 @@ ptyxis_find_bar_entry_changed_cb (PtyxisFindBar *self,
 
   vte_terminal_search_set_regex (VTE_TERMINAL (self->terminal), regex, 0);
   vte_terminal_search_set_wrap_around (VTE_TERMINAL (self->terminal), TRUE);
+
+  ptyxis_find_bar_query (self);
+}
+
+static void
+ptyxis_find_bar_map (GtkWidget *widget)
+{
+  PtyxisFindBar *self = (PtyxisFindBar *)widget;
+
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+
+  GTK_WIDGET_CLASS (ptyxis_find_bar_parent_class)->map (widget);
+
+  /* The index was released while we were hidden */
+  ptyxis_find_bar_query (self);
+}
+
+static void
+ptyxis_find_bar_unmap (GtkWidget *widget)
+{
+  PtyxisFindBar *self = (PtyxisFindBar *)widget;
+
+  g_assert (PTYXIS_IS_FIND_BAR (self));
+
+  /* Don't keep a copy of the scrollback around while not searching */
+  ptyxis_find_bar_clear_index (self);
+  ptyxis_find_bar_set_matches (self, NULL);
+
+  GTK_WIDGET_CLASS (ptyxis_find_bar_parent_class)->unmap (widget);
 }
 
 static void
@@ -156,6 +562,8 @@ ptyxis_find_bar_dispose (GObject *object)
   while ((child = gtk_widget_get_first_child (GTK_WIDGET (self))))
     gtk_widget_unparent (child);
 
+  ptyxis_find_bar_clear_index (self);
+  g_clear_pointer (&self->matches, g_array_unref);
   g_clear_object (&self->terminal);
 
   G_OBJECT_CLASS (ptyxis_find_bar_parent_class)->dispose (object);
@@ -191,8 +599,7 @@ ptyxis_find_bar_set_property (GObject      *object,
   switch (prop_id)
     {
     case PROP_TERMINAL:
-      if (g_set_object (&self->terminal, g_value_get_object (value)))
-        g_object_notify_by_pspec (object, pspec);
+      ptyxis_find_bar_set_terminal (self, g_value_get_object (value));
       break;
 
     default:
@@ -211,6 +618,8 @@ ptyxis_find_bar_class_init (PtyxisFindBarClass *klass)
   object_class->set_property = ptyxis_find_bar_set_property;
 
   widget_class->grab_focus = ptyxis_find_bar_grab_focus;
+  widget_class->map = ptyxis_find_bar_map;
+  widget_class->unmap = ptyxis_find_bar_unmap;
 
   properties[PROP_TERMINAL] =
     g_param_spec_object ("terminal", NULL, NULL,
@@ -229,8 +638,13 @@ ptyxis_find_bar_class_init (PtyxisFindBarClass *klass)
   gtk_widget_class_bind_template_child (widget_class, PtyxisFindBar, use_regex);
   gtk_widget_class_bind_template_child (widget_class, PtyxisFindBar, whole_words);
   gtk_widget_class_bind_template_child (widget_class, PtyxisFindBar, match_case);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisFindBar, matches_label);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisFindBar, show_results);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisFindBar, results_scroller);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisFindBar, results);
 
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_find_bar_entry_changed_cb);
+  gtk_widget_class_bind_template_callback (widget_class, ptyxis_find_bar_row_activated_cb);
 
   gtk_widget_class_install_action (widget_class, "search.dismiss", NULL, ptyxis_find_bar_dismiss);
   gtk_widget_class_install_action (widget_class, "search.down", NULL, ptyxis_find_bar_next);
@@ -244,7 +658,13 @@ ptyxis_find_bar_class_init (PtyxisFindBarClass *klass)
 static void
 ptyxis_find_bar_init (PtyxisFindBar *self)
 {
+  self->position = G_MAXUINT;
+
   gtk_widget_init_template (GTK_WIDGET (self));
+
+  g_object_bind_property (self->show_results, "active",
+                          self->results_scroller, "visible",
+                          G_BINDING_SYNC_CREATE);
 }
 
 PtyxisTerminal *
@@ -264,6 +684,8 @@ ptyxis_find_bar_set_terminal (PtyxisFindBar  *self,
 
   if (g_set_object (&self->terminal, terminal))
     {
+      ptyxis_find_bar_clear_index (self);
+      ptyxis_find_bar_set_matches (self, NULL);
       gtk_editable_set_text (GTK_EDITABLE (self->entry), "");
       g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TERMINAL]);
     }
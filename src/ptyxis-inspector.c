@@ -22,8 +22,10 @@
 
 #include <glib/gi18n.h>
 
+#include "ptyxis-application.h"
 #include "ptyxis-inspector.h"
 #include "ptyxis-palette-preview-color.h"
+#include "ptyxis-tab-private.h"
 
 /* This will not transition to AdwDialog until there is a way for
  * toplevel windows _with_ transient-for set to maintain window
@@ -50,8 +52,12 @@ struct _PtyxisInspector
   AdwActionRow              *font_desc;
   AdwActionRow              *grid_size;
   AdwActionRow              *hyperlink_hover;
+  AdwActionRow              *scrollback;
+  AdwActionRow              *scrollback_budget;
+  AdwActionRow              *stalls;
   AdwActionRow              *window_title;
   GtkLabel                  *pid;
+  AdwPreferencesGroup       *main_loop;
   PtyxisPalettePreviewColor *color0;
   PtyxisPalettePreviewColor *color1;
   PtyxisPalettePreviewColor *color2;
@@ -198,6 +204,85 @@ ptyxis_inspector_shell_precmd_cb (PtyxisInspector *self,
   gtk_label_set_label (self->pid, NULL);
 }
 
+static void
+ptyxis_inspector_update_scrollback (PtyxisInspector *self)
+{
+  PtyxisScrollbackBudget *budget;
+  g_autoptr(PtyxisTab) tab = NULL;
+  g_autofree char *usage_str = NULL;
+  g_autofree char *str = NULL;
+  guint64 usage;
+  guint64 limit;
+  guint n_lines = 0;
+
+  g_assert (PTYXIS_IS_INSPECTOR (self));
+
+  if ((tab = ptyxis_inspector_dup_tab (self)))
+    {
+      usage = _ptyxis_tab_get_scrollback_usage (tab, &n_lines);
+      usage_str = g_format_size (usage);
+      str = g_strdup_printf (_("%u lines (about %s)"), n_lines, usage_str);
+      adw_action_row_set_subtitle (self->scrollback, str);
+      g_clear_pointer (&usage_str, g_free);
+      g_clear_pointer (&str, g_free);
+    }
+
+  if (!(budget = ptyxis_application_get_scrollback_budget (PTYXIS_APPLICATION_DEFAULT)))
+    return;
+
+  usage = ptyxis_scrollback_budget_get_usage (budget);
+  limit = ptyxis_scrollback_budget_get_limit (budget);
+  usage_str = g_format_size (usage);
+
+  if (limit > 0)
+    {
+      g_autofree char *limit_str = g_format_size (limit);
+      /* translators: first %s is current usage, second is the limit, such as "1.2 MB of 512 MB" */
+      str = g_strdup_printf (_("%s of %s"), usage_str, limit_str);
+    }
+  else
+    {
+      str = g_strdup_printf (_("%s (unlimited)"), usage_str);
+    }
+
+  adw_action_row_set_subtitle (self->scrollback_budget, str);
+}
+
+static void
+ptyxis_inspector_update_stalls (PtyxisInspector *self)
+{
+  PtyxisStallMonitor *monitor;
+  g_autofree char *n_stalls_str = NULL;
+  g_autofree char *str = NULL;
+  guint64 n_stalls;
+  gint64 longest;
+
+  g_assert (PTYXIS_IS_INSPECTOR (self));
+
+  if (!(monitor = ptyxis_application_get_stall_monitor (PTYXIS_APPLICATION_DEFAULT)))
+    return;
+
+  n_stalls = ptyxis_stall_monitor_get_n_stalls (monitor);
+  longest = ptyxis_stall_monitor_get_longest (monitor);
+
+  n_stalls_str = g_strdup_printf ("%"G_GUINT64_FORMAT, n_stalls);
+
+  /* translators: first is the number of stalls, second is the longest stall in milliseconds */
+  str = g_strdup_printf (_("%s stalls, longest %.1lf ms"),
+                         n_stalls_str, longest / 1000.);
+  adw_action_row_set_subtitle (self->stalls, str);
+}
+
+static void
+ptyxis_inspector_contents_changed_cb (PtyxisInspector *self,
+                                      PtyxisTerminal  *terminal)
+{
+  g_assert (PTYXIS_IS_INSPECTOR (self));
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  ptyxis_inspector_update_scrollback (self);
+}
+
 static void
 ptyxis_inspector_bind_terminal_cb (PtyxisInspector *self,
                                    PtyxisTerminal  *terminal,
@@ -223,6 +308,7 @@ ptyxis_inspector_bind_terminal_cb (PtyxisInspector *self,
   ptyxis_inspector_grid_size_changed_cb (self, columns, rows, terminal);
   ptyxis_inspector_update_font (self, NULL, terminal);
   ptyxis_inspector_shell_preexec_cb (self, terminal);
+  ptyxis_inspector_update_scrollback (self);
 }
 
 static PtyxisTerminal *
@@ -484,8 +570,12 @@ ptyxis_inspector_class_init (PtyxisInspectorClass *klass)
   gtk_widget_class_bind_template_child (widget_class, PtyxisInspector, font_desc);
   gtk_widget_class_bind_template_child (widget_class, PtyxisInspector, grid_size);
   gtk_widget_class_bind_template_child (widget_class, PtyxisInspector, hyperlink_hover);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisInspector, main_loop);
   gtk_widget_class_bind_template_child (widget_class, PtyxisInspector, pid);
   gtk_widget_class_bind_template_child (widget_class, PtyxisInspector, pointer);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisInspector, scrollback);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisInspector, scrollback_budget);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisInspector, stalls);
   gtk_widget_class_bind_template_child (widget_class, PtyxisInspector, window_title);
 
   g_type_ensure (PTYXIS_TYPE_PALETTE_PREVIEW_COLOR);
@@ -586,6 +676,29 @@ ptyxis_inspector_init (PtyxisInspector *self)
                                  G_CALLBACK (ptyxis_inspector_shell_preexec_cb),
                                  self,
                                  G_CONNECT_SWAPPED);
+  g_signal_group_connect_object (self->terminal_signals,
+                                 "contents-changed",
+                                 G_CALLBACK (ptyxis_inspector_contents_changed_cb),
+                                 self,
+                                 G_CONNECT_SWAPPED);
+
+  if (ptyxis_application_get_scrollback_budget (PTYXIS_APPLICATION_DEFAULT))
+    g_signal_connect_object (ptyxis_application_get_scrollback_budget (PTYXIS_APPLICATION_DEFAULT),
+                             "notify::usage",
+                             G_CALLBACK (ptyxis_inspector_update_scrollback),
+                             self,
+                             G_CONNECT_SWAPPED);
+
+  if (ptyxis_application_get_stall_monitor (PTYXIS_APPLICATION_DEFAULT))
+    {
+      g_signal_connect_object (ptyxis_application_get_stall_monitor (PTYXIS_APPLICATION_DEFAULT),
+                               "notify::n-stalls",
+                               G_CALLBACK (ptyxis_inspector_update_stalls),
+                               self,
+                               G_CONNECT_SWAPPED);
+      gtk_widget_set_visible (GTK_WIDGET (self->main_loop), TRUE);
+      ptyxis_inspector_update_stalls (self);
+    }
 }
 
 PtyxisInspector *
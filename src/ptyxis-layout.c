@@ -0,0 +1,527 @@
+/*
+ * ptyxis-layout.c
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include <glib/gi18n.h>
+
+#include <json-glib/json-glib.h>
+
+#include "ptyxis-application.h"
+#include "ptyxis-layout.h"
+#include "ptyxis-tab-private.h"
+#include "ptyxis-util.h"
+#include "ptyxis-window.h"
+
+/* How many tabs may be waiting on the agent for a PTY and spawn at once.
+ * This keeps a large layout from flooding the agent while still
+ * overlapping the round-trips of neighboring tabs.
+ */
+#define MAX_CONCURRENT_SPAWNS 4
+
+typedef struct _SpawnBatch
+{
+  GQueue pending;
+  guint  n_active;
+} SpawnBatch;
+
+typedef struct _LayoutTab
+{
+  PtyxisProfile      *profile;
+  PtyxisIpcContainer *container;
+  char               *cwd_uri;
+  char               *title;
+  char              **argv;
+} LayoutTab;
+
+typedef struct _LayoutWindow
+{
+  GPtrArray *tabs;
+  gboolean   maximize;
+} LayoutWindow;
+
+static void spawn_batch_pump (SpawnBatch *batch);
+
+static void
+layout_tab_free (gpointer data)
+{
+  LayoutTab *tab = data;
+
+  g_clear_object (&tab->profile);
+  g_clear_object (&tab->container);
+  g_clear_pointer (&tab->cwd_uri, g_free);
+  g_clear_pointer (&tab->title, g_free);
+  g_clear_pointer (&tab->argv, g_strfreev);
+  g_free (tab);
+}
+
+static void
+layout_window_free (gpointer data)
+{
+  LayoutWindow *window = data;
+
+  g_clear_pointer (&window->tabs, g_ptr_array_unref);
+  g_free (window);
+}
+
+static void
+spawn_batch_spawn_cb (GObject      *object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+  PtyxisTab *tab = (PtyxisTab *)object;
+  SpawnBatch *batch = user_data;
+  g_autoptr(GError) error = NULL;
+
+  g_assert (PTYXIS_IS_TAB (tab));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (batch != NULL);
+  g_assert (batch->n_active > 0);
+
+  /* Failures are already shown to the user within the tab */
+  if (!_ptyxis_tab_spawn_finish (tab, result, &error))
+    g_debug ("Failed to spawn tab %s: %s",
+             ptyxis_tab_get_uuid (tab), error->message);
+
+  batch->n_active--;
+
+  spawn_batch_pump (batch);
+}
+
+static void
+spawn_batch_pump (SpawnBatch *batch)
+{
+  g_assert (batch != NULL);
+
+  while (batch->n_active < MAX_CONCURRENT_SPAWNS &&
+         !g_queue_is_empty (&batch->pending))
+    {
+      g_autoptr(PtyxisTab) tab = g_queue_pop_head (&batch->pending);
+
+      /* Closed tabs must not start a process, and tabs which were
+       * mapped in the meantime have already spawned on their own.
+       */
+      if (gtk_widget_get_root (GTK_WIDGET (tab)) == NULL ||
+          !_ptyxis_tab_needs_spawn (tab))
+        continue;
+
+      batch->n_active++;
+
+      _ptyxis_tab_spawn_async (tab, NULL, spawn_batch_spawn_cb, batch);
+    }
+
+  if (batch->n_active == 0)
+    g_free (batch);
+}
+
+/**
+ * ptyxis_layout_spawn_tabs:
+ * @tabs: (array length=n_tabs): tabs to spawn
+ * @n_tabs: the number of tabs
+ *
+ * Spawns the processes for @tabs without waiting for each tab to be
+ * mapped, keeping at most a few requests to the agent in flight.
+ *
+ * Tabs which are mapped in the meantime spawn on their own and are
+ * skipped when their turn comes.
+ */
+void
+ptyxis_layout_spawn_tabs (PtyxisTab * const *tabs,
+                          guint              n_tabs)
+{
+  SpawnBatch *batch;
+
+  g_return_if_fail (tabs != NULL || n_tabs == 0);
+
+  if (n_tabs == 0)
+    return;
+
+  batch = g_new0 (SpawnBatch, 1);
+  g_queue_init (&batch->pending);
+
+  for (guint i = 0; i < n_tabs; i++)
+    g_queue_push_tail (&batch->pending, g_object_ref (tabs[i]));
+
+  spawn_batch_pump (batch);
+}
+
+static char *
+resolve_cwd (GFile      *base,
+             const char *cwd)
+{
+  g_autoptr(GFile) file = NULL;
+
+  g_assert (!base || G_IS_FILE (base));
+
+  if (ptyxis_str_empty0 (cwd))
+    return NULL;
+
+  if (g_uri_peek_scheme (cwd) != NULL)
+    return g_strdup (cwd);
+
+  if (cwd[0] == '~' && (cwd[1] == 0 || cwd[1] == G_DIR_SEPARATOR))
+    file = g_file_new_build_filename (g_get_home_dir (), &cwd[1], NULL);
+  else if (g_path_is_absolute (cwd) || base == NULL)
+    file = g_file_new_for_path (cwd);
+  else
+    file = g_file_resolve_relative_path (base, cwd);
+
+  return g_file_get_uri (file);
+}
+
+static gboolean
+get_string_member (JsonObject  *object,
+                   const char  *member_name,
+                   const char **value,
+                   GError     **error)
+{
+  JsonNode *node;
+
+  g_assert (object != NULL);
+  g_assert (member_name != NULL);
+  g_assert (value != NULL);
+
+  *value = NULL;
+
+  if (!(node = json_object_get_member (object, member_name)) ||
+      JSON_NODE_HOLDS_NULL (node))
+    return TRUE;
+
+  if (!JSON_NODE_HOLDS_VALUE (node) ||
+      json_node_get_value_type (node) != G_TYPE_STRING)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_DATA,
+                   _("“%s” must be a string"),
+                   member_name);
+      return FALSE;
+    }
+
+  *value = json_node_get_string (node);
+
+  return TRUE;
+}
+
+static gboolean
+get_boolean_member (JsonObject  *object,
+                    const char  *member_name,
+                    gboolean    *value,
+                    GError     **error)
+{
+  JsonNode *node;
+
+  g_assert (object != NULL);
+  g_assert (member_name != NULL);
+  g_assert (value != NULL);
+
+  *value = FALSE;
+
+  if (!(node = json_object_get_member (object, member_name)) ||
+      JSON_NODE_HOLDS_NULL (node))
+    return TRUE;
+
+  if (!JSON_NODE_HOLDS_VALUE (node) ||
+      json_node_get_value_type (node) != G_TYPE_BOOLEAN)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_DATA,
+                   _("“%s” must be true or false"),
+                   member_name);
+      return FALSE;
+    }
+
+  *value = json_node_get_boolean (node);
+
+  return TRUE;
+}
+
+static gboolean
+parse_tab (JsonObject  *object,
+           GFile       *base,
+           LayoutTab   *tab,
+           GError     **error)
+{
+  PtyxisApplication *app = PTYXIS_APPLICATION_DEFAULT;
+  const char *profile_uuid;
+  const char *container_id;
+  const char *cwd;
+  const char *title;
+
+  g_assert (object != NULL);
+  g_assert (tab != NULL);
+
+  if (!get_string_member (object, "profile", &profile_uuid, error) ||
+      !get_string_member (object, "container", &container_id, error) ||
+      !get_string_member (object, "cwd", &cwd, error) ||
+      !get_string_member (object, "title", &title, error))
+    return FALSE;
+
+  if (!ptyxis_str_empty0 (profile_uuid))
+    tab->profile = ptyxis_application_dup_profile (app, profile_uuid);
+  else
+    tab->profile = ptyxis_application_dup_default_profile (app);
+
+  if (tab->profile == NULL)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_NOT_FOUND,
+                   _("No such profile “%s”"),
+                   profile_uuid);
+      return FALSE;
+    }
+
+  if (!ptyxis_str_empty0 (container_id) &&
+      !(tab->container = ptyxis_application_lookup_container (app, container_id)))
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_NOT_FOUND,
+                   _("No such container “%s”"),
+                   container_id);
+      return FALSE;
+    }
+
+  if (json_object_has_member (object, "command"))
+    {
+      JsonNode *node = json_object_get_member (object, "command");
+
+      if (JSON_NODE_HOLDS_ARRAY (node))
+        {
+          JsonArray *ar = json_node_get_array (node);
+          guint length = json_array_get_length (ar);
+          g_autoptr(GStrvBuilder) builder = g_strv_builder_new ();
+
+          for (guint i = 0; i < length; i++)
+            {
+              JsonNode *arg = json_array_get_element (ar, i);
+
+              if (!JSON_NODE_HOLDS_VALUE (arg) ||
+                  json_node_get_value_type (arg) != G_TYPE_STRING)
+                goto invalid_command;
+
+              g_strv_builder_add (builder, json_node_get_string (arg));
+            }
+
+          tab->argv = g_strv_builder_end (builder);
+        }
+      else if (JSON_NODE_HOLDS_VALUE (node) &&
+               json_node_get_value_type (node) == G_TYPE_STRING)
+        {
+          if (!g_shell_parse_argv (json_node_get_string (node), NULL, &tab->argv, error))
+            return FALSE;
+        }
+      else
+        goto invalid_command;
+
+      if (tab->argv[0] == NULL)
+        g_clear_pointer (&tab->argv, g_strfreev);
+    }
+
+  tab->cwd_uri = resolve_cwd (base, cwd);
+  tab->title = g_strdup (title);
+
+  return TRUE;
+
+invalid_command:
+  g_set_error_literal (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_DATA,
+                       _("“command” must be a string or an array of strings"));
+  return FALSE;
+}
+
+static GPtrArray *
+parse_layout (JsonNode  *root,
+              GFile     *base,
+              GError   **error)
+{
+  g_autoptr(GPtrArray) windows = NULL;
+  JsonArray *windows_ar;
+  JsonObject *object;
+  guint n_windows;
+
+  g_assert (root != NULL);
+
+  windows = g_ptr_array_new_with_free_func (layout_window_free);
+
+  if (!JSON_NODE_HOLDS_OBJECT (root) ||
+      !(object = json_node_get_object (root)) ||
+      !json_object_has_member (object, "windows") ||
+      !JSON_NODE_HOLDS_ARRAY (json_object_get_member (object, "windows")))
+    goto invalid_layout;
+
+  windows_ar = json_object_get_array_member (object, "windows");
+  n_windows = json_array_get_length (windows_ar);
+
+  for (guint i = 0; i < n_windows; i++)
+    {
+      JsonNode *window_node = json_array_get_element (windows_ar, i);
+      LayoutWindow *window;
+      JsonObject *window_object;
+      JsonArray *tabs_ar;
+      guint n_tabs;
+
+      if (!JSON_NODE_HOLDS_OBJECT (window_node))
+        goto invalid_layout;
+
+      window_object = json_node_get_object (window_node);
+
+      if (!json_object_has_member (window_object, "tabs") ||
+          !JSON_NODE_HOLDS_ARRAY (json_object_get_member (window_object, "tabs")))
+        goto invalid_layout;
+
+      tabs_ar = json_object_get_array_member (window_object, "tabs");
+      n_tabs = json_array_get_length (tabs_ar);
+
+      if (n_tabs == 0)
+        continue;
+
+      window = g_new0 (LayoutWindow, 1);
+      window->tabs = g_ptr_array_new_with_free_func (layout_tab_free);
+      g_ptr_array_add (windows, window);
+
+      if (!get_boolean_member (window_object, "maximize", &window->maximize, error))
+        return NULL;
+
+      for (guint j = 0; j < n_tabs; j++)
+        {
+          JsonNode *tab_node = json_array_get_element (tabs_ar, j);
+          LayoutTab *tab;
+
+          if (!JSON_NODE_HOLDS_OBJECT (tab_node))
+            goto invalid_layout;
+
+          tab = g_new0 (LayoutTab, 1);
+          g_ptr_array_add (window->tabs, tab);
+
+          if (!parse_tab (json_node_get_object (tab_node), base, tab, error))
+            return NULL;
+        }
+    }
+
+  return g_steal_pointer (&windows);
+
+invalid_layout:
+  g_set_error_literal (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_DATA,
+                       _("Layout must contain a list of “windows” each with a list of “tabs”"));
+  return NULL;
+}
+
+/**
+ * ptyxis_layout_load_file:
+ * @file: a #GFile containing a JSON layout
+ * @error: a location for a #GError
+ *
+ * Opens the windows and tabs described by @file.
+ *
+ * The layout is a JSON object with a "windows" array. Each window is an
+ * object with a "tabs" array and an optional "maximize" boolean. Each
+ * tab may contain "profile" (a profile UUID), "container" (a container
+ * id), "cwd" (a URI, or a path relative to @file), "command" (an argv
+ * array or a shell string) and "title".
+ *
+ * The whole layout is validated before anything is created. All tabs
+ * are then created in one pass and their processes are spawned as a
+ * batch rather than as each tab is first shown.
+ *
+ * Returns: %TRUE if successful; otherwise %FALSE and @error is set
+ */
+gboolean
+ptyxis_layout_load_file (GFile   *file,
+                         GError **error)
+{
+  g_autoptr(JsonParser) parser = NULL;
+  g_autoptr(GPtrArray) windows = NULL;
+  g_autoptr(GPtrArray) tabs = NULL;
+  g_autoptr(GFile) base = NULL;
+  g_autofree char *path = NULL;
+
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+
+  if (!(path = g_file_get_path (file)))
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_NOT_SUPPORTED,
+                           _("Layouts must be local files"));
+      return FALSE;
+    }
+
+  parser = json_parser_new ();
+
+  if (!json_parser_load_from_mapped_file (parser, path, error))
+    return FALSE;
+
+  base = g_file_get_parent (file);
+
+  if (!(windows = parse_layout (json_parser_get_root (parser), base, error)))
+    return FALSE;
+
+  tabs = g_ptr_array_new ();
+
+  for (guint i = 0; i < windows->len; i++)
+    {
+      LayoutWindow *layout_window = g_ptr_array_index (windows, i);
+      PtyxisWindow *window = ptyxis_window_new_empty ();
+
+      for (guint j = 0; j < layout_window->tabs->len; j++)
+        {
+          LayoutTab *layout_tab = g_ptr_array_index (layout_window->tabs, j);
+          PtyxisTab *tab = ptyxis_tab_new (layout_tab->profile);
+
+          if (layout_tab->argv != NULL)
+            ptyxis_tab_set_command (tab, (const char * const *)layout_tab->argv);
+
+          if (layout_tab->container != NULL)
+            ptyxis_tab_set_container (tab, layout_tab->container);
+
+          if (layout_tab->cwd_uri != NULL)
+            ptyxis_tab_set_initial_working_directory_uri (tab, layout_tab->cwd_uri);
+
+          if (!ptyxis_str_empty0 (layout_tab->title))
+            {
+              ptyxis_tab_set_title_prefix (tab, layout_tab->title);
+              ptyxis_tab_set_ignore_osc_title (tab, TRUE);
+            }
+
+          ptyxis_window_append_tab (window, tab);
+
+          if (j == 0)
+            ptyxis_window_set_active_tab (window, tab);
+
+          g_ptr_array_add (tabs, tab);
+        }
+
+      if (layout_window->maximize)
+        gtk_window_maximize (GTK_WINDOW (window));
+
+      gtk_window_present (GTK_WINDOW (window));
+    }
+
+  ptyxis_layout_spawn_tabs ((PtyxisTab * const *)tabs->pdata, tabs->len);
+
+  return TRUE;
+}
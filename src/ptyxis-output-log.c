@@ -0,0 +1,492 @@
+/*
+ * ptyxis-output-log.c
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include <errno.h>
+
+#include "ptyxis-output-log.h"
+#include "ptyxis-terminal-private.h"
+#include "ptyxis-util.h"
+
+#define CHUNK_ROWS        500
+#define FINAL_ROWS        (CHUNK_ROWS * 4)
+#define UPDATE_DELAY_MSEC 250
+#define MAX_QUEUED_BYTES  (16 * 1024 * 1024)
+#define WRITE_SIZE        (1024 * 1024)
+#define FLUSH_USEC        G_USEC_PER_SEC
+#define MAX_FILE_SIZE     (G_GUINT64_CONSTANT (64) * 1024 * 1024)
+#define MAX_FILE_AGE      (G_TIME_SPAN_HOUR * 24)
+
+/* Owned by the writer thread once started, except for @queue and
+ * @queued_bytes which are shared with the main thread. The writer
+ * thread frees it after reading the terminating empty chunk.
+ */
+typedef struct _PtyxisOutputLogWriter
+{
+  GAsyncQueue   *queue;
+  int            queued_bytes;
+  char          *directory;
+  char          *name;
+  GOutputStream *stream;
+  GByteArray    *buffer;
+  gint64         opened_at;
+  guint64        file_size;
+  guint          sequence;
+  guint          compress : 1;
+  guint          failed : 1;
+} PtyxisOutputLogWriter;
+
+struct _PtyxisOutputLog
+{
+  GObject                parent_instance;
+
+  PtyxisTerminal        *terminal;
+  PtyxisOutputLogWriter *writer;
+  GThread               *thread;
+  gint64                 next_row;
+  guint64                dropped_bytes;
+  guint64                n_dropped;
+  guint                  update_source;
+  guint                  compress : 1;
+};
+
+G_DEFINE_FINAL_TYPE (PtyxisOutputLog, ptyxis_output_log, G_TYPE_OBJECT)
+
+static void
+ptyxis_output_log_writer_free (PtyxisOutputLogWriter *writer)
+{
+  g_clear_pointer (&writer->queue, g_async_queue_unref);
+  g_clear_pointer (&writer->directory, g_free);
+  g_clear_pointer (&writer->name, g_free);
+  g_clear_pointer (&writer->buffer, g_byte_array_unref);
+  g_clear_object (&writer->stream);
+  g_free (writer);
+}
+
+static gboolean
+ptyxis_output_log_writer_open (PtyxisOutputLogWriter  *writer,
+                               GError                **error)
+{
+  g_autoptr(GFileOutputStream) stream = NULL;
+  g_autoptr(GDateTime) now = NULL;
+  g_autoptr(GFile) file = NULL;
+  g_autofree char *stamp = NULL;
+  g_autofree char *basename = NULL;
+
+  g_assert (writer != NULL);
+  g_assert (writer->stream == NULL);
+
+  if (g_mkdir_with_parents (writer->directory, 0700) != 0)
+    {
+      int errsv = errno;
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           g_io_error_from_errno (errsv),
+                           g_strerror (errsv));
+      return FALSE;
+    }
+
+  now = g_date_time_new_now_local ();
+  stamp = g_date_time_format (now, "%Y%m%d-%H%M%S");
+  basename = g_strdup_printf ("%s-%s.%u.log%s",
+                              stamp,
+                              writer->name,
+                              writer->sequence++,
+                              writer->compress ? ".gz" : "");
+  file = g_file_new_build_filename (writer->directory, basename, NULL);
+
+  if (!(stream = g_file_create (file, G_FILE_CREATE_PRIVATE, NULL, error)))
+    return FALSE;
+
+  if (writer->compress)
+    {
+      g_autoptr(GZlibCompressor) compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1);
+
+      writer->stream = g_converter_output_stream_new (G_OUTPUT_STREAM (stream),
+                                                      G_CONVERTER (compressor));
+    }
+  else
+    {
+      writer->stream = G_OUTPUT_STREAM (g_steal_pointer (&stream));
+    }
+
+  writer->opened_at = g_get_monotonic_time ();
+  writer->file_size = 0;
+
+  return TRUE;
+}
+
+static void
+ptyxis_output_log_writer_close (PtyxisOutputLogWriter *writer)
+{
+  g_autoptr(GError) error = NULL;
+
+  g_assert (writer != NULL);
+
+  if (writer->stream == NULL)
+    return;
+
+  if (!g_output_stream_close (writer->stream, NULL, &error))
+    g_warning ("Failed to close terminal log: %s", error->message);
+
+  g_clear_object (&writer->stream);
+}
+
+static void
+ptyxis_output_log_writer_flush (PtyxisOutputLogWriter *writer)
+{
+  g_autoptr(GError) error = NULL;
+
+  g_assert (writer != NULL);
+
+  if (writer->buffer->len == 0)
+    return;
+
+  if (writer->failed)
+    goto discard;
+
+  /* Rotate before writing so that a single file never grows past the
+   * limit by more than one buffer.
+   */
+  if (writer->stream != NULL &&
+      (writer->file_size >= MAX_FILE_SIZE ||
+       g_get_monotonic_time () - writer->opened_at >= MAX_FILE_AGE))
+    ptyxis_output_log_writer_close (writer);
+
+  if (writer->stream == NULL && !ptyxis_output_log_writer_open (writer, &error))
+    goto failure;
+
+  if (!g_output_stream_write_all (writer->stream,
+                                  writer->buffer->data,
+                                  writer->buffer->len,
+                                  NULL, NULL, &error))
+    goto failure;
+
+  writer->file_size += writer->buffer->len;
+
+  goto discard;
+
+failure:
+  g_warning ("Failed to write terminal log, logging disabled: %s", error->message);
+  writer->failed = TRUE;
+
+discard:
+  g_byte_array_set_size (writer->buffer, 0);
+}
+
+static gpointer
+ptyxis_output_log_writer_thread (gpointer data)
+{
+  PtyxisOutputLogWriter *writer = data;
+
+  g_assert (writer != NULL);
+
+  for (;;)
+    {
+      g_autoptr(GBytes) bytes = NULL;
+      gconstpointer buf;
+      gsize len;
+
+      /* Write whatever we have if nothing new arrives for a while */
+      if (!(bytes = g_async_queue_timeout_pop (writer->queue, FLUSH_USEC)))
+        {
+          ptyxis_output_log_writer_flush (writer);
+          continue;
+        }
+
+      buf = g_bytes_get_data (bytes, &len);
+
+      /* An empty chunk means we are shutting down */
+      if (len == 0)
+        break;
+
+      g_atomic_int_add (&writer->queued_bytes, -(int)len);
+      g_byte_array_append (writer->buffer, buf, len);
+
+      if (writer->buffer->len >= WRITE_SIZE)
+        ptyxis_output_log_writer_flush (writer);
+    }
+
+  ptyxis_output_log_writer_flush (writer);
+  ptyxis_output_log_writer_close (writer);
+  ptyxis_output_log_writer_free (writer);
+
+  return NULL;
+}
+
+static void
+ptyxis_output_log_enqueue (PtyxisOutputLog *self,
+                           char            *text,
+                           gsize            len)
+{
+  g_assert (PTYXIS_IS_OUTPUT_LOG (self));
+
+  g_atomic_int_add (&self->writer->queued_bytes, (int)len);
+  g_async_queue_push (self->writer->queue, g_bytes_new_take (text, len));
+}
+
+static void
+ptyxis_output_log_flush_dropped (PtyxisOutputLog *self)
+{
+  char *marker;
+
+  g_assert (PTYXIS_IS_OUTPUT_LOG (self));
+
+  if (self->dropped_bytes == 0)
+    return;
+
+  marker = g_strdup_printf ("\n[ptyxis: %"G_GUINT64_FORMAT" bytes of output were not logged]\n",
+                            self->dropped_bytes);
+  ptyxis_output_log_enqueue (self, marker, strlen (marker));
+  self->dropped_bytes = 0;
+}
+
+static void
+ptyxis_output_log_push (PtyxisOutputLog *self,
+                        char            *text,
+                        gsize            len)
+{
+  g_assert (PTYXIS_IS_OUTPUT_LOG (self));
+
+  if (text == NULL || len == 0)
+    {
+      g_free (text);
+      return;
+    }
+
+  /* Never wait on the disk. If the writer cannot keep up, drop the
+   * output and leave a marker in the log once there is room again.
+   */
+  if ((gsize)g_atomic_int_get (&self->writer->queued_bytes) + len > MAX_QUEUED_BYTES)
+    {
+      if (self->dropped_bytes == 0)
+        self->n_dropped++;
+      self->dropped_bytes += len;
+      g_free (text);
+      return;
+    }
+
+  ptyxis_output_log_flush_dropped (self);
+  ptyxis_output_log_enqueue (self, text, len);
+}
+
+static gboolean
+ptyxis_output_log_collect (PtyxisOutputLog *self,
+                           gint64           max_rows,
+                           gboolean         include_cursor)
+{
+  g_autoptr(GBytes) bytes = NULL;
+  gboolean has_more;
+  gint64 n_lost = 0;
+  gsize len;
+
+  g_assert (PTYXIS_IS_OUTPUT_LOG (self));
+  g_assert (self->terminal != NULL);
+
+  has_more = _ptyxis_terminal_read_rows (self->terminal,
+                                         &self->next_row,
+                                         max_rows,
+                                         include_cursor,
+                                         &n_lost,
+                                         &bytes);
+
+  if (n_lost > 0)
+    {
+      char *marker = g_strdup_printf ("\n[ptyxis: %"G_GINT64_FORMAT" lines left the scrollback before they were logged]\n",
+                                      n_lost);
+
+      self->n_dropped++;
+      ptyxis_output_log_push (self, marker, strlen (marker));
+    }
+
+  if (bytes != NULL)
+    {
+      char *text = g_bytes_unref_to_data (g_steal_pointer (&bytes), &len);
+
+      ptyxis_output_log_push (self, text, len);
+    }
+
+  return has_more;
+}
+
+static gboolean
+ptyxis_output_log_update_cb (gpointer data)
+{
+  PtyxisOutputLog *self = data;
+
+  g_assert (PTYXIS_IS_OUTPUT_LOG (self));
+
+  self->update_source = 0;
+
+  if (self->terminal == NULL)
+    return G_SOURCE_REMOVE;
+
+  /* Keep going from an idle if there is more than one chunk pending */
+  if (ptyxis_output_log_collect (self, CHUNK_ROWS, FALSE))
+    self->update_source = g_idle_add_full (G_PRIORITY_LOW,
+                                           ptyxis_output_log_update_cb,
+                                           self, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ptyxis_output_log_contents_changed_cb (PtyxisOutputLog *self,
+                                       PtyxisTerminal  *terminal)
+{
+  g_assert (PTYXIS_IS_OUTPUT_LOG (self));
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  if (self->update_source == 0)
+    self->update_source = g_timeout_add_full (G_PRIORITY_LOW,
+                                              UPDATE_DELAY_MSEC,
+                                              ptyxis_output_log_update_cb,
+                                              self, NULL);
+}
+
+static void
+ptyxis_output_log_dispose (GObject *object)
+{
+  PtyxisOutputLog *self = (PtyxisOutputLog *)object;
+
+  g_clear_handle_id (&self->update_source, g_source_remove);
+
+  /* Log what is left up to and including the cursor row before closing,
+   * but only a bounded amount since this runs on the main thread.
+   */
+  if (self->terminal != NULL && self->writer != NULL)
+    {
+      if (ptyxis_output_log_collect (self, FINAL_ROWS, TRUE))
+        {
+          static const char marker[] = "\n[ptyxis: the log was closed before all output was written]\n";
+
+          self->n_dropped++;
+          ptyxis_output_log_enqueue (self, g_strdup (marker), strlen (marker));
+        }
+    }
+
+  g_clear_weak_pointer (&self->terminal);
+
+  /* Hand the writer over to its thread so that closing a tab never
+   * waits for the disk. It frees itself once the queue is drained.
+   */
+  if (self->thread != NULL)
+    {
+      ptyxis_output_log_flush_dropped (self);
+      g_async_queue_push (self->writer->queue, g_bytes_new (NULL, 0));
+      g_clear_pointer (&self->thread, g_thread_unref);
+      self->writer = NULL;
+    }
+
+  g_clear_pointer (&self->writer, ptyxis_output_log_writer_free);
+
+  G_OBJECT_CLASS (ptyxis_output_log_parent_class)->dispose (object);
+}
+
+static void
+ptyxis_output_log_class_init (PtyxisOutputLogClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = ptyxis_output_log_dispose;
+}
+
+static void
+ptyxis_output_log_init (PtyxisOutputLog *self)
+{
+}
+
+/**
+ * ptyxis_output_log_new:
+ * @terminal: the #PtyxisTerminal to log
+ * @name: a name to include in log file names, such as the tab identifier
+ * @compress: if log files should be compressed with gzip
+ *
+ * Creates a new log which appends the output of @terminal to files in
+ * the user state directory.
+ *
+ * Rows are collected from the main loop as they are completed and then
+ * written by a dedicated thread in large batches. Files are rotated once
+ * they reach 64 MiB or are a day old. If the disk cannot keep up, output
+ * is dropped and a marker is written instead of stalling the terminal.
+ *
+ * Returns: (transfer full): a new #PtyxisOutputLog
+ */
+PtyxisOutputLog *
+ptyxis_output_log_new (PtyxisTerminal *terminal,
+                       const char     *name,
+                       gboolean        compress)
+{
+  PtyxisOutputLog *self;
+
+  g_return_val_if_fail (PTYXIS_IS_TERMINAL (terminal), NULL);
+  g_return_val_if_fail (name != NULL, NULL);
+
+  self = g_object_new (PTYXIS_TYPE_OUTPUT_LOG, NULL);
+  self->compress = !!compress;
+
+  g_set_weak_pointer (&self->terminal, terminal);
+
+  ptyxis_vte_get_row_bounds (VTE_TERMINAL (terminal), &self->next_row, NULL, NULL);
+
+  self->writer = g_new0 (PtyxisOutputLogWriter, 1);
+  self->writer->queue = g_async_queue_new_full ((GDestroyNotify)g_bytes_unref);
+  self->writer->directory = g_build_filename (g_get_user_state_dir (), "ptyxis", "logs", NULL);
+  self->writer->name = g_strdup (name);
+  self->writer->buffer = g_byte_array_sized_new (WRITE_SIZE);
+  self->writer->compress = self->compress;
+
+  self->thread = g_thread_new ("[ptyxis-output-log]",
+                               ptyxis_output_log_writer_thread,
+                               self->writer);
+
+  g_signal_connect_object (terminal,
+                           "contents-changed",
+                           G_CALLBACK (ptyxis_output_log_contents_changed_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  return self;
+}
+
+gboolean
+ptyxis_output_log_get_compress (PtyxisOutputLog *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_OUTPUT_LOG (self), FALSE);
+
+  return self->compress;
+}
+
+/**
+ * ptyxis_output_log_get_n_dropped:
+ * @self: a #PtyxisOutputLog
+ *
+ * Returns: the number of times output could not be logged, either
+ *   because the disk was too slow or it left the scrollback first
+ */
+guint64
+ptyxis_output_log_get_n_dropped (PtyxisOutputLog *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_OUTPUT_LOG (self), 0);
+
+  return self->n_dropped;
+}
@@ -0,0 +1,38 @@
+/*
+ * ptyxis-output-log.h
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "ptyxis-terminal.h"
+
+G_BEGIN_DECLS
+
+#define PTYXIS_TYPE_OUTPUT_LOG (ptyxis_output_log_get_type())
+
+G_DECLARE_FINAL_TYPE (PtyxisOutputLog, ptyxis_output_log, PTYXIS, OUTPUT_LOG, GObject)
+
+PtyxisOutputLog *ptyxis_output_log_new           (PtyxisTerminal  *terminal,
+                                                  const char      *name,
+                                                  gboolean         compress);
+gboolean         ptyxis_output_log_get_compress  (PtyxisOutputLog *self);
+guint64          ptyxis_output_log_get_n_dropped (PtyxisOutputLog *self);
+
+G_END_DECLS
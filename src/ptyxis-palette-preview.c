@@ -20,8 +20,18 @@
 
 #include "config.h"
 
+#include <math.h>
+#include <string.h>
+
 #include "ptyxis-palette-preview.h"
-#include "ptyxis-palette-preview-color.h"
+
+/* The swatches show the palette's indexed colors 1 through 6 with a
+ * small gap between each of them.
+ */
+#define FIRST_SWATCH        1
+#define N_SWATCHES          6
+#define SWATCH_SPACING      3
+#define MAX_CACHED_SWATCHES 64
 
 struct _PtyxisPalettePreview
 {
@@ -32,6 +42,7 @@ struct _PtyxisPalettePreview
 
   GtkImage *image;
   GtkLabel *label;
+  GtkWidget *swatches;
 
   guint dark : 1;
   guint selected : 1;
@@ -50,6 +61,124 @@ G_DEFINE_FINAL_TYPE (PtyxisPalettePreview, ptyxis_palette_preview, GTK_TYPE_WIDG
 
 static GParamSpec *properties [N_PROPS];
 
+/* Swatch textures are shared by every preview (and every preferences
+ * window) since many palettes are shown at the same few sizes. Only
+ * the colors and size matter so the key is built from those.
+ */
+static GHashTable *swatch_cache;
+
+static inline guint32
+pack_rgba (const GdkRGBA *rgba)
+{
+  return ((guint32)(CLAMP (rgba->red, 0, 1) * 255) << 24) |
+         ((guint32)(CLAMP (rgba->green, 0, 1) * 255) << 16) |
+         ((guint32)(CLAMP (rgba->blue, 0, 1) * 255) << 8) |
+         ((guint32)(CLAMP (rgba->alpha, 0, 1) * 255));
+}
+
+static void
+fill_rect (guint8        *data,
+           gsize          stride,
+           int            height,
+           double         x0,
+           double         x1,
+           const GdkRGBA *color)
+{
+  int first = MAX (0, floor (x0));
+  int last = MIN (ceil (x1), stride / 4);
+
+  for (int x = first; x < last; x++)
+    {
+      /* Partially covered columns at the edges are blended */
+      double alpha = CLAMP (MIN (x + 1, x1) - MAX (x, x0), 0, 1) * color->alpha;
+      guint8 pixel[4] = {
+        color->red * alpha * 255,
+        color->green * alpha * 255,
+        color->blue * alpha * 255,
+        alpha * 255,
+      };
+
+      for (int y = 0; y < height; y++)
+        memcpy (data + (y * stride) + (x * 4), pixel, sizeof pixel);
+    }
+}
+
+static GdkTexture *
+render_swatches (const PtyxisPaletteFace *face,
+                 int                      width,
+                 int                      height,
+                 int                      scale)
+{
+  g_autoptr(GBytes) bytes = NULL;
+  double swatch_width;
+  double spacing;
+  guint8 *data;
+  gsize stride;
+
+  g_assert (face != NULL);
+  g_assert (width > 0 && height > 0 && scale > 0);
+
+  width *= scale;
+  height *= scale;
+  spacing = SWATCH_SPACING * scale;
+  swatch_width = (width - spacing * (N_SWATCHES - 1)) / N_SWATCHES;
+  stride = width * 4;
+  data = g_malloc0 (stride * height);
+
+  for (guint i = 0; i < N_SWATCHES; i++)
+    {
+      double x0 = i * (swatch_width + spacing);
+
+      fill_rect (data, stride, height,
+                 x0, x0 + swatch_width,
+                 &face->indexed[FIRST_SWATCH + i]);
+    }
+
+  bytes = g_bytes_new_take (data, stride * height);
+
+  return gdk_memory_texture_new (width, height,
+                                 GDK_MEMORY_R8G8B8A8_PREMULTIPLIED,
+                                 bytes, stride);
+}
+
+static GdkTexture *
+lookup_swatches (const PtyxisPaletteFace *face,
+                 int                      width,
+                 int                      height,
+                 int                      scale)
+{
+  g_autofree char *key = NULL;
+  GdkTexture *texture;
+
+  g_assert (face != NULL);
+
+  if (swatch_cache == NULL)
+    swatch_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+
+  key = g_strdup_printf ("%08x%08x%08x%08x%08x%08x@%dx%d*%d",
+                         pack_rgba (&face->indexed[FIRST_SWATCH + 0]),
+                         pack_rgba (&face->indexed[FIRST_SWATCH + 1]),
+                         pack_rgba (&face->indexed[FIRST_SWATCH + 2]),
+                         pack_rgba (&face->indexed[FIRST_SWATCH + 3]),
+                         pack_rgba (&face->indexed[FIRST_SWATCH + 4]),
+                         pack_rgba (&face->indexed[FIRST_SWATCH + 5]),
+                         width, height, scale);
+
+  if ((texture = g_hash_table_lookup (swatch_cache, key)))
+    return texture;
+
+  /* Sizes change while the window is resized, so rather than track
+   * usage just start over once too many have accumulated.
+   */
+  if (g_hash_table_size (swatch_cache) >= MAX_CACHED_SWATCHES)
+    g_hash_table_remove_all (swatch_cache);
+
+  texture = render_swatches (face, width, height, scale);
+  g_hash_table_insert (swatch_cache, g_steal_pointer (&key), texture);
+
+  return texture;
+}
+
 static void
 ptyxis_palette_preview_update_label (PtyxisPalettePreview *self)
 {
@@ -82,6 +211,7 @@ ptyxis_palette_preview_snapshot (GtkWidget   *widget,
 {
   PtyxisPalettePreview *self = (PtyxisPalettePreview *)widget;
   const PtyxisPaletteFace *face;
+  graphene_rect_t bounds;
   int width;
   int height;
 
@@ -99,6 +229,18 @@ ptyxis_palette_preview_snapshot (GtkWidget   *widget,
                              &GRAPHENE_RECT_INIT (0, 0, width, height));
 
   GTK_WIDGET_CLASS (ptyxis_palette_preview_parent_class)->snapshot (widget, snapshot);
+
+  if (gtk_widget_compute_bounds (self->swatches, widget, &bounds) &&
+      bounds.size.width >= 1 && bounds.size.height >= 1)
+    {
+      GdkTexture *texture;
+
+      texture = lookup_swatches (face,
+                                 bounds.size.width,
+                                 bounds.size.height,
+                                 gtk_widget_get_scale_factor (widget));
+      gtk_snapshot_append_texture (snapshot, texture, &bounds);
+    }
 }
 
 static gboolean
@@ -109,12 +251,27 @@ ptyxis_palette_preview_query_tooltip (GtkWidget  *widget,
                                       GtkTooltip *tooltip)
 {
   PtyxisPalettePreview *self = (PtyxisPalettePreview *)widget;
+  graphene_rect_t bounds;
 
   g_assert (PTYXIS_IS_PALETTE_PREVIEW (self));
 
   if (self->palette == NULL)
     return FALSE;
 
+  /* Show the color value when hovering one of the swatches */
+  if (gtk_widget_compute_bounds (self->swatches, widget, &bounds) &&
+      graphene_rect_contains_point (&bounds, &GRAPHENE_POINT_INIT (x, y)))
+    {
+      const PtyxisPaletteFace *face = ptyxis_palette_get_face (self->palette, self->dark);
+      double step = (bounds.size.width + SWATCH_SPACING) / N_SWATCHES;
+      guint index = MIN ((x - bounds.origin.x) / step, N_SWATCHES - 1);
+      g_autofree char *str = gdk_rgba_to_string (&face->indexed[FIRST_SWATCH + index]);
+
+      gtk_tooltip_set_text (tooltip, str);
+
+      return TRUE;
+    }
+
   gtk_tooltip_set_text (tooltip, ptyxis_palette_get_name (self->palette));
 
   return TRUE;
@@ -267,9 +424,9 @@ ptyxis_palette_preview_class_init (PtyxisPalettePreviewClass *klass)
   gtk_widget_class_set_template_from_resource (widget_class, "/org/gnome/Ptyxis/ptyxis-palette-preview.ui");
   gtk_widget_class_bind_template_child (widget_class, PtyxisPalettePreview, image);
   gtk_widget_class_bind_template_child (widget_class, PtyxisPalettePreview, label);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisPalettePreview, swatches);
 
   g_type_ensure (PTYXIS_TYPE_PALETTE);
-  g_type_ensure (PTYXIS_TYPE_PALETTE_PREVIEW_COLOR);
 }
 
 static void
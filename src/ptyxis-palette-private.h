@@ -0,0 +1,67 @@
+/*
+ * ptyxis-palette-private.h
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "ptyxis-palette.h"
+
+G_BEGIN_DECLS
+
+/* Optional colors which are derived from the others when missing */
+typedef enum _PtyxisPaletteKey
+{
+  PTYXIS_PALETTE_KEY_TITLEBAR_FOREGROUND  = 1 << 0,
+  PTYXIS_PALETTE_KEY_TITLEBAR_BACKGROUND  = 1 << 1,
+  PTYXIS_PALETTE_KEY_BELL_FOREGROUND      = 1 << 2,
+  PTYXIS_PALETTE_KEY_BELL_BACKGROUND      = 1 << 3,
+  PTYXIS_PALETTE_KEY_SUPERUSER_FOREGROUND = 1 << 4,
+  PTYXIS_PALETTE_KEY_SUPERUSER_BACKGROUND = 1 << 5,
+  PTYXIS_PALETTE_KEY_REMOTE_FOREGROUND    = 1 << 6,
+  PTYXIS_PALETTE_KEY_REMOTE_BACKGROUND    = 1 << 7,
+} PtyxisPaletteKey;
+
+typedef struct _PtyxisPaletteData
+{
+  const char        *id;
+  const char        *name;
+  PtyxisPaletteFace  faces[2];
+} PtyxisPaletteData;
+
+/* Built-in palettes compiled from src/palettes/ by compile_palettes.py.
+ * Derived colors are not included, see @present for which were set.
+ */
+typedef struct _PtyxisPaletteTableEntry
+{
+  PtyxisPaletteData data;
+  PtyxisPaletteKey  present[2];
+  guint             is_primary : 1;
+  guint             use_system_accent : 1;
+  guint             has_dark : 1;
+  guint             has_light : 1;
+} PtyxisPaletteTableEntry;
+
+/* Sorted by name */
+extern const PtyxisPaletteTableEntry ptyxis_palette_table[];
+extern const guint                   ptyxis_palette_table_len;
+/* Indexes into ptyxis_palette_table sorted by id */
+extern const guint16                 ptyxis_palette_table_by_id[];
+
+G_END_DECLS
@@ -22,23 +22,17 @@
 #include "config.h"
 
 #include <math.h>
+#include <stdlib.h>
 
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 
 #include "gdkhslaprivate.h"
 
-#include "ptyxis-palette.h"
+#include "ptyxis-palette-private.h"
 #include "ptyxis-preferences-list-item.h"
 #include "ptyxis-user-palettes.h"
 
-typedef struct _PtyxisPaletteData
-{
-  const char        *id;
-  const char        *name;
-  PtyxisPaletteFace  faces[2];
-} PtyxisPaletteData;
-
 struct _PtyxisPalette
 {
   GObject parent_instance;
@@ -60,6 +54,12 @@ enum {
 
 static GParamSpec *properties[N_PROPS];
 
+/* Built-in palettes are only materialized when first requested */
+static PtyxisPalette **builtin_palettes;
+static PtyxisUserPalettes *user_palettes;
+
+static PtyxisPalette *ptyxis_palette_get_builtin (guint position);
+
 static void
 ptyxis_palette_finalize (GObject *object)
 {
@@ -111,21 +111,72 @@ ptyxis_palette_init (PtyxisPalette *self)
 {
 }
 
+static PtyxisUserPalettes *
+ptyxis_palette_get_user_palettes (void)
+{
+  if (user_palettes == NULL)
+    {
+      g_autofree char *user_palettes_dir = g_build_filename (g_get_user_data_dir (), APP_ID, "palettes", NULL);
+
+      user_palettes = ptyxis_user_palettes_new (user_palettes_dir);
+    }
+
+  return user_palettes;
+}
+
+static int
+compare_by_id (gconstpointer keyptr,
+               gconstpointer elemptr)
+{
+  const char *key = keyptr;
+  const guint16 *elem = elemptr;
+
+  return strcmp (key, ptyxis_palette_table[*elem].data.id);
+}
+
 PtyxisPalette *
 ptyxis_palette_lookup (const char *id)
 {
-  GListModel *model = ptyxis_palette_get_all ();
-  guint n_items = g_list_model_get_n_items (model);
+  g_autofree char *filename = NULL;
+  g_autofree char *path = NULL;
+  const guint16 *position;
+  PtyxisUserPalettes *user;
+  guint n_items;
+
+  if (id == NULL)
+    return NULL;
+
+  if ((position = bsearch (id,
+                           ptyxis_palette_table_by_id,
+                           ptyxis_palette_table_len,
+                           sizeof *ptyxis_palette_table_by_id,
+                           compare_by_id)))
+    return g_object_ref (ptyxis_palette_get_builtin (*position));
+
+  user = ptyxis_palette_get_user_palettes ();
+  n_items = user ? g_list_model_get_n_items (G_LIST_MODEL (user)) : 0;
 
   for (guint i = 0; i < n_items; i++)
     {
-      g_autoptr(PtyxisPalette) palette = g_list_model_get_item (model, i);
+      g_autoptr(PtyxisPalette) palette = g_list_model_get_item (G_LIST_MODEL (user), i);
 
       if (g_strcmp0 (id, ptyxis_palette_get_id (palette)) == 0)
         return g_steal_pointer (&palette);
     }
 
-  return NULL;
+  /* User palettes may not have been scanned yet, so try to load just
+   * the one we need rather than waiting for the whole directory.
+   */
+  if (strchr (id, G_DIR_SEPARATOR) != NULL)
+    return NULL;
+
+  filename = g_strdup_printf ("%s.palette", id);
+  path = g_build_filename (g_get_user_data_dir (), APP_ID, "palettes", filename, NULL);
+
+  if (user != NULL)
+    return ptyxis_user_palettes_load_path (user, path);
+
+  return ptyxis_palette_new_from_file (path, NULL);
 }
 
 const char *
@@ -160,27 +211,22 @@ ptyxis_palette_get_all (void)
 
   if (instance == NULL)
     {
-      g_auto(GStrv) resources = g_resources_enumerate_children ("/org/gnome/Ptyxis/palettes/", 0, NULL);
-      g_autofree char *user_palettes_dir = g_build_filename (g_get_user_data_dir (), APP_ID, "palettes", NULL);
-      g_autoptr(PtyxisUserPalettes) user_palettes = ptyxis_user_palettes_new (user_palettes_dir);
+      PtyxisUserPalettes *user = ptyxis_palette_get_user_palettes ();
       GListStore *builtin = g_list_store_new (PTYXIS_TYPE_PALETTE);
       GListStore *models = g_list_store_new (G_TYPE_LIST_MODEL);
-      GtkFlattenListModel *flatten = gtk_flatten_list_model_new (G_LIST_MODEL (models));
-
-      g_list_store_append (models, builtin);
-      g_list_store_append (models, user_palettes);
+      GtkFlattenListModel *flatten;
 
-      for (guint i = 0; resources[i]; i++)
-        {
-          g_autoptr(GError) error = NULL;
-          g_autofree char *path = g_strdup_printf ("/org/gnome/Ptyxis/palettes/%s", resources[i]);
-          g_autoptr(PtyxisPalette) palette = ptyxis_palette_new_from_resource (path, &error);
+      for (guint i = 0; i < ptyxis_palette_table_len; i++)
+        g_list_store_append (builtin, ptyxis_palette_get_builtin (i));
 
-          g_assert_no_error (error);
+      g_list_store_append (models, builtin);
+      g_object_unref (builtin);
 
-          g_list_store_append (builtin, palette);
-        }
+      if (user != NULL)
+        g_list_store_append (models, user);
 
+      /* Built-in and user palettes are shown interleaved by name */
+      flatten = gtk_flatten_list_model_new (G_LIST_MODEL (models));
       instance = gtk_sort_list_model_new (G_LIST_MODEL (flatten),
                                           GTK_SORTER (gtk_string_sorter_new (gtk_property_expression_new (PTYXIS_TYPE_PALETTE, NULL, "name"))));
       g_object_add_weak_pointer (G_OBJECT (instance), (gpointer *)&instance);
@@ -281,6 +327,33 @@ mix (const GdkRGBA *fg,
   return dest;
 }
 
+static void
+ptyxis_palette_face_apply_defaults (PtyxisPaletteFace *face,
+                                    PtyxisPaletteKey   present)
+{
+  gboolean dark = is_dark (&face->background);
+
+  if (!(present & PTYXIS_PALETTE_KEY_TITLEBAR_FOREGROUND))
+    face->titlebar_foreground = _gdk_rgba_shade (&face->foreground, dark ? 1.25 : .95);
+  if (!(present & PTYXIS_PALETTE_KEY_TITLEBAR_BACKGROUND))
+    face->titlebar_background = dark ? _gdk_rgba_shade (&face->background, 1.25) : face->background;
+
+  if (!(present & PTYXIS_PALETTE_KEY_BELL_FOREGROUND))
+    face->visual_bell.foreground = face->titlebar_foreground;
+  if (!(present & PTYXIS_PALETTE_KEY_BELL_BACKGROUND))
+    face->visual_bell.background = mix (&face->indexed[11], &face->titlebar_background, .25);
+
+  if (!(present & PTYXIS_PALETTE_KEY_SUPERUSER_FOREGROUND))
+    face->superuser.foreground = _gdk_rgba_shade (&face->titlebar_foreground, dark ? 1 : .8);
+  if (!(present & PTYXIS_PALETTE_KEY_SUPERUSER_BACKGROUND))
+    face->superuser.background = mix (&face->indexed[1], &face->background, dark ? .33 : .5);
+
+  if (!(present & PTYXIS_PALETTE_KEY_REMOTE_FOREGROUND))
+    face->remote.foreground = _gdk_rgba_shade (&face->titlebar_foreground, dark ? 1 : .8);
+  if (!(present & PTYXIS_PALETTE_KEY_REMOTE_BACKGROUND))
+    face->remote.background = mix (&face->indexed[12], &face->background, dark ? .33 : .5);
+}
+
 static gboolean
 ptyxis_palette_load_face (const char         *path,
                           PtyxisPaletteFace  *face,
@@ -288,7 +361,21 @@ ptyxis_palette_load_face (const char         *path,
                           const char         *scheme,
                           GError            **error)
 {
-  gboolean dark;
+  static const struct {
+    const char       *key;
+    PtyxisPaletteKey  flag;
+    gsize             offset;
+  } optional[] = {
+    { "TitlebarForeground", PTYXIS_PALETTE_KEY_TITLEBAR_FOREGROUND, G_STRUCT_OFFSET (PtyxisPaletteFace, titlebar_foreground) },
+    { "TitlebarBackground", PTYXIS_PALETTE_KEY_TITLEBAR_BACKGROUND, G_STRUCT_OFFSET (PtyxisPaletteFace, titlebar_background) },
+    { "BellForeground", PTYXIS_PALETTE_KEY_BELL_FOREGROUND, G_STRUCT_OFFSET (PtyxisPaletteFace, visual_bell.foreground) },
+    { "BellBackground", PTYXIS_PALETTE_KEY_BELL_BACKGROUND, G_STRUCT_OFFSET (PtyxisPaletteFace, visual_bell.background) },
+    { "SuperuserForeground", PTYXIS_PALETTE_KEY_SUPERUSER_FOREGROUND, G_STRUCT_OFFSET (PtyxisPaletteFace, superuser.foreground) },
+    { "SuperuserBackground", PTYXIS_PALETTE_KEY_SUPERUSER_BACKGROUND, G_STRUCT_OFFSET (PtyxisPaletteFace, superuser.background) },
+    { "RemoteForeground", PTYXIS_PALETTE_KEY_REMOTE_FOREGROUND, G_STRUCT_OFFSET (PtyxisPaletteFace, remote.foreground) },
+    { "RemoteBackground", PTYXIS_PALETTE_KEY_REMOTE_BACKGROUND, G_STRUCT_OFFSET (PtyxisPaletteFace, remote.background) },
+  };
+  PtyxisPaletteKey present = 0;
 
   if (!g_key_file_has_group (key_file, scheme))
     {
@@ -326,27 +413,15 @@ ptyxis_palette_load_face (const char         *path,
       !ptyxis_palette_load_color (path, &face->indexed[15], key_file, scheme, "Color15", error))
     return FALSE;
 
-  dark = is_dark (&face->background);
-
-  if (!ptyxis_palette_load_color (path, &face->titlebar_foreground, key_file, scheme, "TitlebarForeground", NULL))
-    face->titlebar_foreground = _gdk_rgba_shade (&face->foreground, dark ? 1.25 : .95);
-  if (!ptyxis_palette_load_color (path, &face->titlebar_background, key_file, scheme, "TitlebarBackground", NULL))
-    face->titlebar_background = dark ? _gdk_rgba_shade (&face->background, 1.25) : face->background;
-
-  if (!ptyxis_palette_load_color (path, &face->visual_bell.foreground, key_file, scheme, "BellForeground", NULL))
-    face->visual_bell.foreground = face->titlebar_foreground;
-  if (!ptyxis_palette_load_color (path, &face->visual_bell.background, key_file, scheme, "BellBackground", NULL))
-    face->visual_bell.background = mix (&face->indexed[11], &face->titlebar_background, .25);
+  for (guint i = 0; i < G_N_ELEMENTS (optional); i++)
+    {
+      GdkRGBA *color = G_STRUCT_MEMBER_P (face, optional[i].offset);
 
-  if (!ptyxis_palette_load_color (path, &face->superuser.foreground, key_file, scheme, "SuperuserForeground", NULL))
-    face->superuser.foreground = _gdk_rgba_shade (&face->titlebar_foreground, dark ? 1 : .8);
-  if (!ptyxis_palette_load_color (path, &face->superuser.background, key_file, scheme, "SuperuserBackground", NULL))
-    face->superuser.background = mix (&face->indexed[1], &face->background, dark ? .33 : .5);
+      if (ptyxis_palette_load_color (path, color, key_file, scheme, optional[i].key, NULL))
+        present |= optional[i].flag;
+    }
 
-  if (!ptyxis_palette_load_color (path, &face->remote.foreground, key_file, scheme, "RemoteForeground", NULL))
-    face->remote.foreground = _gdk_rgba_shade (&face->titlebar_foreground, dark ? 1 : .8);
-  if (!ptyxis_palette_load_color (path, &face->remote.background, key_file, scheme, "RemoteBackground", NULL))
-    face->remote.background = mix (&face->indexed[12], &face->background, dark ? .33 : .5);
+  ptyxis_palette_face_apply_defaults (face, present);
 
   return TRUE;
 }
@@ -455,59 +530,34 @@ ptyxis_palette_new_from_file (const char  *path,
   return self;
 }
 
-PtyxisPalette *
-ptyxis_palette_new_from_resource (const char  *path,
-                                  GError     **error)
+static PtyxisPalette *
+ptyxis_palette_get_builtin (guint position)
 {
-  g_autoptr(GKeyFile) key_file = NULL;
-  g_autoptr(GBytes) bytes = NULL;
-  PtyxisPaletteData data;
+  const PtyxisPaletteTableEntry *entry;
   PtyxisPalette *self;
-  gboolean has_light;
-  gboolean has_dark;
-
-  g_return_val_if_fail (path != NULL, NULL);
-
-  if (!(bytes = g_resources_lookup_data (path, 0, error)))
-    return NULL;
-
-  key_file = g_key_file_new ();
-
-  if (!g_key_file_load_from_bytes (key_file, bytes, 0, error))
-    return NULL;
-
-  memset (&data, 0, sizeof data);
 
-  if (!ptyxis_palette_load_info (path, &data, key_file, error))
-    return NULL;
+  g_assert (position < ptyxis_palette_table_len);
 
-  has_light = g_key_file_has_group (key_file, "Light");
-  has_dark = g_key_file_has_group (key_file, "Dark");
+  if (builtin_palettes == NULL)
+    builtin_palettes = g_new0 (PtyxisPalette *, ptyxis_palette_table_len);
 
-  if (!has_light && !has_dark)
-    {
-      if (!ptyxis_palette_load_face (path, &data.faces[0], key_file, "Palette", error))
-        return NULL;
-      data.faces[1] = data.faces[0];
-      has_dark = is_dark (&data.faces[0].background);
-      has_light = !has_dark;
-    }
-  else
-    {
-      if (!ptyxis_palette_load_face (path, &data.faces[0], key_file, "Light", error))
-        return NULL;
+  if (builtin_palettes[position] != NULL)
+    return builtin_palettes[position];
 
-      if (!ptyxis_palette_load_face (path, &data.faces[1], key_file, "Dark", error))
-        return NULL;
-    }
+  entry = &ptyxis_palette_table[position];
 
   self = g_object_new (PTYXIS_TYPE_PALETTE, NULL);
-  self->allocated = g_memdup2 (&data, sizeof data);
+  self->allocated = g_memdup2 (&entry->data, sizeof entry->data);
   self->palette = self->allocated;
-  self->is_primary = g_key_file_get_boolean (key_file, "Palette", "Primary", NULL);
-  self->use_system_accent = g_key_file_get_boolean (key_file, "Palette", "UseSystemAccent", NULL);
-  self->has_dark = has_dark;
-  self->has_light = has_light;
+  self->is_primary = entry->is_primary;
+  self->use_system_accent = entry->use_system_accent;
+  self->has_dark = entry->has_dark;
+  self->has_light = entry->has_light;
+
+  for (guint i = 0; i < G_N_ELEMENTS (entry->present); i++)
+    ptyxis_palette_face_apply_defaults (&self->allocated->faces[i], entry->present[i]);
+
+  builtin_palettes[position] = self;
 
   return self;
 }
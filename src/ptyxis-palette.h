@@ -64,8 +64,6 @@ GListModel              *ptyxis_palette_list_model_get_default (void);
 PtyxisPalette           *ptyxis_palette_lookup                 (const char     *name);
 PtyxisPalette           *ptyxis_palette_new_from_file          (const char     *file,
                                                                 GError        **error);
-PtyxisPalette           *ptyxis_palette_new_from_resource      (const char     *file,
-                                                                GError        **error);
 const char              *ptyxis_palette_get_id                 (PtyxisPalette  *self);
 const char              *ptyxis_palette_get_name               (PtyxisPalette  *self);
 const PtyxisPaletteFace *ptyxis_palette_get_face               (PtyxisPalette  *self,
@@ -21,9 +21,17 @@
 
 #include "config.h"
 
+#include "ptyxis-application.h"
 #include "ptyxis-parking-lot.h"
+#include "ptyxis-util.h"
 
 #define DEFAULT_TIMEOUT_SECONDS 5
+#define DEFAULT_HISTORY_SIZE    (4 * 1024 * 1024)
+
+/* Only the most recent rows are kept for closed tabs so that capturing
+ * a tab with a huge scrollback does not stall the main loop.
+ */
+#define MAX_HISTORY_ROWS        2000
 
 typedef struct _PtyxisParkedTab
 {
@@ -33,15 +41,37 @@ typedef struct _PtyxisParkedTab
   guint             source_id;
 } PtyxisParkedTab;
 
+/* Once a parked tab expires we no longer keep the process or widgets
+ * around, but we do keep enough information to recreate something that
+ * looks like the tab (with its scrollback compressed) so that undo-close
+ * can work for more than a few seconds.
+ */
+typedef struct _PtyxisParkedRecord
+{
+  GList   link;
+  char   *profile_uuid;
+  char   *container_id;
+  char   *cwd_uri;
+  char   *title;
+  GBytes *history;
+  gsize   size;
+  guint   columns;
+  guint   rows;
+} PtyxisParkedRecord;
+
 struct _PtyxisParkingLot
 {
   GObject parent_instance;
   GQueue  tabs;
+  GQueue  records;
+  gsize   records_size;
+  guint   history_size;
   guint   timeout;
 };
 
 enum {
   PROP_0,
+  PROP_HISTORY_SIZE,
   PROP_TIMEOUT,
   N_PROPS
 };
@@ -50,6 +80,167 @@ G_DEFINE_FINAL_TYPE (PtyxisParkingLot, ptyxis_parking_lot, G_TYPE_OBJECT)
 
 static GParamSpec *properties [N_PROPS];
 
+static void
+ptyxis_parked_record_free (PtyxisParkedRecord *record)
+{
+  g_clear_pointer (&record->profile_uuid, g_free);
+  g_clear_pointer (&record->container_id, g_free);
+  g_clear_pointer (&record->cwd_uri, g_free);
+  g_clear_pointer (&record->title, g_free);
+  g_clear_pointer (&record->history, g_bytes_unref);
+  g_free (record);
+}
+
+static void
+ptyxis_parking_lot_trim_records (PtyxisParkingLot *self)
+{
+  g_assert (PTYXIS_IS_PARKING_LOT (self));
+
+  while (self->records_size > self->history_size &&
+         self->records.head != NULL)
+    {
+      PtyxisParkedRecord *record = self->records.head->data;
+
+      g_queue_unlink (&self->records, &record->link);
+      self->records_size -= record->size;
+      ptyxis_parked_record_free (record);
+    }
+}
+
+static GBytes *
+ptyxis_parking_lot_capture_history (VteTerminal *terminal)
+{
+  g_autoptr(GZlibCompressor) compressor = NULL;
+  g_autoptr(GOutputStream) memory = NULL;
+  g_autoptr(GOutputStream) stream = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *text = NULL;
+  gint64 first_row;
+  gint64 end_row;
+  gsize len = 0;
+
+  g_assert (VTE_IS_TERMINAL (terminal));
+
+  ptyxis_vte_get_row_bounds (terminal, &first_row, NULL, &end_row);
+  first_row = MAX (first_row, end_row - MAX_HISTORY_ROWS);
+
+  if (end_row <= first_row)
+    return NULL;
+
+  text = vte_terminal_get_text_range_format (terminal,
+                                             VTE_FORMAT_TEXT,
+                                             first_row, 0,
+                                             end_row - 1,
+                                             vte_terminal_get_column_count (terminal),
+                                             &len);
+
+  if (text == NULL || len == 0)
+    return NULL;
+
+  compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW, -1);
+  memory = g_memory_output_stream_new_resizable ();
+  stream = g_converter_output_stream_new (memory, G_CONVERTER (compressor));
+
+  if (!g_output_stream_write_all (stream, text, len, NULL, NULL, &error) ||
+      !g_output_stream_close (stream, NULL, &error))
+    {
+      g_debug ("Failed to capture tab history: %s", error->message);
+      return NULL;
+    }
+
+  return g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (memory));
+}
+
+static GBytes *
+ptyxis_parking_lot_inflate_history (GBytes *history)
+{
+  g_autoptr(GZlibDecompressor) decompressor = NULL;
+  g_autoptr(GOutputStream) memory = NULL;
+  g_autoptr(GOutputStream) stream = NULL;
+  g_autoptr(GError) error = NULL;
+
+  g_assert (history != NULL);
+
+  decompressor = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW);
+  memory = g_memory_output_stream_new_resizable ();
+  stream = g_converter_output_stream_new (memory, G_CONVERTER (decompressor));
+
+  if (!g_output_stream_write_all (stream,
+                                  g_bytes_get_data (history, NULL),
+                                  g_bytes_get_size (history),
+                                  NULL, NULL, &error) ||
+      !g_output_stream_close (stream, NULL, &error))
+    {
+      g_debug ("Failed to inflate tab history: %s", error->message);
+      return NULL;
+    }
+
+  return g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (memory));
+}
+
+static void
+ptyxis_parking_lot_capture (PtyxisParkingLot *self,
+                            PtyxisTab        *tab)
+{
+  g_autoptr(PtyxisIpcContainer) container = NULL;
+  PtyxisParkedRecord *record;
+  PtyxisTerminal *terminal;
+  const char *window_title;
+
+  g_assert (PTYXIS_IS_PARKING_LOT (self));
+  g_assert (PTYXIS_IS_TAB (tab));
+
+  if (self->history_size == 0)
+    return;
+
+  terminal = ptyxis_tab_get_terminal (tab);
+  container = ptyxis_tab_dup_container (tab);
+
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+  window_title = vte_terminal_get_window_title (VTE_TERMINAL (terminal));
+  G_GNUC_END_IGNORE_DEPRECATIONS
+
+  record = g_new0 (PtyxisParkedRecord, 1);
+  record->link.data = record;
+  record->profile_uuid = g_strdup (ptyxis_profile_get_uuid (ptyxis_tab_get_profile (tab)));
+  record->cwd_uri = ptyxis_tab_dup_current_directory_uri (tab);
+  record->title = g_strdup (window_title);
+  record->history = ptyxis_parking_lot_capture_history (VTE_TERMINAL (terminal));
+  record->columns = vte_terminal_get_column_count (VTE_TERMINAL (terminal));
+  record->rows = vte_terminal_get_row_count (VTE_TERMINAL (terminal));
+
+  if (container != NULL)
+    record->container_id = g_strdup (ptyxis_ipc_container_get_id (container));
+
+  record->size = sizeof *record;
+  if (record->profile_uuid != NULL)
+    record->size += strlen (record->profile_uuid);
+  if (record->container_id != NULL)
+    record->size += strlen (record->container_id);
+  if (record->cwd_uri != NULL)
+    record->size += strlen (record->cwd_uri);
+  if (record->title != NULL)
+    record->size += strlen (record->title);
+  if (record->history != NULL)
+    record->size += g_bytes_get_size (record->history);
+
+  if (record->size > self->history_size)
+    {
+      g_debug ("Dropping tab record of %"G_GSIZE_FORMAT" bytes, exceeds history size",
+               record->size);
+      ptyxis_parked_record_free (record);
+      return;
+    }
+
+  g_debug ("Recording closed tab \"%s\" in %"G_GSIZE_FORMAT" bytes",
+           record->title ? record->title : "", record->size);
+
+  g_queue_push_tail_link (&self->records, &record->link);
+  self->records_size += record->size;
+
+  ptyxis_parking_lot_trim_records (self);
+}
+
 static void
 ptyxis_parking_lot_remove (PtyxisParkingLot *self,
                            PtyxisParkedTab  *parked,
@@ -85,6 +276,16 @@ ptyxis_parking_lot_dispose (GObject *object)
   while (self->tabs.head != NULL)
     ptyxis_parking_lot_remove (self, self->tabs.head->data, TRUE);
 
+  while (self->records.head != NULL)
+    {
+      PtyxisParkedRecord *record = self->records.head->data;
+
+      g_queue_unlink (&self->records, &record->link);
+      ptyxis_parked_record_free (record);
+    }
+
+  self->records_size = 0;
+
   G_OBJECT_CLASS (ptyxis_parking_lot_parent_class)->dispose (object);
 }
 
@@ -98,6 +299,10 @@ ptyxis_parking_lot_get_property (GObject    *object,
 
   switch (prop_id)
     {
+    case PROP_HISTORY_SIZE:
+      g_value_set_uint (value, self->history_size);
+      break;
+
     case PROP_TIMEOUT:
       g_value_set_uint (value, self->timeout);
       break;
@@ -117,6 +322,10 @@ ptyxis_parking_lot_set_property (GObject      *object,
 
   switch (prop_id)
     {
+    case PROP_HISTORY_SIZE:
+      ptyxis_parking_lot_set_history_size (self, g_value_get_uint (value));
+      break;
+
     case PROP_TIMEOUT:
       ptyxis_parking_lot_set_timeout (self, g_value_get_uint (value));
       break;
@@ -135,6 +344,13 @@ ptyxis_parking_lot_class_init (PtyxisParkingLotClass *klass)
   object_class->get_property = ptyxis_parking_lot_get_property;
   object_class->set_property = ptyxis_parking_lot_set_property;
 
+  properties[PROP_HISTORY_SIZE] =
+    g_param_spec_uint ("history-size", NULL, NULL,
+                       0, G_MAXUINT, DEFAULT_HISTORY_SIZE,
+                       (G_PARAM_READWRITE |
+                        G_PARAM_EXPLICIT_NOTIFY |
+                        G_PARAM_STATIC_STRINGS));
+
   properties[PROP_TIMEOUT] =
     g_param_spec_uint ("timeout", NULL, NULL,
                        0, G_MAXUINT, DEFAULT_TIMEOUT_SECONDS,
@@ -149,6 +365,7 @@ static void
 ptyxis_parking_lot_init (PtyxisParkingLot *self)
 {
   self->timeout = DEFAULT_TIMEOUT_SECONDS;
+  self->history_size = DEFAULT_HISTORY_SIZE;
 }
 
 PtyxisParkingLot *
@@ -178,6 +395,37 @@ ptyxis_parking_lot_set_timeout (PtyxisParkingLot *self,
     }
 }
 
+/**
+ * ptyxis_parking_lot_get_history_size:
+ * @self: a #PtyxisParkingLot
+ *
+ * Gets the number of bytes that may be used to keep records of tabs
+ * which have expired from the parking lot.
+ *
+ * Returns: the size in bytes
+ */
+guint
+ptyxis_parking_lot_get_history_size (PtyxisParkingLot *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_PARKING_LOT (self), 0);
+
+  return self->history_size;
+}
+
+void
+ptyxis_parking_lot_set_history_size (PtyxisParkingLot *self,
+                                     guint             history_size)
+{
+  g_return_if_fail (PTYXIS_IS_PARKING_LOT (self));
+
+  if (history_size != self->history_size)
+    {
+      self->history_size = history_size;
+      ptyxis_parking_lot_trim_records (self);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_HISTORY_SIZE]);
+    }
+}
+
 static gboolean
 ptyxis_parking_lot_source_func (gpointer data)
 {
@@ -188,6 +436,7 @@ ptyxis_parking_lot_source_func (gpointer data)
   g_assert (PTYXIS_IS_TAB (parked->tab));
   g_assert (parked->source_id != 0);
 
+  ptyxis_parking_lot_capture (parked->lot, parked->tab);
   ptyxis_parking_lot_remove (parked->lot, parked, TRUE);
 
   return G_SOURCE_REMOVE;
@@ -206,6 +455,9 @@ ptyxis_parking_lot_push (PtyxisParkingLot *self,
   title = ptyxis_tab_dup_title (tab);
   g_debug ("Adding tab \"%s\" to parking lot", title);
 
+  /* Closed tabs must stop receiving input broadcast to their group */
+  ptyxis_tab_set_broadcast_group (tab, 0);
+
   parked = g_new0 (PtyxisParkedTab, 1);
   parked->link.data = parked;
   parked->tab = g_object_ref (tab);
@@ -235,7 +487,7 @@ ptyxis_parking_lot_pop (PtyxisParkingLot *self)
   g_debug ("Request to pop tab from parking lot of %u tabs",
            self->tabs.length);
 
-  if ((parked = g_queue_peek_head (&self->tabs)))
+  if ((parked = g_queue_peek_tail (&self->tabs)))
     {
       ret = g_steal_pointer (&parked->tab);
       ptyxis_parking_lot_remove (self, parked, FALSE);
@@ -243,3 +495,102 @@ ptyxis_parking_lot_pop (PtyxisParkingLot *self)
 
   return ret;
 }
+
+static void
+ptyxis_parking_lot_feed_history (VteTerminal *terminal,
+                                 GBytes      *history)
+{
+  g_autoptr(GBytes) inflated = NULL;
+  const char *data;
+  const char *end;
+  gsize len;
+
+  g_assert (VTE_IS_TERMINAL (terminal));
+  g_assert (history != NULL);
+
+  if (!(inflated = ptyxis_parking_lot_inflate_history (history)))
+    return;
+
+  data = g_bytes_get_data (inflated, &len);
+
+  /* Skip the empty rows that trail the last prompt */
+  while (len > 0 && g_ascii_isspace (data[len - 1]))
+    len--;
+
+  end = data + len;
+
+  while (data < end)
+    {
+      const char *eol = memchr (data, '\n', end - data);
+
+      if (eol == NULL)
+        eol = end;
+
+      vte_terminal_feed (terminal, data, eol - data);
+      vte_terminal_feed (terminal, "\r\n", 2);
+
+      data = eol + 1;
+    }
+}
+
+/**
+ * ptyxis_parking_lot_restore:
+ * @self: a #PtyxisParkingLot
+ *
+ * Recreates the most recently closed tab which has expired from the
+ * parking lot. The tab will have the previous history shown and spawn
+ * a new shell in the same directory and container once mapped.
+ *
+ * Returns: (transfer full) (nullable): a #PtyxisTab or %NULL
+ */
+PtyxisTab *
+ptyxis_parking_lot_restore (PtyxisParkingLot *self)
+{
+  g_autoptr(PtyxisIpcContainer) container = NULL;
+  g_autoptr(PtyxisProfile) profile = NULL;
+  PtyxisParkedRecord *record;
+  PtyxisApplication *app;
+  PtyxisTerminal *terminal;
+  PtyxisTab *tab;
+
+  g_return_val_if_fail (PTYXIS_IS_PARKING_LOT (self), NULL);
+
+  if (!(record = g_queue_peek_tail (&self->records)))
+    return NULL;
+
+  g_queue_unlink (&self->records, &record->link);
+  self->records_size -= record->size;
+
+  app = PTYXIS_APPLICATION_DEFAULT;
+
+  if (record->profile_uuid != NULL)
+    profile = ptyxis_application_dup_profile (app, record->profile_uuid);
+
+  if (profile == NULL)
+    profile = ptyxis_application_dup_default_profile (app);
+
+  if (!ptyxis_str_empty0 (record->container_id))
+    container = ptyxis_application_lookup_container (app, record->container_id);
+
+  tab = ptyxis_tab_new (profile);
+  terminal = ptyxis_tab_get_terminal (tab);
+
+  if (container != NULL)
+    ptyxis_tab_set_container (tab, container);
+
+  if (!ptyxis_str_empty0 (record->cwd_uri))
+    ptyxis_tab_set_initial_working_directory_uri (tab, record->cwd_uri);
+
+  if (!ptyxis_str_empty0 (record->title))
+    ptyxis_tab_set_initial_title (tab, record->title);
+
+  if (record->columns > 0 && record->rows > 0)
+    vte_terminal_set_size (VTE_TERMINAL (terminal), record->columns, record->rows);
+
+  if (record->history != NULL)
+    ptyxis_parking_lot_feed_history (VTE_TERMINAL (terminal), record->history);
+
+  ptyxis_parked_record_free (record);
+
+  return g_object_ref_sink (tab);
+}
@@ -29,12 +29,16 @@ G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (PtyxisParkingLot, ptyxis_parking_lot, PTYXIS, PARKING_LOT, GObject)
 
-PtyxisParkingLot *ptyxis_parking_lot_new         (void);
-guint             ptyxis_parking_lot_get_timeout (PtyxisParkingLot *self);
-void              ptyxis_parking_lot_set_timeout (PtyxisParkingLot *self,
-                                                  guint             timeout);
-void              ptyxis_parking_lot_push        (PtyxisParkingLot *self,
-                                                  PtyxisTab        *tab);
-PtyxisTab        *ptyxis_parking_lot_pop         (PtyxisParkingLot *self);
+PtyxisParkingLot *ptyxis_parking_lot_new              (void);
+guint             ptyxis_parking_lot_get_timeout      (PtyxisParkingLot *self);
+void              ptyxis_parking_lot_set_timeout      (PtyxisParkingLot *self,
+                                                       guint             timeout);
+guint             ptyxis_parking_lot_get_history_size (PtyxisParkingLot *self);
+void              ptyxis_parking_lot_set_history_size (PtyxisParkingLot *self,
+                                                       guint             history_size);
+void              ptyxis_parking_lot_push             (PtyxisParkingLot *self,
+                                                       PtyxisTab        *tab);
+PtyxisTab        *ptyxis_parking_lot_pop              (PtyxisParkingLot *self);
+PtyxisTab        *ptyxis_parking_lot_restore          (PtyxisParkingLot *self);
 
 G_END_DECLS
@@ -172,6 +172,22 @@ invalidate_filter (PtyxisPreferencesWindow *self)
   g_set_str (&self->default_palette_id, default_palette_id);
 
   gtk_filter_changed (GTK_FILTER (self->filter), GTK_FILTER_CHANGE_DIFFERENT);
+
+  /* Update selection here rather than binding every preview to the
+   * default profile, which gets expensive with many palettes.
+   */
+  for (GtkWidget *child = gtk_widget_get_first_child (GTK_WIDGET (self->palette_previews));
+       child;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      GtkWidget *button = gtk_flow_box_child_get_child (GTK_FLOW_BOX_CHILD (child));
+      GtkWidget *preview = gtk_button_get_child (GTK_BUTTON (button));
+      PtyxisPalette *palette = ptyxis_palette_preview_get_palette (PTYXIS_PALETTE_PREVIEW (preview));
+
+      g_object_set (preview,
+                    "selected", g_strcmp0 (self->default_palette_id, ptyxis_palette_get_id (palette)) == 0,
+                    NULL);
+    }
 }
 
 static gboolean
@@ -400,28 +416,6 @@ index_to_string (const GValue       *value,
   return NULL;
 }
 
-static gboolean
-map_palette_to_selected (GBinding     *binding,
-                         const GValue *from_value,
-                         GValue       *to_value,
-                         gpointer      user_data)
-{
-  PtyxisPalette *current;
-  PtyxisPalette *palette;
-
-  g_assert (G_IS_BINDING (binding));
-  g_assert (from_value != NULL);
-  g_assert (to_value != NULL);
-
-  palette = g_value_get_object (from_value);
-  current = ptyxis_palette_preview_get_palette (user_data);
-
-  g_value_set_boolean (to_value,
-                       0 == g_strcmp0 (ptyxis_palette_get_id (palette),
-                                       ptyxis_palette_get_id (current)));
-  return TRUE;
-}
-
 static gboolean
 opacity_to_label (GBinding     *binding,
                   const GValue *from_value,
@@ -471,19 +465,6 @@ ptyxis_preferences_window_notify_default_profile_cb (PtyxisPreferencesWindow *se
 
   invalidate_filter (self);
 
-  for (GtkWidget *child = gtk_widget_get_first_child (GTK_WIDGET (self->palette_previews));
-       child;
-       child = gtk_widget_get_next_sibling (child))
-    {
-      GtkWidget *button = gtk_flow_box_child_get_child (GTK_FLOW_BOX_CHILD (child));
-      GtkWidget *preview = gtk_button_get_child (GTK_BUTTON (button));
-
-      g_object_bind_property_full (profile, "palette", preview, "selected",
-                                   G_BINDING_SYNC_CREATE,
-                                   map_palette_to_selected, NULL,
-                                   preview, NULL);
-    }
-
   group = g_simple_action_group_new ();
   palette_action = g_property_action_new ("palette", profile, "palette-id");
   g_action_map_add_action (G_ACTION_MAP (group), G_ACTION (palette_action));
@@ -614,19 +595,20 @@ static GtkWidget *
 create_palette_preview (gpointer item,
                         gpointer user_data)
 {
-  AdwStyleManager *style_manager = user_data;
-  g_autoptr(PtyxisProfile) default_profile = NULL;
+  PtyxisPreferencesWindow *self = user_data;
   g_autoptr(GVariant) action_target = NULL;
   PtyxisPalette *palette = item;
+  AdwStyleManager *style_manager;
   PtyxisSettings *settings;
   GtkButton *button;
   GtkWidget *preview;
   GtkWidget *child;
 
   g_assert (PTYXIS_IS_PALETTE (palette));
-  g_assert (ADW_IS_STYLE_MANAGER (style_manager));
+  g_assert (PTYXIS_IS_PREFERENCES_WINDOW (self));
 
   settings = ptyxis_application_get_settings (PTYXIS_APPLICATION_DEFAULT);
+  style_manager = adw_style_manager_get_default ();
   action_target = g_variant_take_ref (g_variant_new_string (ptyxis_palette_get_id (palette)));
   preview = ptyxis_palette_preview_new (palette);
   g_object_bind_property (style_manager, "dark", preview, "dark", G_BINDING_SYNC_CREATE);
@@ -644,14 +626,10 @@ create_palette_preview (gpointer item,
                         "child", button,
                         NULL);
 
-  /* This is probably pretty slow and terrible to do here, but we need another
-   * way to track default-palette of default-profile, both of which could change.
-   */
-  default_profile = ptyxis_application_dup_default_profile (PTYXIS_APPLICATION_DEFAULT);
-  g_object_bind_property_full (default_profile, "palette", preview, "selected",
-                               G_BINDING_SYNC_CREATE,
-                               map_palette_to_selected, NULL,
-                               preview, NULL);
+  /* Selection is kept up to date by invalidate_filter() */
+  g_object_set (preview,
+                "selected", g_strcmp0 (self->default_palette_id, ptyxis_palette_get_id (palette)) == 0,
+                NULL);
 
   return child;
 }
@@ -681,8 +659,7 @@ ptyxis_preferences_window_constructed (GObject *object)
   gtk_flow_box_bind_model (self->palette_previews,
                            G_LIST_MODEL (self->filter_palettes),
                            create_palette_preview,
-                           g_object_ref (style_manager),
-                           g_object_unref);
+                           self, NULL);
 
   g_signal_connect_object (app,
                            "notify::default-profile",
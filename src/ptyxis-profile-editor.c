@@ -43,6 +43,8 @@ struct _PtyxisProfileEditor
   AdwSpinRow        *cell_height_scale;
   AdwComboRow       *containers;
   AdwSwitchRow      *use_custom_commmand;
+  AdwSwitchRow      *log_compress;
+  AdwSwitchRow      *log_output;
   AdwSwitchRow      *login_shell;
   AdwSpinRow        *scrollback_lines;
   AdwSwitchRow      *limit_scrollback;
@@ -294,6 +296,12 @@ ptyxis_profile_editor_constructed (GObject *object)
   g_object_bind_property (self->profile, "login-shell",
                           self->login_shell, "active",
                           G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
+  g_object_bind_property (self->profile, "log-output",
+                          self->log_output, "active",
+                          G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
+  g_object_bind_property (self->profile, "log-compress",
+                          self->log_compress, "active",
+                          G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
   g_object_bind_property (self->profile, "use-custom-command",
                           self->use_custom_commmand, "active",
                           G_BINDING_SYNC_CREATE | G_BINDING_BIDIRECTIONAL);
@@ -477,6 +485,8 @@ ptyxis_profile_editor_class_init (PtyxisProfileEditorClass *klass)
   gtk_widget_class_bind_template_child (widget_class, PtyxisProfileEditor, exit_actions);
   gtk_widget_class_bind_template_child (widget_class, PtyxisProfileEditor, label);
   gtk_widget_class_bind_template_child (widget_class, PtyxisProfileEditor, limit_scrollback);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisProfileEditor, log_compress);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisProfileEditor, log_output);
   gtk_widget_class_bind_template_child (widget_class, PtyxisProfileEditor, login_shell);
   gtk_widget_class_bind_template_child (widget_class, PtyxisProfileEditor, opacity);
   gtk_widget_class_bind_template_child (widget_class, PtyxisProfileEditor, opacity_adjustment);
@@ -31,11 +31,42 @@
 #include "ptyxis-profile-menu.h"
 #include "ptyxis-util.h"
 
+/* Values are read from GSettings in one pass and kept until the next
+ * "changed" signal so that hot paths like tab creation and spawning do
+ * not need to go through the settings backend for every getter.
+ */
+typedef struct _PtyxisProfileSnapshot
+{
+  char                    *label;
+  char                    *default_container;
+  char                    *palette_id;
+  char                    *custom_command;
+  double                   opacity;
+  double                   cell_height_scale;
+  int                      scrollback_lines;
+  PtyxisExitAction         exit_action;
+  PtyxisPreserveContainer  preserve_container;
+  PtyxisPreserveDirectory  preserve_directory;
+  VteEraseBinding          backspace_binding;
+  VteEraseBinding          delete_binding;
+  PtyxisCjkAmbiguousWidth  cjk_ambiguous_width;
+  guint                    scroll_on_keystroke : 1;
+  guint                    scroll_on_output : 1;
+  guint                    log_output : 1;
+  guint                    log_compress : 1;
+  guint                    limit_scrollback : 1;
+  guint                    bold_is_bright : 1;
+  guint                    login_shell : 1;
+  guint                    use_custom_command : 1;
+  guint                    use_proxy : 1;
+} PtyxisProfileSnapshot;
+
 struct _PtyxisProfile
 {
   GObject parent_instance;
   GSettings *settings;
   char *uuid;
+  PtyxisProfileSnapshot *snapshot;
 };
 
 enum {
@@ -50,6 +81,8 @@ enum {
   PROP_EXIT_ACTION,
   PROP_LABEL,
   PROP_LIMIT_SCROLLBACK,
+  PROP_LOG_COMPRESS,
+  PROP_LOG_OUTPUT,
   PROP_LOGIN_SHELL,
   PROP_OPACITY,
   PROP_PALETTE,
@@ -69,6 +102,61 @@ G_DEFINE_FINAL_TYPE (PtyxisProfile, ptyxis_profile, G_TYPE_OBJECT)
 
 static GParamSpec *properties [N_PROPS];
 
+static void
+ptyxis_profile_snapshot_free (PtyxisProfileSnapshot *snapshot)
+{
+  g_clear_pointer (&snapshot->label, g_free);
+  g_clear_pointer (&snapshot->default_container, g_free);
+  g_clear_pointer (&snapshot->palette_id, g_free);
+  g_clear_pointer (&snapshot->custom_command, g_free);
+  g_free (snapshot);
+}
+
+static PtyxisProfileSnapshot *
+ptyxis_profile_snapshot_new (GSettings *settings)
+{
+  PtyxisProfileSnapshot *snapshot;
+
+  g_assert (G_IS_SETTINGS (settings));
+
+  snapshot = g_new0 (PtyxisProfileSnapshot, 1);
+  snapshot->label = g_settings_get_string (settings, PTYXIS_PROFILE_KEY_LABEL);
+  snapshot->default_container = g_settings_get_string (settings, PTYXIS_PROFILE_KEY_DEFAULT_CONTAINER);
+  snapshot->palette_id = g_settings_get_string (settings, PTYXIS_PROFILE_KEY_PALETTE);
+  snapshot->custom_command = g_settings_get_string (settings, PTYXIS_PROFILE_KEY_CUSTOM_COMMAND);
+  snapshot->opacity = g_settings_get_double (settings, PTYXIS_PROFILE_KEY_OPACITY);
+  snapshot->cell_height_scale = g_settings_get_double (settings, PTYXIS_PROFILE_KEY_CELL_HEIGHT_SCALE);
+  snapshot->scrollback_lines = g_settings_get_int (settings, PTYXIS_PROFILE_KEY_SCROLLBACK_LINES);
+  snapshot->exit_action = g_settings_get_enum (settings, PTYXIS_PROFILE_KEY_EXIT_ACTION);
+  snapshot->preserve_container = g_settings_get_enum (settings, PTYXIS_PROFILE_KEY_PRESERVE_CONTAINER);
+  snapshot->preserve_directory = g_settings_get_enum (settings, PTYXIS_PROFILE_KEY_PRESERVE_DIRECTORY);
+  snapshot->backspace_binding = g_settings_get_enum (settings, PTYXIS_PROFILE_KEY_BACKSPACE_BINDING);
+  snapshot->delete_binding = g_settings_get_enum (settings, PTYXIS_PROFILE_KEY_DELETE_BINDING);
+  snapshot->cjk_ambiguous_width = g_settings_get_enum (settings, PTYXIS_PROFILE_KEY_CJK_AMBIGUOUS_WIDTH);
+  snapshot->scroll_on_keystroke = g_settings_get_boolean (settings, PTYXIS_PROFILE_KEY_SCROLL_ON_KEYSTROKE);
+  snapshot->scroll_on_output = g_settings_get_boolean (settings, PTYXIS_PROFILE_KEY_SCROLL_ON_OUTPUT);
+  snapshot->log_output = g_settings_get_boolean (settings, PTYXIS_PROFILE_KEY_LOG_OUTPUT);
+  snapshot->log_compress = g_settings_get_boolean (settings, PTYXIS_PROFILE_KEY_LOG_COMPRESS);
+  snapshot->limit_scrollback = g_settings_get_boolean (settings, PTYXIS_PROFILE_KEY_LIMIT_SCROLLBACK);
+  snapshot->bold_is_bright = g_settings_get_boolean (settings, PTYXIS_PROFILE_KEY_BOLD_IS_BRIGHT);
+  snapshot->login_shell = g_settings_get_boolean (settings, PTYXIS_PROFILE_KEY_LOGIN_SHELL);
+  snapshot->use_custom_command = g_settings_get_boolean (settings, PTYXIS_PROFILE_KEY_USE_CUSTOM_COMMAND);
+  snapshot->use_proxy = g_settings_get_boolean (settings, PTYXIS_PROFILE_KEY_USE_PROXY);
+
+  return snapshot;
+}
+
+static inline const PtyxisProfileSnapshot *
+ptyxis_profile_get_snapshot (PtyxisProfile *self)
+{
+  g_assert (PTYXIS_IS_PROFILE (self));
+
+  if G_UNLIKELY (self->snapshot == NULL)
+    self->snapshot = ptyxis_profile_snapshot_new (self->settings);
+
+  return self->snapshot;
+}
+
 static void
 ptyxis_profile_changed_cb (PtyxisProfile *self,
                            const char    *key,
@@ -78,6 +166,11 @@ ptyxis_profile_changed_cb (PtyxisProfile *self,
   g_assert (key != NULL);
   g_assert (G_IS_SETTINGS (settings));
 
+  /* Drop the snapshot and rebuild it lazily so that a batch of changes
+   * only costs a single pass over the settings.
+   */
+  g_clear_pointer (&self->snapshot, ptyxis_profile_snapshot_free);
+
   if (FALSE) {}
   else if (g_str_equal (key, PTYXIS_PROFILE_KEY_LABEL))
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LABEL]);
@@ -108,6 +201,10 @@ ptyxis_profile_changed_cb (PtyxisProfile *self,
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_CELL_HEIGHT_SCALE]);
   else if (g_str_equal (key, PTYXIS_PROFILE_KEY_LOGIN_SHELL))
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOGIN_SHELL]);
+  else if (g_str_equal (key, PTYXIS_PROFILE_KEY_LOG_OUTPUT))
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOG_OUTPUT]);
+  else if (g_str_equal (key, PTYXIS_PROFILE_KEY_LOG_COMPRESS))
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOG_COMPRESS]);
   else if (g_str_equal (key, PTYXIS_PROFILE_KEY_CUSTOM_COMMAND))
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_CUSTOM_COMMAND]);
   else if (g_str_equal (key, PTYXIS_PROFILE_KEY_USE_CUSTOM_COMMAND))
@@ -135,6 +232,8 @@ ptyxis_profile_constructed (GObject *object)
                            G_CALLBACK (ptyxis_profile_changed_cb),
                            self,
                            G_CONNECT_SWAPPED);
+
+  self->snapshot = ptyxis_profile_snapshot_new (self->settings);
 }
 
 static void
@@ -144,6 +243,7 @@ ptyxis_profile_dispose (GObject *object)
 
   g_clear_object (&self->settings);
   g_clear_pointer (&self->uuid, g_free);
+  g_clear_pointer (&self->snapshot, ptyxis_profile_snapshot_free);
 
   G_OBJECT_CLASS (ptyxis_profile_parent_class)->dispose (object);
 }
@@ -230,6 +330,14 @@ ptyxis_profile_get_property (GObject    *object,
       g_value_set_boolean (value, ptyxis_profile_get_scroll_on_output (self));
       break;
 
+    case PROP_LOG_COMPRESS:
+      g_value_set_boolean (value, ptyxis_profile_get_log_compress (self));
+      break;
+
+    case PROP_LOG_OUTPUT:
+      g_value_set_boolean (value, ptyxis_profile_get_log_output (self));
+      break;
+
     case PROP_SCROLLBACK_LINES:
       g_value_set_int (value, ptyxis_profile_get_scrollback_lines (self));
       break;
@@ -341,6 +449,14 @@ ptyxis_profile_set_property (GObject      *object,
       ptyxis_profile_set_scroll_on_output (self, g_value_get_boolean (value));
       break;
 
+    case PROP_LOG_COMPRESS:
+      ptyxis_profile_set_log_compress (self, g_value_get_boolean (value));
+      break;
+
+    case PROP_LOG_OUTPUT:
+      ptyxis_profile_set_log_output (self, g_value_get_boolean (value));
+      break;
+
     case PROP_SCROLLBACK_LINES:
       ptyxis_profile_set_scrollback_lines (self, g_value_get_int (value));
       break;
@@ -504,6 +620,20 @@ ptyxis_profile_class_init (PtyxisProfileClass *klass)
                           G_PARAM_EXPLICIT_NOTIFY |
                           G_PARAM_STATIC_STRINGS));
 
+  properties[PROP_LOG_COMPRESS] =
+    g_param_spec_boolean ("log-compress", NULL, NULL,
+                         FALSE,
+                         (G_PARAM_READWRITE |
+                          G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS));
+
+  properties[PROP_LOG_OUTPUT] =
+    g_param_spec_boolean ("log-output", NULL, NULL,
+                         FALSE,
+                         (G_PARAM_READWRITE |
+                          G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS));
+
   properties[PROP_SCROLLBACK_LINES] =
     g_param_spec_int ("scrollback-lines", NULL, NULL,
                       0, G_MAXINT, 10000,
@@ -571,7 +701,7 @@ ptyxis_profile_dup_label (PtyxisProfile *self)
 
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), NULL);
 
-  label = g_settings_get_string (self->settings, PTYXIS_PROFILE_KEY_LABEL);
+  label = g_strdup (ptyxis_profile_get_snapshot (self)->label);
 
   if (ptyxis_str_empty0 (label))
     g_set_str (&label, _("Untitled Profile"));
@@ -602,7 +732,7 @@ ptyxis_profile_get_scroll_on_keystroke (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_PROFILE_KEY_SCROLL_ON_KEYSTROKE);
+  return ptyxis_profile_get_snapshot (self)->scroll_on_keystroke;
 }
 
 void
@@ -621,7 +751,7 @@ ptyxis_profile_get_scroll_on_output (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_PROFILE_KEY_SCROLL_ON_OUTPUT);
+  return ptyxis_profile_get_snapshot (self)->scroll_on_output;
 }
 
 void
@@ -635,12 +765,50 @@ ptyxis_profile_set_scroll_on_output (PtyxisProfile *self,
                           scroll_on_output);
 }
 
+gboolean
+ptyxis_profile_get_log_output (PtyxisProfile *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_PROFILE (self), FALSE);
+
+  return ptyxis_profile_get_snapshot (self)->log_output;
+}
+
+void
+ptyxis_profile_set_log_output (PtyxisProfile *self,
+                               gboolean       log_output)
+{
+  g_return_if_fail (PTYXIS_IS_PROFILE (self));
+
+  g_settings_set_boolean (self->settings,
+                          PTYXIS_PROFILE_KEY_LOG_OUTPUT,
+                          log_output);
+}
+
+gboolean
+ptyxis_profile_get_log_compress (PtyxisProfile *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_PROFILE (self), FALSE);
+
+  return ptyxis_profile_get_snapshot (self)->log_compress;
+}
+
+void
+ptyxis_profile_set_log_compress (PtyxisProfile *self,
+                                 gboolean       log_compress)
+{
+  g_return_if_fail (PTYXIS_IS_PROFILE (self));
+
+  g_settings_set_boolean (self->settings,
+                          PTYXIS_PROFILE_KEY_LOG_COMPRESS,
+                          log_compress);
+}
+
 char *
 ptyxis_profile_dup_default_container (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), NULL);
 
-  return g_settings_get_string (self->settings, PTYXIS_PROFILE_KEY_DEFAULT_CONTAINER);
+  return g_strdup (ptyxis_profile_get_snapshot (self)->default_container);
 }
 
 void
@@ -662,7 +830,7 @@ ptyxis_profile_get_exit_action (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_PROFILE_KEY_EXIT_ACTION);
+  return ptyxis_profile_get_snapshot (self)->exit_action;
 }
 
 void
@@ -682,7 +850,7 @@ ptyxis_profile_get_preserve_container (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_PROFILE_KEY_PRESERVE_CONTAINER);
+  return ptyxis_profile_get_snapshot (self)->preserve_container;
 }
 
 void
@@ -702,7 +870,7 @@ ptyxis_profile_get_preserve_directory (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_PROFILE_KEY_PRESERVE_DIRECTORY);
+  return ptyxis_profile_get_snapshot (self)->preserve_directory;
 }
 
 void
@@ -751,19 +919,15 @@ ptyxis_profile_dup_palette_id (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), NULL);
 
-  return g_settings_get_string (self->settings, PTYXIS_PROFILE_KEY_PALETTE);
+  return g_strdup (ptyxis_profile_get_snapshot (self)->palette_id);
 }
 
 PtyxisPalette *
 ptyxis_profile_dup_palette (PtyxisProfile *self)
 {
-  g_autofree char *name = NULL;
-
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), NULL);
 
-  name = g_settings_get_string (self->settings, PTYXIS_PROFILE_KEY_PALETTE);
-
-  return ptyxis_palette_lookup (name);
+  return ptyxis_palette_lookup (ptyxis_profile_get_snapshot (self)->palette_id);
 }
 
 void
@@ -786,7 +950,7 @@ ptyxis_profile_get_opacity (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), 1.);
 
-  return g_settings_get_double (self->settings, PTYXIS_PROFILE_KEY_OPACITY);
+  return ptyxis_profile_get_snapshot (self)->opacity;
 }
 
 void
@@ -807,7 +971,7 @@ ptyxis_profile_get_limit_scrollback (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_PROFILE_KEY_LIMIT_SCROLLBACK);
+  return ptyxis_profile_get_snapshot (self)->limit_scrollback;
 }
 
 void
@@ -826,7 +990,7 @@ ptyxis_profile_get_scrollback_lines (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), 0);
 
-  return g_settings_get_int (self->settings, PTYXIS_PROFILE_KEY_SCROLLBACK_LINES);
+  return ptyxis_profile_get_snapshot (self)->scrollback_lines;
 }
 
 void
@@ -853,7 +1017,7 @@ ptyxis_profile_get_backspace_binding (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_PROFILE_KEY_BACKSPACE_BINDING);
+  return ptyxis_profile_get_snapshot (self)->backspace_binding;
 }
 
 void
@@ -872,7 +1036,7 @@ ptyxis_profile_get_delete_binding (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_PROFILE_KEY_DELETE_BINDING);
+  return ptyxis_profile_get_snapshot (self)->delete_binding;
 }
 
 void
@@ -891,7 +1055,7 @@ ptyxis_profile_get_cjk_ambiguous_width (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), 1);
 
-  return g_settings_get_enum (self->settings, PTYXIS_PROFILE_KEY_CJK_AMBIGUOUS_WIDTH);
+  return ptyxis_profile_get_snapshot (self)->cjk_ambiguous_width;
 }
 
 void
@@ -910,7 +1074,7 @@ ptyxis_profile_get_bold_is_bright (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_PROFILE_KEY_BOLD_IS_BRIGHT);
+  return ptyxis_profile_get_snapshot (self)->bold_is_bright;
 }
 
 void
@@ -929,7 +1093,7 @@ ptyxis_profile_get_cell_height_scale (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), 0);
 
-  return g_settings_get_double (self->settings, PTYXIS_PROFILE_KEY_CELL_HEIGHT_SCALE);
+  return ptyxis_profile_get_snapshot (self)->cell_height_scale;
 }
 
 void
@@ -948,7 +1112,7 @@ ptyxis_profile_get_login_shell (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_PROFILE_KEY_LOGIN_SHELL);
+  return ptyxis_profile_get_snapshot (self)->login_shell;
 }
 
 void
@@ -967,7 +1131,7 @@ ptyxis_profile_get_use_custom_command (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_PROFILE_KEY_USE_CUSTOM_COMMAND);
+  return ptyxis_profile_get_snapshot (self)->use_custom_command;
 }
 
 void
@@ -986,8 +1150,7 @@ ptyxis_profile_get_use_proxy (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), FALSE);
 
-  return g_settings_get_boolean (self->settings,
-                                 PTYXIS_PROFILE_KEY_USE_PROXY);
+  return ptyxis_profile_get_snapshot (self)->use_proxy;
 }
 
 void
@@ -1006,7 +1169,7 @@ ptyxis_profile_dup_custom_command (PtyxisProfile *self)
 {
   g_return_val_if_fail (PTYXIS_IS_PROFILE (self), NULL);
 
-  return g_settings_get_string (self->settings, PTYXIS_PROFILE_KEY_CUSTOM_COMMAND);
+  return g_strdup (ptyxis_profile_get_snapshot (self)->custom_command);
 }
 
 void
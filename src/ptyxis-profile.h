@@ -38,6 +38,8 @@ G_BEGIN_DECLS
 #define PTYXIS_PROFILE_KEY_EXIT_ACTION         "exit-action"
 #define PTYXIS_PROFILE_KEY_LABEL               "label"
 #define PTYXIS_PROFILE_KEY_LIMIT_SCROLLBACK    "limit-scrollback"
+#define PTYXIS_PROFILE_KEY_LOG_COMPRESS        "log-compress"
+#define PTYXIS_PROFILE_KEY_LOG_OUTPUT          "log-output"
 #define PTYXIS_PROFILE_KEY_LOGIN_SHELL         "login-shell"
 #define PTYXIS_PROFILE_KEY_OPACITY             "opacity"
 #define PTYXIS_PROFILE_KEY_PALETTE             "palette"
@@ -101,6 +103,12 @@ void                     ptyxis_profile_set_scroll_on_keystroke (PtyxisProfile
 gboolean                 ptyxis_profile_get_scroll_on_output    (PtyxisProfile            *self);
 void                     ptyxis_profile_set_scroll_on_output    (PtyxisProfile            *self,
                                                                  gboolean                  scroll_on_output);
+gboolean                 ptyxis_profile_get_log_output          (PtyxisProfile            *self);
+void                     ptyxis_profile_set_log_output          (PtyxisProfile            *self,
+                                                                 gboolean                  log_output);
+gboolean                 ptyxis_profile_get_log_compress        (PtyxisProfile            *self);
+void                     ptyxis_profile_set_log_compress        (PtyxisProfile            *self,
+                                                                 gboolean                  log_compress);
 gboolean                 ptyxis_profile_get_bold_is_bright      (PtyxisProfile            *self);
 void                     ptyxis_profile_set_bold_is_bright      (PtyxisProfile            *self,
                                                                  gboolean                  bold_is_bright);
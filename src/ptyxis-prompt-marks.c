@@ -0,0 +1,287 @@
+/*
+ * ptyxis-prompt-marks.c
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include "ptyxis-prompt-marks.h"
+
+/* Marks are kept in a fixed-size ring ordered by row, oldest first. Each
+ * mark is a single gint64 with the kind in the low bit so that a few
+ * thousand prompts of history costs a few pages of memory per terminal.
+ */
+#define MARK_ROW(m)        ((m) >> 1)
+#define MARK_KIND(m)       ((PtyxisPromptMarkKind)((m) & 1))
+#define MARK_NEW(row,kind) (((row) << 1) | ((kind) & 1))
+
+struct _PtyxisPromptMarks
+{
+  guint  capacity;
+  guint  head;
+  guint  len;
+  gint64 marks[];
+};
+
+static inline gint64
+get_mark (PtyxisPromptMarks *self,
+          guint              index)
+{
+  g_assert (index < self->len);
+
+  return self->marks[(self->head + index) % self->capacity];
+}
+
+/* Returns the index of the first mark with a row greater than @row */
+static guint
+upper_bound (PtyxisPromptMarks *self,
+             gint64             row)
+{
+  guint lo = 0;
+  guint hi = self->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (MARK_ROW (get_mark (self, mid)) <= row)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+PtyxisPromptMarks *
+ptyxis_prompt_marks_new (guint capacity)
+{
+  PtyxisPromptMarks *self;
+
+  g_return_val_if_fail (capacity > 0, NULL);
+
+  self = g_malloc0 (sizeof *self + capacity * sizeof (gint64));
+  self->capacity = capacity;
+
+  return self;
+}
+
+void
+ptyxis_prompt_marks_free (PtyxisPromptMarks *self)
+{
+  g_free (self);
+}
+
+guint
+ptyxis_prompt_marks_get_n_marks (PtyxisPromptMarks *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->len;
+}
+
+/**
+ * ptyxis_prompt_marks_add:
+ * @self: a #PtyxisPromptMarks
+ * @row: the row of the mark
+ * @kind: the kind of mark
+ *
+ * Records a mark at @row, evicting the oldest mark if full.
+ *
+ * Marks below @row are assumed to be stale (the terminal was reset or
+ * cleared) and are dropped first, which keeps the ring sorted. A prompt
+ * and an output mark may share a row, such as when a command printed
+ * nothing, and are kept in the order they were added.
+ */
+void
+ptyxis_prompt_marks_add (PtyxisPromptMarks    *self,
+                         gint64                row,
+                         PtyxisPromptMarkKind  kind)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (row >= 0);
+
+  while (self->len > 0 && MARK_ROW (get_mark (self, self->len - 1)) > row)
+    self->len--;
+
+  /* Shells may report precmd more than once for the same prompt */
+  for (guint index = self->len; index > 0; index--)
+    {
+      gint64 mark = get_mark (self, index - 1);
+
+      if (MARK_ROW (mark) != row)
+        break;
+
+      if (MARK_KIND (mark) == kind)
+        return;
+    }
+
+  if (self->len == self->capacity)
+    {
+      self->head = (self->head + 1) % self->capacity;
+      self->len--;
+    }
+
+  self->marks[(self->head + self->len) % self->capacity] = MARK_NEW (row, kind);
+  self->len++;
+}
+
+/**
+ * ptyxis_prompt_marks_clamp:
+ * @self: a #PtyxisPromptMarks
+ * @first_row: the oldest row still in the scrollback
+ * @last_row: the row of the cursor
+ *
+ * Drops marks which have fallen out of the scrollback, or which are
+ * beyond the cursor because the terminal was reset.
+ */
+void
+ptyxis_prompt_marks_clamp (PtyxisPromptMarks *self,
+                           gint64             first_row,
+                           gint64             last_row)
+{
+  g_return_if_fail (self != NULL);
+
+  while (self->len > 0 && MARK_ROW (get_mark (self, 0)) < first_row)
+    {
+      self->head = (self->head + 1) % self->capacity;
+      self->len--;
+    }
+
+  while (self->len > 0 && MARK_ROW (get_mark (self, self->len - 1)) > last_row)
+    self->len--;
+
+  if (self->len == 0)
+    self->head = 0;
+}
+
+/**
+ * ptyxis_prompt_marks_find_previous:
+ * @self: a #PtyxisPromptMarks
+ * @row: the row to search from
+ * @kind: the kind of mark to find
+ * @found_row: (out): location for the row of the mark
+ *
+ * Finds the closest mark of @kind above @row.
+ *
+ * Returns: %TRUE if a mark was found
+ */
+gboolean
+ptyxis_prompt_marks_find_previous (PtyxisPromptMarks    *self,
+                                   gint64                row,
+                                   PtyxisPromptMarkKind  kind,
+                                   gint64               *found_row)
+{
+  guint index;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (found_row != NULL, FALSE);
+
+  index = upper_bound (self, row - 1);
+
+  /* Prompt and output marks alternate, so this rarely steps more than once */
+  while (index > 0)
+    {
+      gint64 mark = get_mark (self, --index);
+
+      if (MARK_KIND (mark) == kind)
+        {
+          *found_row = MARK_ROW (mark);
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+/**
+ * ptyxis_prompt_marks_find_next:
+ * @self: a #PtyxisPromptMarks
+ * @row: the row to search from
+ * @kind: the kind of mark to find
+ * @found_row: (out): location for the row of the mark
+ *
+ * Finds the closest mark of @kind below @row.
+ *
+ * Returns: %TRUE if a mark was found
+ */
+gboolean
+ptyxis_prompt_marks_find_next (PtyxisPromptMarks    *self,
+                               gint64                row,
+                               PtyxisPromptMarkKind  kind,
+                               gint64               *found_row)
+{
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (found_row != NULL, FALSE);
+
+  for (guint index = upper_bound (self, row); index < self->len; index++)
+    {
+      gint64 mark = get_mark (self, index);
+
+      if (MARK_KIND (mark) == kind)
+        {
+          *found_row = MARK_ROW (mark);
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+/**
+ * ptyxis_prompt_marks_get_last_output:
+ * @self: a #PtyxisPromptMarks
+ * @begin_row: (out): location for the first row of output
+ * @end_row: (out): location for the row after the output
+ *
+ * Gets the rows written by the most recent command which has finished,
+ * which is everything from its output mark to the following prompt.
+ * The range is empty if the command did not print anything.
+ *
+ * Returns: %TRUE if a finished command was found
+ */
+gboolean
+ptyxis_prompt_marks_get_last_output (PtyxisPromptMarks *self,
+                                     gint64            *begin_row,
+                                     gint64            *end_row)
+{
+  gint64 prompt_row = -1;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (begin_row != NULL, FALSE);
+  g_return_val_if_fail (end_row != NULL, FALSE);
+
+  for (guint index = self->len; index > 0; index--)
+    {
+      gint64 mark = get_mark (self, index - 1);
+
+      if (MARK_KIND (mark) == PTYXIS_PROMPT_MARK_PROMPT)
+        {
+          prompt_row = MARK_ROW (mark);
+        }
+      else if (prompt_row >= 0)
+        {
+          *begin_row = MARK_ROW (mark);
+          *end_row = prompt_row;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
@@ -0,0 +1,59 @@
+/*
+ * ptyxis-prompt-marks.h
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef enum _PtyxisPromptMarkKind
+{
+  PTYXIS_PROMPT_MARK_PROMPT = 0,
+  PTYXIS_PROMPT_MARK_OUTPUT = 1,
+} PtyxisPromptMarkKind;
+
+typedef struct _PtyxisPromptMarks PtyxisPromptMarks;
+
+PtyxisPromptMarks *ptyxis_prompt_marks_new             (guint                 capacity);
+void               ptyxis_prompt_marks_free            (PtyxisPromptMarks    *self);
+guint              ptyxis_prompt_marks_get_n_marks     (PtyxisPromptMarks    *self);
+void               ptyxis_prompt_marks_add             (PtyxisPromptMarks    *self,
+                                                        gint64                row,
+                                                        PtyxisPromptMarkKind  kind);
+void               ptyxis_prompt_marks_clamp           (PtyxisPromptMarks    *self,
+                                                        gint64                first_row,
+                                                        gint64                last_row);
+gboolean           ptyxis_prompt_marks_find_previous   (PtyxisPromptMarks    *self,
+                                                        gint64                row,
+                                                        PtyxisPromptMarkKind  kind,
+                                                        gint64               *found_row);
+gboolean           ptyxis_prompt_marks_find_next       (PtyxisPromptMarks    *self,
+                                                        gint64                row,
+                                                        PtyxisPromptMarkKind  kind,
+                                                        gint64               *found_row);
+gboolean           ptyxis_prompt_marks_get_last_output (PtyxisPromptMarks    *self,
+                                                        gint64               *begin_row,
+                                                        gint64               *end_row);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (PtyxisPromptMarks, ptyxis_prompt_marks_free)
+
+G_END_DECLS
@@ -0,0 +1,361 @@
+/*
+ * ptyxis-scrollback-budget.c
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include "ptyxis-scrollback-budget.h"
+#include "ptyxis-tab-private.h"
+
+/* How long to wait after something interesting happens (a tab was added
+ * or moved to the background) before re-evaluating the budget. While a
+ * budget is set, we also re-check periodically since background tabs
+ * may continue to accumulate output.
+ */
+#define QUEUE_UPDATE_SECONDS    5
+#define PERIODIC_UPDATE_SECONDS 60
+
+/* The smallest scrollback we'll ever shrink a background tab to. This
+ * is enough to see the tail of whatever was running in the tab.
+ */
+#define MIN_BACKGROUND_LINES 1000
+
+struct _PtyxisScrollbackBudget
+{
+  GObject         parent_instance;
+  PtyxisSettings *settings;
+  GPtrArray      *tabs;
+  guint64         usage;
+  guint           update_source;
+  guint           periodic_source;
+};
+
+enum {
+  PROP_0,
+  PROP_LIMIT,
+  PROP_USAGE,
+  N_PROPS
+};
+
+G_DEFINE_FINAL_TYPE (PtyxisScrollbackBudget, ptyxis_scrollback_budget, G_TYPE_OBJECT)
+
+static GParamSpec *properties[N_PROPS];
+
+static int
+compare_by_last_active (gconstpointer a,
+                        gconstpointer b)
+{
+  PtyxisTab *tab_a = *(PtyxisTab **)a;
+  PtyxisTab *tab_b = *(PtyxisTab **)b;
+  gint64 time_a = _ptyxis_tab_get_last_active_time (tab_a);
+  gint64 time_b = _ptyxis_tab_get_last_active_time (tab_b);
+
+  if (time_a < time_b)
+    return -1;
+  else if (time_a > time_b)
+    return 1;
+  else
+    return 0;
+}
+
+static void
+ptyxis_scrollback_budget_update (PtyxisScrollbackBudget *self)
+{
+  g_autoptr(GPtrArray) background = NULL;
+  guint64 limit;
+  guint64 usage = 0;
+
+  g_assert (PTYXIS_IS_SCROLLBACK_BUDGET (self));
+
+  limit = ptyxis_scrollback_budget_get_limit (self);
+  background = g_ptr_array_new ();
+
+  for (guint i = 0; i < self->tabs->len; i++)
+    {
+      PtyxisTab *tab = g_ptr_array_index (self->tabs, i);
+
+      usage += _ptyxis_tab_get_scrollback_usage (tab, NULL);
+
+      if (limit == 0)
+        _ptyxis_tab_set_scrollback_override (tab, 0);
+      else if (_ptyxis_tab_is_background (tab))
+        g_ptr_array_add (background, tab);
+    }
+
+  if (limit > 0 && usage > limit)
+    {
+      g_ptr_array_sort (background, compare_by_last_active);
+
+      for (guint i = 0; i < background->len && usage > limit; i++)
+        {
+          PtyxisTab *tab = g_ptr_array_index (background, i);
+          guint64 before = _ptyxis_tab_get_scrollback_usage (tab, NULL);
+          guint64 after;
+
+          _ptyxis_tab_set_scrollback_override (tab, MIN_BACKGROUND_LINES);
+
+          after = _ptyxis_tab_get_scrollback_usage (tab, NULL);
+
+          if (after < before)
+            usage -= before - after;
+        }
+
+      if (usage > limit)
+        g_debug ("Scrollback usage of %"G_GUINT64_FORMAT" bytes exceeds budget "
+                 "of %"G_GUINT64_FORMAT" bytes from active tabs",
+                 usage, limit);
+    }
+
+  if (usage != self->usage)
+    {
+      self->usage = usage;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_USAGE]);
+    }
+}
+
+static gboolean
+ptyxis_scrollback_budget_update_cb (gpointer data)
+{
+  PtyxisScrollbackBudget *self = data;
+
+  g_assert (PTYXIS_IS_SCROLLBACK_BUDGET (self));
+
+  self->update_source = 0;
+
+  ptyxis_scrollback_budget_update (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+ptyxis_scrollback_budget_periodic_cb (gpointer data)
+{
+  PtyxisScrollbackBudget *self = data;
+
+  g_assert (PTYXIS_IS_SCROLLBACK_BUDGET (self));
+
+  ptyxis_scrollback_budget_update (self);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+ptyxis_scrollback_budget_notify_limit_cb (PtyxisScrollbackBudget *self,
+                                          GParamSpec             *pspec,
+                                          PtyxisSettings         *settings)
+{
+  g_assert (PTYXIS_IS_SCROLLBACK_BUDGET (self));
+  g_assert (PTYXIS_IS_SETTINGS (settings));
+
+  g_clear_handle_id (&self->periodic_source, g_source_remove);
+
+  if (ptyxis_settings_get_scrollback_budget (settings) > 0)
+    self->periodic_source =
+      g_timeout_add_seconds_full (G_PRIORITY_LOW,
+                                  PERIODIC_UPDATE_SECONDS,
+                                  ptyxis_scrollback_budget_periodic_cb,
+                                  self, NULL);
+
+  ptyxis_scrollback_budget_queue_update (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LIMIT]);
+}
+
+static void
+ptyxis_scrollback_budget_dispose (GObject *object)
+{
+  PtyxisScrollbackBudget *self = (PtyxisScrollbackBudget *)object;
+
+  g_clear_handle_id (&self->update_source, g_source_remove);
+  g_clear_handle_id (&self->periodic_source, g_source_remove);
+
+  if (self->tabs != NULL)
+    g_ptr_array_set_size (self->tabs, 0);
+
+  g_clear_object (&self->settings);
+
+  G_OBJECT_CLASS (ptyxis_scrollback_budget_parent_class)->dispose (object);
+}
+
+static void
+ptyxis_scrollback_budget_finalize (GObject *object)
+{
+  PtyxisScrollbackBudget *self = (PtyxisScrollbackBudget *)object;
+
+  g_clear_pointer (&self->tabs, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (ptyxis_scrollback_budget_parent_class)->finalize (object);
+}
+
+static void
+ptyxis_scrollback_budget_get_property (GObject    *object,
+                                       guint       prop_id,
+                                       GValue     *value,
+                                       GParamSpec *pspec)
+{
+  PtyxisScrollbackBudget *self = PTYXIS_SCROLLBACK_BUDGET (object);
+
+  switch (prop_id)
+    {
+    case PROP_LIMIT:
+      g_value_set_uint64 (value, ptyxis_scrollback_budget_get_limit (self));
+      break;
+
+    case PROP_USAGE:
+      g_value_set_uint64 (value, self->usage);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+ptyxis_scrollback_budget_class_init (PtyxisScrollbackBudgetClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = ptyxis_scrollback_budget_dispose;
+  object_class->finalize = ptyxis_scrollback_budget_finalize;
+  object_class->get_property = ptyxis_scrollback_budget_get_property;
+
+  properties[PROP_LIMIT] =
+    g_param_spec_uint64 ("limit", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE |
+                          G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS));
+
+  properties[PROP_USAGE] =
+    g_param_spec_uint64 ("usage", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE |
+                          G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+}
+
+static void
+ptyxis_scrollback_budget_init (PtyxisScrollbackBudget *self)
+{
+  self->tabs = g_ptr_array_new ();
+}
+
+PtyxisScrollbackBudget *
+ptyxis_scrollback_budget_new (PtyxisSettings *settings)
+{
+  PtyxisScrollbackBudget *self;
+
+  g_return_val_if_fail (PTYXIS_IS_SETTINGS (settings), NULL);
+
+  self = g_object_new (PTYXIS_TYPE_SCROLLBACK_BUDGET, NULL);
+  self->settings = g_object_ref (settings);
+
+  g_signal_connect_object (settings,
+                           "notify::scrollback-budget",
+                           G_CALLBACK (ptyxis_scrollback_budget_notify_limit_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+  ptyxis_scrollback_budget_notify_limit_cb (self, NULL, settings);
+
+  return self;
+}
+
+/**
+ * ptyxis_scrollback_budget_get_limit:
+ * @self: a #PtyxisScrollbackBudget
+ *
+ * Gets the number of bytes all tabs may use for scrollback combined.
+ *
+ * Returns: the limit in bytes, or 0 if there is no limit
+ */
+guint64
+ptyxis_scrollback_budget_get_limit (PtyxisScrollbackBudget *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_SCROLLBACK_BUDGET (self), 0);
+
+  if (self->settings == NULL)
+    return 0;
+
+  return (guint64)ptyxis_settings_get_scrollback_budget (self->settings) * 1024 * 1024;
+}
+
+/**
+ * ptyxis_scrollback_budget_get_usage:
+ * @self: a #PtyxisScrollbackBudget
+ *
+ * Gets the approximate number of bytes used for scrollback across all
+ * tabs as of the last time the budget was evaluated.
+ *
+ * Returns: the usage in bytes
+ */
+guint64
+ptyxis_scrollback_budget_get_usage (PtyxisScrollbackBudget *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_SCROLLBACK_BUDGET (self), 0);
+
+  return self->usage;
+}
+
+void
+ptyxis_scrollback_budget_add_tab (PtyxisScrollbackBudget *self,
+                                  PtyxisTab              *tab)
+{
+  g_return_if_fail (PTYXIS_IS_SCROLLBACK_BUDGET (self));
+  g_return_if_fail (PTYXIS_IS_TAB (tab));
+
+  /* Tabs are not referenced, they remove themselves during dispose */
+  g_ptr_array_add (self->tabs, tab);
+
+  ptyxis_scrollback_budget_queue_update (self);
+}
+
+void
+ptyxis_scrollback_budget_remove_tab (PtyxisScrollbackBudget *self,
+                                     PtyxisTab              *tab)
+{
+  g_return_if_fail (PTYXIS_IS_SCROLLBACK_BUDGET (self));
+  g_return_if_fail (PTYXIS_IS_TAB (tab));
+
+  if (g_ptr_array_remove_fast (self->tabs, tab))
+    ptyxis_scrollback_budget_queue_update (self);
+}
+
+/**
+ * ptyxis_scrollback_budget_queue_update:
+ * @self: a #PtyxisScrollbackBudget
+ *
+ * Queues a re-evaluation of scrollback usage at low priority. This
+ * should be called when a tab moves to the background so that it may
+ * be shrunk if the budget has been exceeded.
+ */
+void
+ptyxis_scrollback_budget_queue_update (PtyxisScrollbackBudget *self)
+{
+  g_return_if_fail (PTYXIS_IS_SCROLLBACK_BUDGET (self));
+
+  if (self->update_source == 0 && self->settings != NULL)
+    self->update_source =
+      g_timeout_add_seconds_full (G_PRIORITY_LOW,
+                                  QUEUE_UPDATE_SECONDS,
+                                  ptyxis_scrollback_budget_update_cb,
+                                  self, NULL);
+}
@@ -0,0 +1,42 @@
+/*
+ * ptyxis-scrollback-budget.h
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "ptyxis-settings.h"
+#include "ptyxis-tab.h"
+
+G_BEGIN_DECLS
+
+#define PTYXIS_TYPE_SCROLLBACK_BUDGET (ptyxis_scrollback_budget_get_type())
+
+G_DECLARE_FINAL_TYPE (PtyxisScrollbackBudget, ptyxis_scrollback_budget, PTYXIS, SCROLLBACK_BUDGET, GObject)
+
+PtyxisScrollbackBudget *ptyxis_scrollback_budget_new          (PtyxisSettings         *settings);
+void                    ptyxis_scrollback_budget_add_tab      (PtyxisScrollbackBudget *self,
+                                                               PtyxisTab              *tab);
+void                    ptyxis_scrollback_budget_remove_tab   (PtyxisScrollbackBudget *self,
+                                                               PtyxisTab              *tab);
+void                    ptyxis_scrollback_budget_queue_update (PtyxisScrollbackBudget *self);
+guint64                 ptyxis_scrollback_budget_get_usage    (PtyxisScrollbackBudget *self);
+guint64                 ptyxis_scrollback_budget_get_limit    (PtyxisScrollbackBudget *self);
+
+G_END_DECLS
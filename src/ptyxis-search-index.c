@@ -0,0 +1,669 @@
+/*
+ * ptyxis-search-index.c
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include "ptyxis-search-index.h"
+#include "ptyxis-util.h"
+
+#define CHUNK_ROWS        500
+#define UPDATE_DELAY_MSEC 100
+#define MAX_MATCHES       10000
+
+/* The indexed rows starting at @first_row. When starting over, the
+ * main thread replaces this rather than clearing it so that it never
+ * has to wait for a worker thread scanning the rows. Workers hold
+ * @mutex while reading or adding rows.
+ *
+ * The first @n_evicted rows have left the scrollback and their text
+ * has been released. Their postings remain until the next reset.
+ */
+typedef struct _PtyxisSearchData
+{
+  GMutex      mutex;
+  GPtrArray  *rows;
+  GHashTable *trigrams;
+  gint64      first_row;
+  guint       n_evicted;
+} PtyxisSearchData;
+
+/* Rows extracted from the terminal on the main thread which are then
+ * added to the index from a worker thread.
+ */
+typedef struct _PtyxisSearchChunk
+{
+  PtyxisSearchData *data;
+  GPtrArray        *rows;
+  gint64            first_row;
+  gint64            lower_row;
+} PtyxisSearchChunk;
+
+/* The row containing the cursor may still change so it is never
+ * indexed. Instead a copy is taken for each query.
+ */
+typedef struct _PtyxisSearchQuery
+{
+  PtyxisSearchData *data;
+  GRegex           *regex;
+  char             *literal;
+  char             *cursor_text;
+  gint64            cursor_row;
+  gint64            lower_row;
+} PtyxisSearchQuery;
+
+struct _PtyxisSearchIndex
+{
+  GObject           parent_instance;
+
+  /* Only accessed from the main thread */
+  VteTerminal      *terminal;
+  PtyxisSearchData *data;
+  gint64            next_row;
+  guint             update_source;
+  guint             in_flight : 1;
+};
+
+enum {
+  CHANGED,
+  N_SIGNALS
+};
+
+G_DEFINE_FINAL_TYPE (PtyxisSearchIndex, ptyxis_search_index, G_TYPE_OBJECT)
+
+static guint signals [N_SIGNALS];
+
+static inline guint
+ptyxis_search_index_trigram (const char *str)
+{
+  return ((guint)(guchar)g_ascii_tolower (str[0]) << 16) |
+         ((guint)(guchar)g_ascii_tolower (str[1]) << 8) |
+         (guint)(guchar)g_ascii_tolower (str[2]);
+}
+
+static void
+ptyxis_search_data_finalize (gpointer data)
+{
+  PtyxisSearchData *search_data = data;
+
+  g_clear_pointer (&search_data->rows, g_ptr_array_unref);
+  g_clear_pointer (&search_data->trigrams, g_hash_table_unref);
+  g_mutex_clear (&search_data->mutex);
+}
+
+static void
+ptyxis_search_data_unref (PtyxisSearchData *data)
+{
+  g_atomic_rc_box_release_full (data, ptyxis_search_data_finalize);
+}
+
+static PtyxisSearchData *
+ptyxis_search_data_new (gint64 first_row)
+{
+  PtyxisSearchData *data;
+
+  data = g_atomic_rc_box_new0 (PtyxisSearchData);
+  g_mutex_init (&data->mutex);
+  data->rows = g_ptr_array_new_with_free_func (g_free);
+  data->trigrams = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify)g_array_unref);
+  data->first_row = first_row;
+
+  return data;
+}
+
+static void
+ptyxis_search_chunk_free (PtyxisSearchChunk *chunk)
+{
+  g_clear_pointer (&chunk->data, ptyxis_search_data_unref);
+  g_clear_pointer (&chunk->rows, g_ptr_array_unref);
+  g_free (chunk);
+}
+
+static void
+ptyxis_search_query_free (PtyxisSearchQuery *query)
+{
+  g_clear_pointer (&query->data, ptyxis_search_data_unref);
+  g_clear_pointer (&query->regex, g_regex_unref);
+  g_clear_pointer (&query->literal, g_free);
+  g_clear_pointer (&query->cursor_text, g_free);
+  g_free (query);
+}
+
+static void
+ptyxis_search_match_clear (gpointer data)
+{
+  PtyxisSearchMatch *match = data;
+
+  g_clear_pointer (&match->text, g_free);
+}
+
+static void
+ptyxis_search_data_add_row_locked (PtyxisSearchData *data,
+                                   char             *text)
+{
+  guint idx;
+  gsize len;
+
+  g_assert (data != NULL);
+  g_assert (text != NULL);
+
+  idx = data->rows->len;
+  len = strlen (text);
+
+  g_ptr_array_add (data->rows, text);
+
+  for (gsize i = 0; i + 3 <= len; i++)
+    {
+      guint trigram = ptyxis_search_index_trigram (&text[i]);
+      GArray *postings;
+
+      if (!(postings = g_hash_table_lookup (data->trigrams, GUINT_TO_POINTER (trigram))))
+        {
+          postings = g_array_new (FALSE, FALSE, sizeof (guint));
+          g_hash_table_insert (data->trigrams, GUINT_TO_POINTER (trigram), postings);
+        }
+
+      /* Rows are added in order so a duplicate is always at the tail */
+      if (postings->len == 0 ||
+          g_array_index (postings, guint, postings->len - 1) != idx)
+        g_array_append_val (postings, idx);
+    }
+}
+
+/* Returns the sorted rows which contain every trigram of @literal */
+static GArray *
+ptyxis_search_data_intersect_locked (PtyxisSearchData *data,
+                                     const char       *literal)
+{
+  GArray *ret = NULL;
+  gsize len;
+
+  g_assert (data != NULL);
+  g_assert (literal != NULL);
+
+  len = strlen (literal);
+
+  for (gsize i = 0; i + 3 <= len; i++)
+    {
+      guint trigram = ptyxis_search_index_trigram (&literal[i]);
+      GArray *postings;
+      guint j = 0;
+      guint k = 0;
+      guint n = 0;
+
+      if (!(postings = g_hash_table_lookup (data->trigrams, GUINT_TO_POINTER (trigram))))
+        {
+          if (ret == NULL)
+            ret = g_array_new (FALSE, FALSE, sizeof (guint));
+          g_array_set_size (ret, 0);
+          break;
+        }
+
+      if (ret == NULL)
+        {
+          ret = g_array_sized_new (FALSE, FALSE, sizeof (guint), postings->len);
+          g_array_append_vals (ret, postings->data, postings->len);
+          continue;
+        }
+
+      while (j < ret->len && k < postings->len)
+        {
+          guint a = g_array_index (ret, guint, j);
+          guint b = g_array_index (postings, guint, k);
+
+          if (a < b)
+            j++;
+          else if (a > b)
+            k++;
+          else
+            {
+              g_array_index (ret, guint, n++) = a;
+              j++;
+              k++;
+            }
+        }
+
+      g_array_set_size (ret, n);
+
+      if (n == 0)
+        break;
+    }
+
+  return ret;
+}
+
+static void
+ptyxis_search_index_reset (PtyxisSearchIndex *self,
+                           gint64             first_row)
+{
+  g_assert (PTYXIS_IS_SEARCH_INDEX (self));
+  g_assert (!self->in_flight);
+
+  /* Queries still running keep their reference to the old rows */
+  g_clear_pointer (&self->data, ptyxis_search_data_unref);
+  self->data = ptyxis_search_data_new (first_row);
+  self->next_row = first_row;
+}
+
+static void
+ptyxis_search_index_add_worker (GTask        *task,
+                                gpointer      source_object,
+                                gpointer      task_data,
+                                GCancellable *cancellable)
+{
+  PtyxisSearchChunk *chunk = task_data;
+  PtyxisSearchData *data;
+
+  g_assert (G_IS_TASK (task));
+  g_assert (PTYXIS_IS_SEARCH_INDEX (source_object));
+  g_assert (chunk != NULL);
+  g_assert (chunk->data != NULL);
+
+  data = chunk->data;
+
+  g_mutex_lock (&data->mutex);
+
+  /* Release the rows which have since left the scrollback */
+  while (data->n_evicted < data->rows->len &&
+         data->first_row + data->n_evicted < chunk->lower_row)
+    g_clear_pointer (&data->rows->pdata[data->n_evicted++], g_free);
+
+  if (data->first_row + data->rows->len == chunk->first_row)
+    {
+      for (guint i = 0; i < chunk->rows->len; i++)
+        ptyxis_search_data_add_row_locked (data, g_steal_pointer (&chunk->rows->pdata[i]));
+    }
+
+  g_mutex_unlock (&data->mutex);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static gboolean ptyxis_search_index_update_cb (gpointer data);
+
+static void
+ptyxis_search_index_add_cb (GObject      *object,
+                            GAsyncResult *result,
+                            gpointer      user_data)
+{
+  PtyxisSearchIndex *self = (PtyxisSearchIndex *)object;
+
+  g_assert (PTYXIS_IS_SEARCH_INDEX (self));
+  g_assert (G_IS_TASK (result));
+
+  self->in_flight = FALSE;
+
+  g_signal_emit (self, signals[CHANGED], 0);
+
+  /* Keep going without delay if there is a backlog of rows to index */
+  if (self->update_source == 0 && self->terminal != NULL)
+    self->update_source = g_idle_add_full (G_PRIORITY_LOW,
+                                           ptyxis_search_index_update_cb,
+                                           self, NULL);
+}
+
+static gboolean
+ptyxis_search_index_update_cb (gpointer data)
+{
+  PtyxisSearchIndex *self = data;
+  g_autoptr(GTask) task = NULL;
+  PtyxisSearchChunk *chunk;
+  glong cursor_row;
+  glong columns;
+  gint64 lower;
+  gint64 end_row;
+
+  g_assert (PTYXIS_IS_SEARCH_INDEX (self));
+
+  self->update_source = 0;
+
+  if (self->terminal == NULL || self->in_flight)
+    return G_SOURCE_REMOVE;
+
+  ptyxis_vte_get_row_bounds (self->terminal, &lower, NULL, NULL);
+  columns = vte_terminal_get_column_count (self->terminal);
+  vte_terminal_get_cursor_position (self->terminal, NULL, &cursor_row);
+
+  /* Start over if the terminal was reset, history was dropped before
+   * we got to it, or most of what we have indexed has since fallen out
+   * of the scrollback.
+   */
+  if (cursor_row < self->next_row ||
+      lower > self->next_row ||
+      lower - self->data->first_row > MAX (cursor_row - lower, CHUNK_ROWS))
+    ptyxis_search_index_reset (self, lower);
+
+  /* Only completed rows are indexed, the cursor row may still change */
+  end_row = MIN (cursor_row, self->next_row + CHUNK_ROWS);
+
+  /* Nothing new to index, but the cursor row may have changed */
+  if (end_row <= self->next_row)
+    {
+      g_signal_emit (self, signals[CHANGED], 0);
+      return G_SOURCE_REMOVE;
+    }
+
+  chunk = g_new0 (PtyxisSearchChunk, 1);
+  chunk->data = g_atomic_rc_box_acquire (self->data);
+  chunk->first_row = self->next_row;
+  chunk->lower_row = lower;
+  chunk->rows = g_ptr_array_new_full (end_row - self->next_row, g_free);
+
+  for (gint64 row = self->next_row; row < end_row; row++)
+    {
+      char *text = vte_terminal_get_text_range_format (self->terminal,
+                                                       VTE_FORMAT_TEXT,
+                                                       row, 0, row, columns,
+                                                       NULL);
+
+      g_ptr_array_add (chunk->rows, text ? g_strchomp (text) : g_strdup (""));
+    }
+
+  self->next_row = end_row;
+  self->in_flight = TRUE;
+
+  task = g_task_new (self, NULL, ptyxis_search_index_add_cb, NULL);
+  g_task_set_source_tag (task, ptyxis_search_index_update_cb);
+  g_task_set_task_data (task, chunk, (GDestroyNotify)ptyxis_search_chunk_free);
+  g_task_run_in_thread (task, ptyxis_search_index_add_worker);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ptyxis_search_index_queue_update (PtyxisSearchIndex *self)
+{
+  g_assert (PTYXIS_IS_SEARCH_INDEX (self));
+
+  if (self->update_source == 0)
+    self->update_source = g_timeout_add_full (G_PRIORITY_LOW,
+                                              UPDATE_DELAY_MSEC,
+                                              ptyxis_search_index_update_cb,
+                                              self, NULL);
+}
+
+static void
+ptyxis_search_index_dispose (GObject *object)
+{
+  PtyxisSearchIndex *self = (PtyxisSearchIndex *)object;
+
+  g_clear_handle_id (&self->update_source, g_source_remove);
+  g_clear_weak_pointer (&self->terminal);
+
+  G_OBJECT_CLASS (ptyxis_search_index_parent_class)->dispose (object);
+}
+
+static void
+ptyxis_search_index_finalize (GObject *object)
+{
+  PtyxisSearchIndex *self = (PtyxisSearchIndex *)object;
+
+  g_clear_pointer (&self->data, ptyxis_search_data_unref);
+
+  G_OBJECT_CLASS (ptyxis_search_index_parent_class)->finalize (object);
+}
+
+static void
+ptyxis_search_index_class_init (PtyxisSearchIndexClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = ptyxis_search_index_dispose;
+  object_class->finalize = ptyxis_search_index_finalize;
+
+  /**
+   * PtyxisSearchIndex::changed:
+   *
+   * Emitted when new rows have been added to the index or the row
+   * containing the cursor may have changed.
+   */
+  signals[CHANGED] =
+    g_signal_new ("changed",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 0);
+}
+
+static void
+ptyxis_search_index_init (PtyxisSearchIndex *self)
+{
+}
+
+/**
+ * ptyxis_search_index_new:
+ * @terminal: a #VteTerminal
+ *
+ * Creates a new index over the scrollback of @terminal.
+ *
+ * Completed rows are extracted in chunks from the main loop and the
+ * index is built from a worker thread, updating as new output arrives.
+ *
+ * Returns: (transfer full): a new #PtyxisSearchIndex
+ */
+PtyxisSearchIndex *
+ptyxis_search_index_new (VteTerminal *terminal)
+{
+  PtyxisSearchIndex *self;
+  gint64 lower;
+
+  g_return_val_if_fail (VTE_IS_TERMINAL (terminal), NULL);
+
+  self = g_object_new (PTYXIS_TYPE_SEARCH_INDEX, NULL);
+  g_set_weak_pointer (&self->terminal, terminal);
+
+  ptyxis_vte_get_row_bounds (terminal, &lower, NULL, NULL);
+  ptyxis_search_index_reset (self, lower);
+
+  g_signal_connect_object (terminal,
+                           "contents-changed",
+                           G_CALLBACK (ptyxis_search_index_queue_update),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  self->update_source = g_idle_add_full (G_PRIORITY_LOW,
+                                         ptyxis_search_index_update_cb,
+                                         self, NULL);
+
+  return self;
+}
+
+static void
+ptyxis_search_query_match_row (PtyxisSearchQuery *query,
+                               GArray            *matches,
+                               gint64             row,
+                               const char        *text)
+{
+  g_autoptr(GMatchInfo) match_info = NULL;
+
+  g_assert (query != NULL);
+  g_assert (matches != NULL);
+  g_assert (text != NULL);
+
+  if (!g_regex_match (query->regex, text, 0, &match_info))
+    return;
+
+  do
+    {
+      PtyxisSearchMatch match;
+      int begin;
+      int end;
+
+      if (!g_match_info_fetch_pos (match_info, 0, &begin, &end))
+        break;
+
+      match.row = row;
+      match.offset = begin;
+      match.length = end - begin;
+      match.text = g_strdup (text);
+
+      g_array_append_val (matches, match);
+    }
+  while (matches->len < MAX_MATCHES &&
+         g_match_info_next (match_info, NULL));
+}
+
+static void
+ptyxis_search_index_query_worker (GTask        *task,
+                                  gpointer      source_object,
+                                  gpointer      task_data,
+                                  GCancellable *cancellable)
+{
+  PtyxisSearchQuery *query = task_data;
+  g_autoptr(GArray) candidates = NULL;
+  g_autoptr(GArray) matches = NULL;
+  PtyxisSearchData *data;
+  guint n_candidates;
+  gint64 end_row;
+
+  g_assert (G_IS_TASK (task));
+  g_assert (PTYXIS_IS_SEARCH_INDEX (source_object));
+  g_assert (query != NULL);
+  g_assert (query->data != NULL);
+  g_assert (query->regex != NULL);
+
+  data = query->data;
+
+  matches = g_array_new (FALSE, FALSE, sizeof (PtyxisSearchMatch));
+  g_array_set_clear_func (matches, ptyxis_search_match_clear);
+
+  g_mutex_lock (&data->mutex);
+
+  /* Without a literal (such as with regular expressions) we have to
+   * check every row, but that still happens off the main thread.
+   */
+  if (query->literal != NULL && strlen (query->literal) >= 3)
+    candidates = ptyxis_search_data_intersect_locked (data, query->literal);
+
+  n_candidates = candidates ? candidates->len : data->rows->len;
+
+  for (guint i = 0; i < n_candidates && matches->len < MAX_MATCHES; i++)
+    {
+      guint idx = candidates ? g_array_index (candidates, guint, i) : i;
+      const char *text = g_ptr_array_index (data->rows, idx);
+
+      if ((i & 0x3ff) == 0 && g_cancellable_is_cancelled (cancellable))
+        break;
+
+      /* Skip rows which have left the scrollback */
+      if (text == NULL || data->first_row + idx < query->lower_row)
+        continue;
+
+      ptyxis_search_query_match_row (query, matches, data->first_row + idx, text);
+    }
+
+  end_row = data->first_row + data->rows->len;
+
+  g_mutex_unlock (&data->mutex);
+
+  /* The cursor row follows whatever has been indexed so far */
+  if (query->cursor_text != NULL &&
+      query->cursor_row >= end_row &&
+      matches->len < MAX_MATCHES)
+    ptyxis_search_query_match_row (query, matches, query->cursor_row, query->cursor_text);
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  g_task_return_pointer (task,
+                         g_steal_pointer (&matches),
+                         (GDestroyNotify)g_array_unref);
+}
+
+/**
+ * ptyxis_search_index_query_async:
+ * @self: a #PtyxisSearchIndex
+ * @regex: the regex to match against each row
+ * @literal: (nullable): a literal which must be contained in matching
+ *   rows, used to narrow the rows checked against @regex
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: a #GAsyncReadyCallback
+ * @user_data: closure data for @callback
+ *
+ * Searches the indexed rows, along with the row containing the cursor,
+ * for @regex from a worker thread. Rows which have left the scrollback
+ * are skipped.
+ */
+void
+ptyxis_search_index_query_async (PtyxisSearchIndex   *self,
+                                 GRegex              *regex,
+                                 const char          *literal,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  g_autoptr(GTask) task = NULL;
+  PtyxisSearchQuery *query;
+
+  g_return_if_fail (PTYXIS_IS_SEARCH_INDEX (self));
+  g_return_if_fail (regex != NULL);
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  query = g_new0 (PtyxisSearchQuery, 1);
+  query->data = g_atomic_rc_box_acquire (self->data);
+  query->regex = g_regex_ref (regex);
+  query->literal = g_strdup (literal);
+  query->lower_row = self->data->first_row;
+
+  if (self->terminal != NULL)
+    {
+      glong cursor_row;
+      char *text;
+
+      ptyxis_vte_get_row_bounds (self->terminal, &query->lower_row, NULL, NULL);
+      vte_terminal_get_cursor_position (self->terminal, NULL, &cursor_row);
+
+      text = vte_terminal_get_text_range_format (self->terminal,
+                                                 VTE_FORMAT_TEXT,
+                                                 cursor_row, 0, cursor_row,
+                                                 vte_terminal_get_column_count (self->terminal),
+                                                 NULL);
+
+      query->cursor_row = cursor_row;
+      query->cursor_text = text ? g_strchomp (text) : NULL;
+    }
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, ptyxis_search_index_query_async);
+  g_task_set_task_data (task, query, (GDestroyNotify)ptyxis_search_query_free);
+  g_task_run_in_thread (task, ptyxis_search_index_query_worker);
+}
+
+/**
+ * ptyxis_search_index_query_finish:
+ * @self: a #PtyxisSearchIndex
+ * @result: a #GAsyncResult
+ * @error: a location for a #GError
+ *
+ * Returns: (transfer full) (element-type PtyxisSearchMatch): an array
+ *   of matches ordered from oldest to newest row
+ */
+GArray *
+ptyxis_search_index_query_finish (PtyxisSearchIndex  *self,
+                                  GAsyncResult       *result,
+                                  GError            **error)
+{
+  g_return_val_if_fail (PTYXIS_IS_SEARCH_INDEX (self), NULL);
+  g_return_val_if_fail (G_IS_TASK (result), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
@@ -0,0 +1,51 @@
+/*
+ * ptyxis-search-index.h
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <vte/vte.h>
+
+G_BEGIN_DECLS
+
+#define PTYXIS_TYPE_SEARCH_INDEX (ptyxis_search_index_get_type())
+
+typedef struct _PtyxisSearchMatch
+{
+  gint64  row;
+  guint   offset;
+  guint   length;
+  char   *text;
+} PtyxisSearchMatch;
+
+G_DECLARE_FINAL_TYPE (PtyxisSearchIndex, ptyxis_search_index, PTYXIS, SEARCH_INDEX, GObject)
+
+PtyxisSearchIndex *ptyxis_search_index_new          (VteTerminal          *terminal);
+void               ptyxis_search_index_query_async  (PtyxisSearchIndex    *self,
+                                                     GRegex               *regex,
+                                                     const char           *literal,
+                                                     GCancellable         *cancellable,
+                                                     GAsyncReadyCallback   callback,
+                                                     gpointer              user_data);
+GArray            *ptyxis_search_index_query_finish (PtyxisSearchIndex    *self,
+                                                     GAsyncResult         *result,
+                                                     GError              **error);
+
+G_END_DECLS
@@ -28,10 +28,50 @@
 #include "ptyxis-settings.h"
 #include "ptyxis-util.h"
 
+/* Values are read from GSettings in one pass and kept until the next
+ * "changed" signal. Many of these are consulted for every new tab and
+ * window so avoid going through the settings backend each time.
+ */
+typedef struct _PtyxisSettingsSnapshot
+{
+  char                         *default_profile_uuid;
+  char                        **profile_uuids;
+  char                         *font_name;
+  char                         *word_char_exceptions;
+  PtyxisNewTabPosition          new_tab_position;
+  VteCursorBlinkMode            cursor_blink_mode;
+  VteCursorShape                cursor_shape;
+  PtyxisScrollbarPolicy         scrollbar_policy;
+  PtyxisTabMiddleClickBehavior  tab_middle_click;
+  VteTextBlinkMode              text_blink_mode;
+  AdwColorScheme                interface_style;
+  guint                         default_columns;
+  guint                         default_rows;
+  guint                         scrollback_budget;
+  guint                         tab_pool_size;
+  guint                         enable_a11y : 1;
+  guint                         audible_bell : 1;
+  guint                         visual_bell : 1;
+  guint                         visual_process_leader : 1;
+  guint                         use_system_font : 1;
+  guint                         restore_session : 1;
+  guint                         restore_window_size : 1;
+  guint                         toast_on_copy_clipboard : 1;
+  guint                         disable_padding : 1;
+  guint                         prompt_on_close : 1;
+  guint                         ignore_osc_title : 1;
+} PtyxisSettingsSnapshot;
+
 struct _PtyxisSettings
 {
-  GObject    parent_instance;
-  GSettings *settings;
+  GObject                 parent_instance;
+  GSettings              *settings;
+  PtyxisSettingsSnapshot *snapshot;
+
+  /* Resolved from the font settings and the system font. Shared by
+   * every terminal so that a font change is only parsed once.
+   */
+  PangoFontDescription   *font_desc;
 };
 
 enum {
@@ -60,6 +100,8 @@ enum {
   PROP_VISUAL_BELL,
   PROP_VISUAL_PROCESS_LEADER,
   PROP_WORD_CHAR_EXCEPTIONS,
+  PROP_SCROLLBACK_BUDGET,
+  PROP_TAB_POOL_SIZE,
   N_PROPS
 };
 
@@ -67,6 +109,65 @@ G_DEFINE_FINAL_TYPE (PtyxisSettings, ptyxis_settings, G_TYPE_OBJECT)
 
 static GParamSpec *properties [N_PROPS];
 
+static void
+ptyxis_settings_snapshot_free (PtyxisSettingsSnapshot *snapshot)
+{
+  g_clear_pointer (&snapshot->default_profile_uuid, g_free);
+  g_clear_pointer (&snapshot->profile_uuids, g_strfreev);
+  g_clear_pointer (&snapshot->font_name, g_free);
+  g_clear_pointer (&snapshot->word_char_exceptions, g_free);
+  g_free (snapshot);
+}
+
+static PtyxisSettingsSnapshot *
+ptyxis_settings_snapshot_new (GSettings *settings)
+{
+  PtyxisSettingsSnapshot *snapshot;
+
+  g_assert (G_IS_SETTINGS (settings));
+
+  snapshot = g_new0 (PtyxisSettingsSnapshot, 1);
+  snapshot->default_profile_uuid = g_settings_get_string (settings, PTYXIS_SETTING_KEY_DEFAULT_PROFILE_UUID);
+  snapshot->profile_uuids = g_settings_get_strv (settings, PTYXIS_SETTING_KEY_PROFILE_UUIDS);
+  snapshot->font_name = g_settings_get_string (settings, PTYXIS_SETTING_KEY_FONT_NAME);
+  g_settings_get (settings, PTYXIS_SETTING_KEY_WORD_CHAR_EXCEPTIONS, "ms", &snapshot->word_char_exceptions);
+  snapshot->new_tab_position = g_settings_get_enum (settings, PTYXIS_SETTING_KEY_NEW_TAB_POSITION);
+  snapshot->cursor_blink_mode = g_settings_get_enum (settings, PTYXIS_SETTING_KEY_CURSOR_BLINK_MODE);
+  snapshot->cursor_shape = g_settings_get_enum (settings, PTYXIS_SETTING_KEY_CURSOR_SHAPE);
+  snapshot->scrollbar_policy = g_settings_get_enum (settings, PTYXIS_SETTING_KEY_SCROLLBAR_POLICY);
+  snapshot->tab_middle_click = g_settings_get_enum (settings, PTYXIS_SETTING_KEY_TAB_MIDDLE_CLICK);
+  snapshot->text_blink_mode = g_settings_get_enum (settings, PTYXIS_SETTING_KEY_TEXT_BLINK_MODE);
+  snapshot->interface_style = g_settings_get_enum (settings, PTYXIS_SETTING_KEY_INTERFACE_STYLE);
+  snapshot->default_columns = g_settings_get_uint (settings, PTYXIS_SETTING_KEY_DEFAULT_COLUMNS);
+  snapshot->default_rows = g_settings_get_uint (settings, PTYXIS_SETTING_KEY_DEFAULT_ROWS);
+  snapshot->scrollback_budget = g_settings_get_uint (settings, PTYXIS_SETTING_KEY_SCROLLBACK_BUDGET);
+  snapshot->tab_pool_size = g_settings_get_uint (settings, PTYXIS_SETTING_KEY_TAB_POOL_SIZE);
+  snapshot->enable_a11y = g_settings_get_boolean (settings, PTYXIS_SETTING_KEY_ENABLE_A11Y);
+  snapshot->audible_bell = g_settings_get_boolean (settings, PTYXIS_SETTING_KEY_AUDIBLE_BELL);
+  snapshot->visual_bell = g_settings_get_boolean (settings, PTYXIS_SETTING_KEY_VISUAL_BELL);
+  snapshot->visual_process_leader = g_settings_get_boolean (settings, PTYXIS_SETTING_KEY_VISUAL_PROCESS_LEADER);
+  snapshot->use_system_font = g_settings_get_boolean (settings, PTYXIS_SETTING_KEY_USE_SYSTEM_FONT);
+  snapshot->restore_session = g_settings_get_boolean (settings, PTYXIS_SETTING_KEY_RESTORE_SESSION);
+  snapshot->restore_window_size = g_settings_get_boolean (settings, PTYXIS_SETTING_KEY_RESTORE_WINDOW_SIZE);
+  snapshot->toast_on_copy_clipboard = g_settings_get_boolean (settings, PTYXIS_SETTING_KEY_TOAST_ON_COPY_CLIPBOARD);
+  snapshot->disable_padding = g_settings_get_boolean (settings, PTYXIS_SETTING_KEY_DISABLE_PADDING);
+  snapshot->prompt_on_close = g_settings_get_boolean (settings, PTYXIS_SETTING_KEY_PROMPT_ON_CLOSE);
+  snapshot->ignore_osc_title = g_settings_get_boolean (settings, PTYXIS_SETTING_KEY_IGNORE_OSC_TITLE);
+
+  return snapshot;
+}
+
+static inline const PtyxisSettingsSnapshot *
+ptyxis_settings_get_snapshot (PtyxisSettings *self)
+{
+  g_assert (PTYXIS_IS_SETTINGS (self));
+
+  if G_UNLIKELY (self->snapshot == NULL)
+    self->snapshot = ptyxis_settings_snapshot_new (self->settings);
+
+  return self->snapshot;
+}
+
 static void
 ptyxis_settings_changed_cb (PtyxisSettings *self,
                             const char     *key,
@@ -76,6 +177,9 @@ ptyxis_settings_changed_cb (PtyxisSettings *self,
   g_assert (key != NULL);
   g_assert (G_IS_SETTINGS (settings));
 
+  /* Rebuilt lazily so a batch of changes costs a single pass */
+  g_clear_pointer (&self->snapshot, ptyxis_settings_snapshot_free);
+
   if (g_str_equal (key, PTYXIS_SETTING_KEY_DEFAULT_PROFILE_UUID))
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_DEFAULT_PROFILE_UUID]);
   else if (g_str_equal (key, PTYXIS_SETTING_KEY_DISABLE_PADDING))
@@ -118,16 +222,37 @@ ptyxis_settings_changed_cb (PtyxisSettings *self,
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_IGNORE_OSC_TITLE]);
   else if (g_str_equal (key, PTYXIS_SETTING_KEY_FONT_NAME))
     {
+      g_clear_pointer (&self->font_desc, pango_font_description_free);
       g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FONT_NAME]);
       g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FONT_DESC]);
     }
   else if (g_str_equal (key, PTYXIS_SETTING_KEY_USE_SYSTEM_FONT))
     {
+      g_clear_pointer (&self->font_desc, pango_font_description_free);
       g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_USE_SYSTEM_FONT]);
       g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FONT_DESC]);
     }
   else if (g_str_equal (key, PTYXIS_SETTING_KEY_WORD_CHAR_EXCEPTIONS))
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_WORD_CHAR_EXCEPTIONS]);
+  else if (g_str_equal (key, PTYXIS_SETTING_KEY_SCROLLBACK_BUDGET))
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SCROLLBACK_BUDGET]);
+  else if (g_str_equal (key, PTYXIS_SETTING_KEY_TAB_POOL_SIZE))
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TAB_POOL_SIZE]);
+}
+
+static void
+ptyxis_settings_notify_system_font_name_cb (PtyxisSettings    *self,
+                                            GParamSpec        *pspec,
+                                            PtyxisApplication *app)
+{
+  g_assert (PTYXIS_IS_SETTINGS (self));
+  g_assert (PTYXIS_IS_APPLICATION (app));
+
+  g_clear_pointer (&self->font_desc, pango_font_description_free);
+
+  if (ptyxis_settings_get_use_system_font (self) ||
+      ptyxis_str_empty0 (ptyxis_settings_get_snapshot (self)->font_name))
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FONT_DESC]);
 }
 
 static void
@@ -136,6 +261,8 @@ ptyxis_settings_dispose (GObject *object)
   PtyxisSettings *self = (PtyxisSettings *)object;
 
   g_clear_object (&self->settings);
+  g_clear_pointer (&self->snapshot, ptyxis_settings_snapshot_free);
+  g_clear_pointer (&self->font_desc, pango_font_description_free);
 
   G_OBJECT_CLASS (ptyxis_settings_parent_class)->dispose (object);
 }
@@ -242,6 +369,14 @@ ptyxis_settings_get_property (GObject    *object,
       g_value_set_boolean (value, ptyxis_settings_get_visual_process_leader (self));
       break;
 
+    case PROP_SCROLLBACK_BUDGET:
+      g_value_set_uint (value, ptyxis_settings_get_scrollback_budget (self));
+      break;
+
+    case PROP_TAB_POOL_SIZE:
+      g_value_set_uint (value, ptyxis_settings_get_tab_pool_size (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -345,6 +480,14 @@ ptyxis_settings_set_property (GObject      *object,
       ptyxis_settings_set_visual_process_leader (self, g_value_get_boolean (value));
       break;
 
+    case PROP_SCROLLBACK_BUDGET:
+      ptyxis_settings_set_scrollback_budget (self, g_value_get_uint (value));
+      break;
+
+    case PROP_TAB_POOL_SIZE:
+      ptyxis_settings_set_tab_pool_size (self, g_value_get_uint (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -533,6 +676,20 @@ ptyxis_settings_class_init (PtyxisSettingsClass *klass)
                           G_PARAM_EXPLICIT_NOTIFY |
                           G_PARAM_STATIC_STRINGS));
 
+  properties[PROP_SCROLLBACK_BUDGET] =
+    g_param_spec_uint (PTYXIS_SETTING_KEY_SCROLLBACK_BUDGET, NULL, NULL,
+                       0, G_MAXUINT, 0,
+                       (G_PARAM_READWRITE |
+                        G_PARAM_EXPLICIT_NOTIFY |
+                        G_PARAM_STATIC_STRINGS));
+
+  properties[PROP_TAB_POOL_SIZE] =
+    g_param_spec_uint (PTYXIS_SETTING_KEY_TAB_POOL_SIZE, NULL, NULL,
+                       0, 8, 1,
+                       (G_PARAM_READWRITE |
+                        G_PARAM_EXPLICIT_NOTIFY |
+                        G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_properties (object_class, N_PROPS, properties);
 }
 
@@ -546,6 +703,15 @@ ptyxis_settings_init (PtyxisSettings *self)
                            G_CALLBACK (ptyxis_settings_changed_cb),
                            self,
                            G_CONNECT_SWAPPED);
+
+  self->snapshot = ptyxis_settings_snapshot_new (self->settings);
+
+  if (PTYXIS_APPLICATION_DEFAULT != NULL)
+    g_signal_connect_object (PTYXIS_APPLICATION_DEFAULT,
+                             "notify::system-font-name",
+                             G_CALLBACK (ptyxis_settings_notify_system_font_name_cb),
+                             self,
+                             G_CONNECT_SWAPPED);
 }
 
 PtyxisSettings *
@@ -571,8 +737,7 @@ ptyxis_settings_dup_default_profile_uuid (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), NULL);
 
-  return g_settings_get_string (self->settings,
-                                PTYXIS_SETTING_KEY_DEFAULT_PROFILE_UUID);
+  return g_strdup (ptyxis_settings_get_snapshot (self)->default_profile_uuid);
 }
 
 char **
@@ -580,8 +745,7 @@ ptyxis_settings_dup_profile_uuids (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), NULL);
 
-  return g_settings_get_strv (self->settings,
-                              PTYXIS_SETTING_KEY_PROFILE_UUIDS);
+  return g_strdupv (ptyxis_settings_get_snapshot (self)->profile_uuids);
 }
 
 void
@@ -659,7 +823,7 @@ ptyxis_settings_get_new_tab_position (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_SETTING_KEY_NEW_TAB_POSITION);
+  return ptyxis_settings_get_snapshot (self)->new_tab_position;
 }
 
 void
@@ -686,7 +850,7 @@ ptyxis_settings_get_enable_a11y (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_SETTING_KEY_ENABLE_A11Y);
+  return ptyxis_settings_get_snapshot (self)->enable_a11y;
 }
 
 void
@@ -705,7 +869,7 @@ ptyxis_settings_get_audible_bell (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_SETTING_KEY_AUDIBLE_BELL);
+  return ptyxis_settings_get_snapshot (self)->audible_bell;
 }
 
 void
@@ -724,7 +888,7 @@ ptyxis_settings_get_visual_bell (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_SETTING_KEY_VISUAL_BELL);
+  return ptyxis_settings_get_snapshot (self)->visual_bell;
 }
 
 void
@@ -743,7 +907,7 @@ ptyxis_settings_get_visual_process_leader (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_SETTING_KEY_VISUAL_PROCESS_LEADER);
+  return ptyxis_settings_get_snapshot (self)->visual_process_leader;
 }
 
 void
@@ -762,7 +926,7 @@ ptyxis_settings_get_cursor_blink_mode (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_SETTING_KEY_CURSOR_BLINK_MODE);
+  return ptyxis_settings_get_snapshot (self)->cursor_blink_mode;
 }
 
 void
@@ -781,7 +945,7 @@ ptyxis_settings_get_cursor_shape (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_SETTING_KEY_CURSOR_SHAPE);
+  return ptyxis_settings_get_snapshot (self)->cursor_shape;
 }
 
 void
@@ -800,7 +964,7 @@ ptyxis_settings_dup_font_name (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), NULL);
 
-  return g_settings_get_string (self->settings, PTYXIS_SETTING_KEY_FONT_NAME);
+  return g_strdup (ptyxis_settings_get_snapshot (self)->font_name);
 }
 
 void
@@ -820,7 +984,7 @@ ptyxis_settings_get_use_system_font (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_SETTING_KEY_USE_SYSTEM_FONT);
+  return ptyxis_settings_get_snapshot (self)->use_system_font;
 }
 
 void
@@ -832,24 +996,44 @@ ptyxis_settings_set_use_system_font (PtyxisSettings *self,
   g_settings_set_boolean (self->settings, PTYXIS_SETTING_KEY_USE_SYSTEM_FONT, use_system_font);
 }
 
-PangoFontDescription *
-ptyxis_settings_dup_font_desc (PtyxisSettings *self)
+/**
+ * ptyxis_settings_get_font_desc:
+ * @self: a #PtyxisSettings
+ *
+ * Gets the font to use for terminals, taking the system font into
+ * account.
+ *
+ * The result is cached until the font settings change so that many
+ * terminals may share it.
+ *
+ * Returns: (transfer none): a #PangoFontDescription
+ */
+const PangoFontDescription *
+ptyxis_settings_get_font_desc (PtyxisSettings *self)
 {
-  PtyxisApplication *app;
-  g_autofree char *font_name = NULL;
-  const char *system_font_name;
+  const char *font_name;
 
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), NULL);
 
-  app = PTYXIS_APPLICATION_DEFAULT;
-  system_font_name = ptyxis_application_get_system_font_name (app);
+  if (self->font_desc == NULL)
+    {
+      font_name = ptyxis_settings_get_snapshot (self)->font_name;
 
-  if (ptyxis_settings_get_use_system_font (self) ||
-      !(font_name = ptyxis_settings_dup_font_name (self)) ||
-      ptyxis_str_empty0 (font_name))
-    return pango_font_description_from_string (system_font_name);
+      if (ptyxis_settings_get_use_system_font (self) || ptyxis_str_empty0 (font_name))
+        font_name = ptyxis_application_get_system_font_name (PTYXIS_APPLICATION_DEFAULT);
 
-  return pango_font_description_from_string (font_name);
+      self->font_desc = pango_font_description_from_string (font_name);
+    }
+
+  return self->font_desc;
+}
+
+PangoFontDescription *
+ptyxis_settings_dup_font_desc (PtyxisSettings *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), NULL);
+
+  return pango_font_description_copy (ptyxis_settings_get_font_desc (self));
 }
 
 void
@@ -871,7 +1055,7 @@ ptyxis_settings_get_scrollbar_policy (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_SETTING_KEY_SCROLLBAR_POLICY);
+  return ptyxis_settings_get_snapshot (self)->scrollbar_policy;
 }
 
 void
@@ -890,7 +1074,7 @@ ptyxis_settings_get_tab_middle_click (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_SETTING_KEY_TAB_MIDDLE_CLICK);
+  return ptyxis_settings_get_snapshot (self)->tab_middle_click;
 }
 
 void
@@ -909,7 +1093,7 @@ ptyxis_settings_get_text_blink_mode (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_SETTING_KEY_TEXT_BLINK_MODE);
+  return ptyxis_settings_get_snapshot (self)->text_blink_mode;
 }
 
 void
@@ -928,7 +1112,7 @@ ptyxis_settings_get_restore_session (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_SETTING_KEY_RESTORE_SESSION);
+  return ptyxis_settings_get_snapshot (self)->restore_session;
 }
 
 void
@@ -947,7 +1131,7 @@ ptyxis_settings_get_restore_window_size (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_SETTING_KEY_RESTORE_WINDOW_SIZE);
+  return ptyxis_settings_get_snapshot (self)->restore_window_size;
 }
 
 void
@@ -980,7 +1164,7 @@ ptyxis_settings_get_default_columns (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), 0);
 
-  return g_settings_get_uint (self->settings, PTYXIS_SETTING_KEY_DEFAULT_COLUMNS);
+  return ptyxis_settings_get_snapshot (self)->default_columns;
 }
 
 guint
@@ -988,7 +1172,7 @@ ptyxis_settings_get_default_rows (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), 0);
 
-  return g_settings_get_uint (self->settings, PTYXIS_SETTING_KEY_DEFAULT_ROWS);
+  return ptyxis_settings_get_snapshot (self)->default_rows;
 }
 
 void
@@ -1040,7 +1224,7 @@ ptyxis_settings_get_interface_style (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), 0);
 
-  return g_settings_get_enum (self->settings, PTYXIS_SETTING_KEY_INTERFACE_STYLE);
+  return ptyxis_settings_get_snapshot (self)->interface_style;
 }
 
 void
@@ -1060,7 +1244,7 @@ ptyxis_settings_get_toast_on_copy_clipboard (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), FALSE);
 
-  return g_settings_get_boolean (self->settings, PTYXIS_SETTING_KEY_TOAST_ON_COPY_CLIPBOARD);
+  return ptyxis_settings_get_snapshot (self)->toast_on_copy_clipboard;
 }
 
 void
@@ -1090,19 +1274,15 @@ ptyxis_settings_get_disable_padding (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), FALSE);
 
-  return g_settings_get_boolean (self->settings,
-                                 PTYXIS_SETTING_KEY_DISABLE_PADDING);
+  return ptyxis_settings_get_snapshot (self)->disable_padding;
 }
 
 char *
 ptyxis_settings_dup_word_char_exceptions (PtyxisSettings *self)
 {
-  char *word_char_exceptions;
-
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), NULL);
 
-  g_settings_get (self->settings, PTYXIS_SETTING_KEY_WORD_CHAR_EXCEPTIONS, "ms", &word_char_exceptions);
-  return word_char_exceptions;
+  return g_strdup (ptyxis_settings_get_snapshot (self)->word_char_exceptions);
 }
 
 void
@@ -1121,8 +1301,7 @@ ptyxis_settings_get_prompt_on_close (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), FALSE);
 
-  return g_settings_get_boolean (self->settings,
-                                 PTYXIS_SETTING_KEY_PROMPT_ON_CLOSE);
+  return ptyxis_settings_get_snapshot (self)->prompt_on_close;
 }
 
 void
@@ -1141,6 +1320,43 @@ ptyxis_settings_get_ignore_osc_title (PtyxisSettings *self)
 {
   g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), FALSE);
 
-  return g_settings_get_boolean (self->settings,
-                                 PTYXIS_SETTING_KEY_IGNORE_OSC_TITLE);
+  return ptyxis_settings_get_snapshot (self)->ignore_osc_title;
+}
+
+guint
+ptyxis_settings_get_scrollback_budget (PtyxisSettings *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), 0);
+
+  return ptyxis_settings_get_snapshot (self)->scrollback_budget;
+}
+
+void
+ptyxis_settings_set_scrollback_budget (PtyxisSettings *self,
+                                       guint          scrollback_budget)
+{
+  g_return_if_fail (PTYXIS_IS_SETTINGS (self));
+
+  g_settings_set_uint (self->settings,
+                       PTYXIS_SETTING_KEY_SCROLLBACK_BUDGET,
+                       scrollback_budget);
+}
+
+guint
+ptyxis_settings_get_tab_pool_size (PtyxisSettings *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_SETTINGS (self), 0);
+
+  return ptyxis_settings_get_snapshot (self)->tab_pool_size;
+}
+
+void
+ptyxis_settings_set_tab_pool_size (PtyxisSettings *self,
+                                   guint           tab_pool_size)
+{
+  g_return_if_fail (PTYXIS_IS_SETTINGS (self));
+
+  g_settings_set_uint (self->settings,
+                       PTYXIS_SETTING_KEY_TAB_POOL_SIZE,
+                       tab_pool_size);
 }
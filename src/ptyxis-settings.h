@@ -50,6 +50,8 @@ G_BEGIN_DECLS
 #define PTYXIS_SETTING_KEY_WORD_CHAR_EXCEPTIONS    "word-char-exceptions"
 #define PTYXIS_SETTING_KEY_TAB_MIDDLE_CLICK        "tab-middle-click"
 #define PTYXIS_SETTING_KEY_IGNORE_OSC_TITLE        "ignore-osc-title"
+#define PTYXIS_SETTING_KEY_SCROLLBACK_BUDGET       "scrollback-budget"
+#define PTYXIS_SETTING_KEY_TAB_POOL_SIZE           "tab-pool-size"
 
 typedef enum _PtyxisNewTabPosition
 {
@@ -114,6 +116,7 @@ void                    ptyxis_settings_set_cursor_blink_mode       (PtyxisSetti
 VteCursorShape          ptyxis_settings_get_cursor_shape            (PtyxisSettings             *self);
 void                    ptyxis_settings_set_cursor_shape            (PtyxisSettings             *self,
                                                                      VteCursorShape              cursor_shape);
+const PangoFontDescription *ptyxis_settings_get_font_desc           (PtyxisSettings             *self);
 PangoFontDescription   *ptyxis_settings_dup_font_desc               (PtyxisSettings             *self);
 void                    ptyxis_settings_set_font_desc               (PtyxisSettings             *self,
                                                                      const PangoFontDescription *font_desc);
@@ -169,5 +172,11 @@ void                    ptyxis_settings_set_prompt_on_close         (PtyxisSetti
 gboolean                ptyxis_settings_get_ignore_osc_title        (PtyxisSettings             *self);
 void                    ptyxis_settings_set_ignore_osc_title        (PtyxisSettings             *self,
                                                                      gboolean                    ignore_osc_title);
+guint                   ptyxis_settings_get_scrollback_budget       (PtyxisSettings             *self);
+void                    ptyxis_settings_set_scrollback_budget       (PtyxisSettings             *self,
+                                                                     guint                       scrollback_budget);
+guint                   ptyxis_settings_get_tab_pool_size           (PtyxisSettings             *self);
+void                    ptyxis_settings_set_tab_pool_size           (PtyxisSettings             *self,
+                                                                     guint                       tab_pool_size);
 
 G_END_DECLS
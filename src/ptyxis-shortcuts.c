@@ -28,6 +28,12 @@ struct _PtyxisShortcuts
 {
   GObject    parent_instance;
   GSettings *settings;
+
+  /* Accelerators indexed by property id. Read from GSettings in one
+   * pass and kept until the next "changed" so that every window and
+   * terminal shares the same table.
+   */
+  char     **accels;
 };
 
 enum {
@@ -43,14 +49,59 @@ G_DEFINE_FINAL_TYPE (PtyxisShortcuts, ptyxis_shortcuts, G_TYPE_OBJECT)
 
 static GParamSpec *properties[N_PROPS];
 
+/* Triggers are immutable, so each accelerator string is only parsed
+ * once no matter how many shortcut controllers bind to it.
+ */
+static GHashTable *triggers;
+
 static void
 transform_string_to_trigger (const GValue *src_value,
                              GValue       *dest_value)
 {
   const char *str = g_value_get_string (src_value);
+  GtkShortcutTrigger *trigger;
+
+  if (str == NULL || str[0] == 0)
+    return;
+
+  if (triggers == NULL)
+    triggers = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+
+  if (!(trigger = g_hash_table_lookup (triggers, str)))
+    {
+      if (!(trigger = gtk_shortcut_trigger_parse_string (str)))
+        return;
+
+      g_hash_table_insert (triggers, g_strdup (str), trigger);
+    }
+
+  g_value_set_object (dest_value, trigger);
+}
+
+static void
+ptyxis_shortcuts_accels_free (char **accels)
+{
+  for (guint i = 0; i < N_PROPS; i++)
+    g_free (accels[i]);
+  g_free (accels);
+}
+
+static const char * const *
+ptyxis_shortcuts_get_accels (PtyxisShortcuts *self)
+{
+  g_assert (PTYXIS_IS_SHORTCUTS (self));
 
-  if (str != NULL && str[0] != 0)
-    g_value_take_object (dest_value, gtk_shortcut_trigger_parse_string (str));
+  if G_UNLIKELY (self->accels == NULL)
+    {
+      self->accels = g_new0 (char *, N_PROPS);
+
+#define PTYXIS_SHORTCUT_DEFINE(NAME, name) \
+      self->accels[PROP_##NAME] = g_settings_get_string (self->settings, name);
+# include "ptyxis-shortcuts.defs"
+#undef PTYXIS_SHORTCUT_DEFINE
+    }
+
+  return (const char * const *)self->accels;
 }
 
 static void
@@ -62,6 +113,9 @@ ptyxis_shortcuts_settings_changed_cb (PtyxisShortcuts *self,
   g_assert (key != NULL);
   g_assert (G_IS_SETTINGS (settings));
 
+  /* Rebuilt lazily so a batch of changes costs a single pass */
+  g_clear_pointer (&self->accels, ptyxis_shortcuts_accels_free);
+
   g_object_notify (G_OBJECT (self), key);
 }
 
@@ -90,6 +144,7 @@ ptyxis_shortcuts_dispose (GObject *object)
   PtyxisShortcuts *self = (PtyxisShortcuts *)object;
 
   g_clear_object (&self->settings);
+  g_clear_pointer (&self->accels, ptyxis_shortcuts_accels_free);
 
   G_OBJECT_CLASS (ptyxis_shortcuts_parent_class)->dispose (object);
 }
@@ -110,7 +165,7 @@ ptyxis_shortcuts_get_property (GObject    *object,
 
 #define PTYXIS_SHORTCUT_DEFINE(NAME, name) \
     case PROP_##NAME: \
-      g_value_take_string (value, g_settings_get_string (self->settings, name)); \
+      g_value_set_string (value, ptyxis_shortcuts_get_accels (self)[PROP_##NAME]); \
       break;
 # include "ptyxis-shortcuts.defs"
 #undef PTYXIS_SHORTCUT_DEFINE
@@ -289,11 +344,15 @@ ptyxis_shortcuts_replace_key (GMenu      *menu,
  *
  * Will recursively dive into @menu and update the accel
  * property for that item so it shows up in GtkPopoverMenu.
+ *
+ * Items whose accel is already current are left untouched so that
+ * menus shared between windows are not rebuilt needlessly.
  */
 void
 ptyxis_shortcuts_update_menu (PtyxisShortcuts *self,
                               GMenu           *menu)
 {
+  const char * const *accels;
   GObjectClass *klass;
   guint n_items;
 
@@ -303,6 +362,7 @@ ptyxis_shortcuts_update_menu (PtyxisShortcuts *self,
   if (menu == NULL)
     return;
 
+  accels = ptyxis_shortcuts_get_accels (self);
   klass = G_OBJECT_GET_CLASS (self);
   n_items = g_menu_model_get_n_items (G_MENU_MODEL (menu));
 
@@ -325,8 +385,13 @@ ptyxis_shortcuts_update_menu (PtyxisShortcuts *self,
       if ((pspec = g_object_class_find_property (klass, id)) &&
           G_IS_PARAM_SPEC_STRING (pspec))
         {
-          g_autofree char *accel = NULL;
-          g_object_get (G_OBJECT (self), id, &accel, NULL);
+          const char *accel = accels[pspec->param_id];
+          g_autofree char *current = NULL;
+
+          if (g_menu_model_get_item_attribute (G_MENU_MODEL (menu), i, "accel", "s", &current) &&
+              g_strcmp0 (current, accel ? accel : "") == 0)
+            continue;
+
           ptyxis_shortcuts_replace_key (menu, i, "accel", accel);
         }
     }
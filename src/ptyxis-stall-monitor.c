@@ -0,0 +1,455 @@
+/*
+ * ptyxis-stall-monitor.c
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include <pthread.h>
+#include <signal.h>
+
+#ifdef HAVE_BACKTRACE
+# include <execinfo.h>
+#endif
+
+#include "ptyxis-stall-monitor.h"
+
+#define MAX_STALLS  32
+#define MAX_FRAMES  64
+#define SKIP_FRAMES 2
+
+typedef struct _PtyxisStall
+{
+  GList   link;
+  gint64  begin;
+  gint64  duration;
+  char   *stack;
+} PtyxisStall;
+
+struct _PtyxisStallMonitor
+{
+  GObject       parent_instance;
+
+  /* Only accessed from the main thread */
+  GMainContext *context;
+  GPollFunc     poll_func;
+  GQueue        stalls;
+  guint64       n_stalls;
+  gint64        longest;
+  gint64        threshold;
+  guint         notify_source;
+  pthread_t     main_thread;
+
+  /* Written from the signal handler which runs on the main thread */
+  void         *frames[MAX_FRAMES];
+  int           n_frames;
+
+  /* Shared with the watchdog thread */
+  GMutex        mutex;
+  GCond         cond;
+  GThread      *watchdog;
+  gint64        dispatch_begin;
+  guint64       iteration;
+  guint64       sampled;
+  guint         shutdown : 1;
+};
+
+enum {
+  PROP_0,
+  PROP_LONGEST,
+  PROP_N_STALLS,
+  N_PROPS
+};
+
+G_DEFINE_FINAL_TYPE (PtyxisStallMonitor, ptyxis_stall_monitor, G_TYPE_OBJECT)
+
+static GParamSpec *properties [N_PROPS];
+static PtyxisStallMonitor *the_monitor;
+
+static void
+ptyxis_stall_free (PtyxisStall *stall)
+{
+  g_clear_pointer (&stall->stack, g_free);
+  g_free (stall);
+}
+
+#ifdef HAVE_BACKTRACE
+static void
+ptyxis_stall_monitor_signal_handler (int signum)
+{
+  /* Runs on the main thread while it is stalled */
+  if (the_monitor != NULL)
+    the_monitor->n_frames = backtrace (the_monitor->frames, MAX_FRAMES);
+}
+#endif
+
+static gboolean
+ptyxis_stall_monitor_notify_cb (gpointer data)
+{
+  PtyxisStallMonitor *self = data;
+
+  g_assert (PTYXIS_IS_STALL_MONITOR (self));
+
+  self->notify_source = 0;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_STALLS]);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LONGEST]);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ptyxis_stall_monitor_record (PtyxisStallMonitor *self,
+                             gint64              begin,
+                             gint64              duration)
+{
+  PtyxisStall *stall;
+
+  g_assert (PTYXIS_IS_STALL_MONITOR (self));
+
+  stall = g_new0 (PtyxisStall, 1);
+  stall->link.data = stall;
+  stall->begin = begin;
+  stall->duration = duration;
+
+#ifdef HAVE_BACKTRACE
+  if (self->n_frames > SKIP_FRAMES)
+    {
+      g_autofree char **symbols = NULL;
+      GString *str = g_string_new (NULL);
+
+      symbols = backtrace_symbols (&self->frames[SKIP_FRAMES], self->n_frames - SKIP_FRAMES);
+
+      for (int i = 0; symbols != NULL && i < self->n_frames - SKIP_FRAMES; i++)
+        g_string_append_printf (str, "  #%d %s\n", i, symbols[i]);
+
+      stall->stack = g_string_free (str, FALSE);
+    }
+#endif
+
+  self->n_frames = 0;
+
+  g_warning ("Main loop stalled for %.1lf msec%s%s",
+             duration / 1000.,
+             stall->stack ? "\n" : "",
+             stall->stack ? stall->stack : "");
+
+  g_queue_push_tail_link (&self->stalls, &stall->link);
+
+  while (self->stalls.length > MAX_STALLS)
+    {
+      PtyxisStall *oldest = g_queue_peek_head (&self->stalls);
+
+      g_queue_unlink (&self->stalls, &oldest->link);
+      ptyxis_stall_free (oldest);
+    }
+
+  self->n_stalls++;
+  self->longest = MAX (self->longest, duration);
+
+  /* We are inside the poll function, so defer notifying to a point
+   * where it is safe for handlers to update widgets.
+   */
+  if (self->notify_source == 0)
+    self->notify_source = g_idle_add_full (G_PRIORITY_LOW,
+                                           ptyxis_stall_monitor_notify_cb,
+                                           self, NULL);
+}
+
+/* Everything between returning from poll() and entering it again is
+ * the check and dispatch phase of a main loop iteration.
+ */
+static int
+ptyxis_stall_monitor_poll (GPollFD *fds,
+                           guint    nfds,
+                           int      timeout)
+{
+  PtyxisStallMonitor *self = the_monitor;
+  gint64 now = g_get_monotonic_time ();
+  gint64 begin;
+  int ret;
+
+  g_mutex_lock (&self->mutex);
+  begin = self->dispatch_begin;
+  self->dispatch_begin = 0;
+  g_mutex_unlock (&self->mutex);
+
+  if (begin != 0 && now - begin >= self->threshold)
+    ptyxis_stall_monitor_record (self, begin, now - begin);
+  else
+    self->n_frames = 0;
+
+  ret = self->poll_func (fds, nfds, timeout);
+
+  g_mutex_lock (&self->mutex);
+  self->dispatch_begin = g_get_monotonic_time ();
+  self->iteration++;
+  g_cond_signal (&self->cond);
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
+
+static gpointer
+ptyxis_stall_monitor_watchdog (gpointer data)
+{
+  PtyxisStallMonitor *self = data;
+
+  g_mutex_lock (&self->mutex);
+
+  while (!self->shutdown)
+    {
+      gint64 deadline;
+
+      if (self->dispatch_begin == 0 || self->sampled == self->iteration)
+        {
+          g_cond_wait (&self->cond, &self->mutex);
+          continue;
+        }
+
+      deadline = self->dispatch_begin + self->threshold;
+
+      if (g_get_monotonic_time () < deadline)
+        {
+          g_cond_wait_until (&self->cond, &self->mutex, deadline);
+          continue;
+        }
+
+      /* Still within the same dispatch past the threshold, so ask the
+       * main thread to record where it is currently stuck.
+       */
+      self->sampled = self->iteration;
+
+#ifdef HAVE_BACKTRACE
+      pthread_kill (self->main_thread, SIGPROF);
+#endif
+    }
+
+  g_mutex_unlock (&self->mutex);
+
+  return NULL;
+}
+
+static void
+ptyxis_stall_monitor_dispose (GObject *object)
+{
+  PtyxisStallMonitor *self = (PtyxisStallMonitor *)object;
+
+  if (self->watchdog != NULL)
+    {
+      g_mutex_lock (&self->mutex);
+      self->shutdown = TRUE;
+      g_cond_signal (&self->cond);
+      g_mutex_unlock (&self->mutex);
+
+      g_clear_pointer (&self->watchdog, g_thread_join);
+    }
+
+  if (self->context != NULL)
+    {
+      g_main_context_set_poll_func (self->context, self->poll_func);
+      g_clear_pointer (&self->context, g_main_context_unref);
+    }
+
+#ifdef HAVE_BACKTRACE
+  signal (SIGPROF, SIG_DFL);
+#endif
+
+  if (the_monitor == self)
+    the_monitor = NULL;
+
+  g_clear_handle_id (&self->notify_source, g_source_remove);
+
+  while (self->stalls.head != NULL)
+    {
+      PtyxisStall *stall = self->stalls.head->data;
+
+      g_queue_unlink (&self->stalls, &stall->link);
+      ptyxis_stall_free (stall);
+    }
+
+  G_OBJECT_CLASS (ptyxis_stall_monitor_parent_class)->dispose (object);
+}
+
+static void
+ptyxis_stall_monitor_finalize (GObject *object)
+{
+  PtyxisStallMonitor *self = (PtyxisStallMonitor *)object;
+
+  g_mutex_clear (&self->mutex);
+  g_cond_clear (&self->cond);
+
+  G_OBJECT_CLASS (ptyxis_stall_monitor_parent_class)->finalize (object);
+}
+
+static void
+ptyxis_stall_monitor_get_property (GObject    *object,
+                                   guint       prop_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  PtyxisStallMonitor *self = PTYXIS_STALL_MONITOR (object);
+
+  switch (prop_id)
+    {
+    case PROP_LONGEST:
+      g_value_set_int64 (value, self->longest);
+      break;
+
+    case PROP_N_STALLS:
+      g_value_set_uint64 (value, self->n_stalls);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+ptyxis_stall_monitor_class_init (PtyxisStallMonitorClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = ptyxis_stall_monitor_dispose;
+  object_class->finalize = ptyxis_stall_monitor_finalize;
+  object_class->get_property = ptyxis_stall_monitor_get_property;
+
+  properties[PROP_LONGEST] =
+    g_param_spec_int64 ("longest", NULL, NULL,
+                        0, G_MAXINT64, 0,
+                        (G_PARAM_READABLE |
+                         G_PARAM_EXPLICIT_NOTIFY |
+                         G_PARAM_STATIC_STRINGS));
+
+  properties[PROP_N_STALLS] =
+    g_param_spec_uint64 ("n-stalls", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE |
+                          G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+}
+
+static void
+ptyxis_stall_monitor_init (PtyxisStallMonitor *self)
+{
+  g_mutex_init (&self->mutex);
+  g_cond_init (&self->cond);
+}
+
+/**
+ * ptyxis_stall_monitor_new:
+ * @threshold_msec: the dispatch duration considered a stall
+ *
+ * Creates a new stall monitor for the default main context.
+ *
+ * Any main loop iteration which takes longer than @threshold_msec to
+ * dispatch is logged as a warning along with the duration and, where
+ * supported, a stack trace of where the main thread was stuck.
+ *
+ * This is meant for debugging and only one may exist at a time.
+ *
+ * Returns: (transfer full): a new #PtyxisStallMonitor
+ */
+PtyxisStallMonitor *
+ptyxis_stall_monitor_new (guint threshold_msec)
+{
+  PtyxisStallMonitor *self;
+
+  g_return_val_if_fail (threshold_msec > 0, NULL);
+  g_return_val_if_fail (the_monitor == NULL, NULL);
+
+  self = g_object_new (PTYXIS_TYPE_STALL_MONITOR, NULL);
+  self->threshold = threshold_msec * G_TIME_SPAN_MILLISECOND;
+  self->main_thread = pthread_self ();
+  self->context = g_main_context_ref (g_main_context_default ());
+  self->poll_func = g_main_context_get_poll_func (self->context);
+
+  the_monitor = self;
+
+#ifdef HAVE_BACKTRACE
+  {
+    struct sigaction sa = {0};
+    void *frames[1];
+
+    /* backtrace() may allocate on first use, which is not safe to do
+     * from within a signal handler.
+     */
+    backtrace (frames, G_N_ELEMENTS (frames));
+
+    sa.sa_handler = ptyxis_stall_monitor_signal_handler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset (&sa.sa_mask);
+    sigaction (SIGPROF, &sa, NULL);
+  }
+#endif
+
+  g_main_context_set_poll_func (self->context, ptyxis_stall_monitor_poll);
+
+  self->watchdog = g_thread_new ("[ptyxis-stall-monitor]",
+                                 ptyxis_stall_monitor_watchdog,
+                                 self);
+
+  g_debug ("Monitoring main loop for stalls over %u msec", threshold_msec);
+
+  return self;
+}
+
+guint64
+ptyxis_stall_monitor_get_n_stalls (PtyxisStallMonitor *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_STALL_MONITOR (self), 0);
+
+  return self->n_stalls;
+}
+
+/**
+ * ptyxis_stall_monitor_get_longest:
+ * @self: a #PtyxisStallMonitor
+ *
+ * Returns: the duration of the longest stall in microseconds
+ */
+gint64
+ptyxis_stall_monitor_get_longest (PtyxisStallMonitor *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_STALL_MONITOR (self), 0);
+
+  return self->longest;
+}
+
+/**
+ * ptyxis_stall_monitor_dup_last_stack:
+ * @self: a #PtyxisStallMonitor
+ *
+ * Returns: (transfer full) (nullable): the stack trace captured during
+ *   the most recent stall, or %NULL
+ */
+char *
+ptyxis_stall_monitor_dup_last_stack (PtyxisStallMonitor *self)
+{
+  PtyxisStall *stall;
+
+  g_return_val_if_fail (PTYXIS_IS_STALL_MONITOR (self), NULL);
+
+  if ((stall = g_queue_peek_tail (&self->stalls)))
+    return g_strdup (stall->stack);
+
+  return NULL;
+}
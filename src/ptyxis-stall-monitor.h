@@ -0,0 +1,37 @@
+/*
+ * ptyxis-stall-monitor.h
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define PTYXIS_TYPE_STALL_MONITOR (ptyxis_stall_monitor_get_type())
+
+G_DECLARE_FINAL_TYPE (PtyxisStallMonitor, ptyxis_stall_monitor, PTYXIS, STALL_MONITOR, GObject)
+
+PtyxisStallMonitor *ptyxis_stall_monitor_new            (guint               threshold_msec);
+guint64             ptyxis_stall_monitor_get_n_stalls   (PtyxisStallMonitor *self);
+gint64              ptyxis_stall_monitor_get_longest    (PtyxisStallMonitor *self);
+char               *ptyxis_stall_monitor_dup_last_stack (PtyxisStallMonitor *self);
+
+G_END_DECLS
@@ -27,6 +27,7 @@
 #define DELAY_INTERACTIVE_MSEC 100
 #define DELAY_MIN_MSEC         500
 #define DELAY_MAX_MSEC         10000
+#define DELAY_BACKGROUND_MSEC  30000
 
 struct _PtyxisTabMonitor
 {
@@ -36,6 +37,8 @@ struct _PtyxisTabMonitor
   int       current_delay_msec;
   guint     has_pressed_key : 1;
   guint     is_polling : 1;
+  guint     is_background : 1;
+  guint     needs_update : 1;
 };
 
 enum {
@@ -94,6 +97,33 @@ ptyxis_tab_monitor_backoff_delay (PtyxisTabMonitor *self)
                            ptyxis_tab_monitor_get_ready_time (self));
 }
 
+static void
+ptyxis_tab_monitor_background_delay (PtyxisTabMonitor *self)
+{
+  g_assert (PTYXIS_IS_TAB_MONITOR (self));
+  g_assert (self->update_source != NULL);
+
+  /* While in the background we only wake up if the terminal contents
+   * changed since our last poll. Otherwise we park the source until
+   * there is something to look at so idle tabs cost nothing.
+   */
+  self->current_delay_msec = DELAY_BACKGROUND_MSEC;
+
+  /* Wake on the next multiple of the heartbeat rather than relative to
+   * now so that all hidden tabs poll together no matter when they were
+   * hidden or last changed.
+   */
+  if (self->needs_update)
+    {
+      gint64 interval = DELAY_BACKGROUND_MSEC * 1000;
+
+      g_source_set_ready_time (self->update_source,
+                               (g_get_monotonic_time () / interval + 1) * interval);
+    }
+  else
+    g_source_set_ready_time (self->update_source, -1);
+}
+
 static void
 ptyxis_tab_monitor_poll_agent_cb (GObject      *object,
                                   GAsyncResult *result,
@@ -111,7 +141,12 @@ ptyxis_tab_monitor_poll_agent_cb (GObject      *object,
   if (self->update_source == NULL)
     return;
 
-  if (ptyxis_tab_poll_agent_finish (tab, result, NULL))
+  if (self->is_background)
+    {
+      ptyxis_tab_poll_agent_finish (tab, result, NULL);
+      ptyxis_tab_monitor_background_delay (self);
+    }
+  else if (ptyxis_tab_poll_agent_finish (tab, result, NULL))
     ptyxis_tab_monitor_reset_delay (self);
   else
     ptyxis_tab_monitor_backoff_delay (self);
@@ -129,7 +164,18 @@ ptyxis_tab_monitor_update_source_func (gpointer user_data)
   if ((tab = g_weak_ref_get (&self->tab_wr)) &&
       (process = ptyxis_tab_get_process (tab)))
     {
-      ptyxis_tab_monitor_same_delay (self);
+      if (self->is_background && !self->needs_update)
+        {
+          g_source_set_ready_time (self->update_source, -1);
+          return G_SOURCE_CONTINUE;
+        }
+
+      self->needs_update = FALSE;
+
+      if (self->is_background)
+        ptyxis_tab_monitor_background_delay (self);
+      else
+        ptyxis_tab_monitor_same_delay (self);
 
       if (!self->is_polling)
         {
@@ -166,6 +212,8 @@ ptyxis_tab_monitor_queue_update (PtyxisTabMonitor *self)
 {
   g_assert (PTYXIS_IS_TAB_MONITOR (self));
 
+  self->needs_update = TRUE;
+
   if G_UNLIKELY (self->update_source == NULL)
     {
       self->update_source = g_source_new ((GSourceFuncs *)&source_funcs, sizeof (GSource));
@@ -174,11 +222,24 @@ ptyxis_tab_monitor_queue_update (PtyxisTabMonitor *self)
                              self, NULL);
       g_source_set_static_name (self->update_source, "[ptyxis-tab-monitor]");
       g_source_set_priority (self->update_source, G_PRIORITY_LOW);
-      ptyxis_tab_monitor_reset_delay (self);
+      if (self->is_background)
+        ptyxis_tab_monitor_background_delay (self);
+      else
+        ptyxis_tab_monitor_reset_delay (self);
       g_source_attach (self->update_source, NULL);
       return;
     }
 
+  /* Coalesce everything into the next background heartbeat unless
+   * the source is currently parked waiting for new content.
+   */
+  if (self->is_background)
+    {
+      if (g_source_get_ready_time (self->update_source) == -1)
+        ptyxis_tab_monitor_background_delay (self);
+      return;
+    }
+
   if G_UNLIKELY (self->current_delay_msec > DELAY_MIN_MSEC)
     {
       ptyxis_tab_monitor_reset_delay (self);
@@ -384,3 +445,53 @@ ptyxis_tab_monitor_set_has_pressed_key (PtyxisTabMonitor *self,
 
   self->has_pressed_key = has_pressed_key;
 }
+
+gboolean
+ptyxis_tab_monitor_get_background (PtyxisTabMonitor *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_TAB_MONITOR (self), FALSE);
+
+  return self->is_background;
+}
+
+/**
+ * ptyxis_tab_monitor_set_background:
+ * @self: a #PtyxisTabMonitor
+ * @background: if the tab is not currently visible
+ *
+ * When @background is set, polling is coalesced into a single
+ * low-priority heartbeat which only fires if the terminal contents
+ * have changed. Leaving background mode performs an immediate
+ * catch-up poll if anything happened while hidden.
+ */
+void
+ptyxis_tab_monitor_set_background (PtyxisTabMonitor *self,
+                                   gboolean          background)
+{
+  g_return_if_fail (PTYXIS_IS_TAB_MONITOR (self));
+
+  background = !!background;
+
+  if (background == self->is_background)
+    return;
+
+  self->is_background = background;
+
+  if (self->update_source == NULL || self->is_polling)
+    return;
+
+  if (background)
+    {
+      ptyxis_tab_monitor_background_delay (self);
+    }
+  else if (self->needs_update)
+    {
+      self->current_delay_msec = DELAY_INTERACTIVE_MSEC;
+      g_source_set_ready_time (self->update_source,
+                               ptyxis_tab_monitor_get_ready_time (self));
+    }
+  else
+    {
+      ptyxis_tab_monitor_reset_delay (self);
+    }
+}
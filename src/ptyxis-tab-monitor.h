@@ -35,5 +35,8 @@ PtyxisTabMonitor *ptyxis_tab_monitor_new                 (PtyxisTab        *tab)
 gboolean          ptyxis_tab_monitor_get_has_pressed_key (PtyxisTabMonitor *self);
 void              ptyxis_tab_monitor_set_has_pressed_key (PtyxisTabMonitor *self,
                                                           gboolean          has_pressed_key);
+gboolean          ptyxis_tab_monitor_get_background      (PtyxisTabMonitor *self);
+void              ptyxis_tab_monitor_set_background      (PtyxisTabMonitor *self,
+                                                          gboolean          background);
 
 G_END_DECLS
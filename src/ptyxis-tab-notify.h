@@ -29,16 +29,18 @@
 
 #include <glib/gi18n.h>
 
+#include "ptyxis-terminal-private.h"
 #include "ptyxis-window.h"
 
 G_BEGIN_DECLS
 
+/* Commands returning quicker than this are not worth a notification */
+#define PTYXIS_TAB_NOTIFY_MIN_DURATION_USEC G_USEC_PER_SEC
+
 typedef struct _PtyxisTabNotify
 {
   PtyxisTab *tab;
 
-  char *current_cmdline;
-
   guint contents_changed_source;
   guint shell_preexec_source;
 
@@ -48,9 +50,20 @@ typedef struct _PtyxisTabNotify
   guint between_preexec_and_precmd : 1;
 } PtyxisTabNotify;
 
+static inline char *
+ptyxis_tab_notify_format_duration (gint64 duration)
+{
+  guint seconds = duration / G_USEC_PER_SEC;
+
+  if (seconds >= 3600)
+    return g_strdup_printf ("%u:%02u:%02u", seconds / 3600, (seconds / 60) % 60, seconds % 60);
+
+  return g_strdup_printf ("%u:%02u", seconds / 60, seconds % 60);
+}
+
 static inline void
-ptyxis_tab_notify_show_notification (PtyxisTabNotify *notify,
-                                     const char      *cmdline)
+ptyxis_tab_notify_show_notification (PtyxisTabNotify     *notify,
+                                     const PtyxisCommand *command)
 {
   GtkRoot *window;
 
@@ -72,6 +85,8 @@ ptyxis_tab_notify_show_notification (PtyxisTabNotify *notify,
       g_autoptr(GNotification) notification = NULL;
       g_autoptr(GIcon) icon = NULL;
       g_autofree char *cmdline_sanitized = NULL;
+      g_autofree char *duration = NULL;
+      g_autofree char *body = NULL;
       const char *uuid = ptyxis_tab_get_uuid (notify->tab);
 
 #ifdef GDK_WINDOWING_X11
@@ -84,10 +99,21 @@ ptyxis_tab_notify_show_notification (PtyxisTabNotify *notify,
 #endif
 
       icon = g_themed_icon_new (APP_ID "-symbolic");
-      cmdline_sanitized = g_utf8_make_valid (cmdline, -1);
-
-      notification = g_notification_new (_("Command completed"));
-      g_notification_set_body (notification, cmdline_sanitized);
+      duration = ptyxis_tab_notify_format_duration (ptyxis_command_get_duration (command));
+
+      if (command->command_line != NULL)
+        {
+          cmdline_sanitized = g_utf8_make_valid (command->command_line, -1);
+          body = g_strdup_printf ("%s (%s)", cmdline_sanitized, duration);
+        }
+      else
+        body = g_steal_pointer (&duration);
+
+      if (command->exit_status > 0)
+        notification = g_notification_new (_("Command failed"));
+      else
+        notification = g_notification_new (_("Command completed"));
+      g_notification_set_body (notification, body);
       g_notification_set_icon (notification, icon);
       g_notification_set_default_action_and_target (notification,
                                                     "app.focus-tab-by-uuid",
@@ -103,37 +129,29 @@ static inline void
 ptyxis_tab_notify_shell_precmd_cb (PtyxisTerminal  *terminal,
                                    PtyxisTabNotify *notify)
 {
+  PtyxisCommandHistory *history;
+  const PtyxisCommand *command;
+
   g_assert (PTYXIS_IS_TERMINAL (terminal));
   g_assert (PTYXIS_IS_TAB (notify->tab));
 
-  notify->between_preexec_and_precmd = FALSE;
-
   g_clear_handle_id (&notify->contents_changed_source, g_source_remove);
   g_clear_handle_id (&notify->shell_preexec_source, g_source_remove);
 
-  if (notify->current_cmdline != NULL)
-    {
-      ptyxis_tab_notify_show_notification (notify, notify->current_cmdline);
-      g_clear_pointer (&notify->current_cmdline, g_free);
-    }
-}
-
-static void
-ptyxis_tab_notify_shell_preexec_poll_cb (GObject      *object,
-                                         GAsyncResult *result,
-                                         gpointer      user_data)
-{
-  PtyxisTab *tab = (PtyxisTab *)object;
-  PtyxisTabNotify *notify = user_data;
+  if (!notify->between_preexec_and_precmd)
+    return;
 
-  g_assert (PTYXIS_IS_TAB (tab));
-  g_assert (G_IS_ASYNC_RESULT (result));
-  g_assert (notify != NULL);
+  notify->between_preexec_and_precmd = FALSE;
 
-  ptyxis_tab_poll_agent_finish (tab, result, NULL);
+  /* The terminal has already finished the command in its history by
+   * the time precmd is emitted, so it is the most recent item. If it
+   * returned quickly, don't bother the user about it.
+   */
+  history = _ptyxis_terminal_get_command_history (terminal);
 
-  g_set_str (&notify->current_cmdline,
-             ptyxis_tab_get_command_line (tab));
+  if ((command = ptyxis_command_history_get_nth (history, 0)) &&
+      ptyxis_command_get_duration (command) >= PTYXIS_TAB_NOTIFY_MIN_DURATION_USEC)
+    ptyxis_tab_notify_show_notification (notify, command);
 }
 
 static inline void
@@ -143,19 +161,10 @@ ptyxis_tab_notify_shell_preexec_cb (PtyxisTerminal  *terminal,
   g_assert (PTYXIS_IS_TERMINAL (terminal));
   g_assert (PTYXIS_IS_TAB (notify->tab));
 
-  notify->between_preexec_and_precmd = TRUE;
-
-  g_set_str (&notify->current_cmdline, NULL);
-
-  /* We will poll the agent for the updated command line. If we get
-   * precmd back in before this completes, we will ignore showing
-   * any notification as it's so quick it shouldn't matter. We
-   * can pass a borrowed notify as it's owned by @tab.
+  /* Everything we need is recorded by the terminal from the shell
+   * integration sequences, so nothing is requested from the agent.
    */
-  ptyxis_tab_poll_agent_async (notify->tab,
-                               NULL,
-                               ptyxis_tab_notify_shell_preexec_poll_cb,
-                               notify);
+  notify->between_preexec_and_precmd = TRUE;
 }
 
 static inline void
@@ -169,7 +178,6 @@ ptyxis_tab_notify_init (PtyxisTabNotify *notify,
   notify->contents_changed_source = 0;
   notify->shell_preexec_source = 0;
   notify->between_preexec_and_precmd = FALSE;
-  notify->current_cmdline = NULL;
 
   notify->shell_precmd_handler =
     g_signal_connect (terminal,
@@ -198,8 +206,6 @@ ptyxis_tab_notify_destroy (PtyxisTabNotify *notify)
   g_clear_signal_handler (&notify->shell_precmd_handler, terminal);
   g_clear_signal_handler (&notify->shell_preexec_handler, terminal);
 
-  g_clear_pointer (&notify->current_cmdline, g_free);
-
   notify->tab = NULL;
 }
 
@@ -0,0 +1,267 @@
+/*
+ * ptyxis-tab-pool.c
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include "ptyxis-application.h"
+#include "ptyxis-tab-pool.h"
+#include "ptyxis-tab-private.h"
+
+/* After the system tells us memory is low, don't create new tabs in
+ * the background for a while. Tabs are still created on demand.
+ */
+#define LOW_MEMORY_BACKOFF_SECONDS 60
+
+struct _PtyxisTabPool
+{
+  GObject         parent_instance;
+  PtyxisSettings *settings;
+  GMemoryMonitor *memory_monitor;
+  GQueue          tabs;
+  gint64          low_memory_time;
+  guint           fill_source;
+};
+
+G_DEFINE_FINAL_TYPE (PtyxisTabPool, ptyxis_tab_pool, G_TYPE_OBJECT)
+
+static void
+ptyxis_tab_pool_trim (PtyxisTabPool *self,
+                      guint          max_tabs)
+{
+  g_assert (PTYXIS_IS_TAB_POOL (self));
+
+  while (self->tabs.length > max_tabs)
+    g_object_unref (g_queue_pop_tail (&self->tabs));
+}
+
+static gboolean
+ptyxis_tab_pool_fill_cb (gpointer data)
+{
+  PtyxisTabPool *self = data;
+  g_autoptr(PtyxisProfile) profile = NULL;
+  PtyxisTab *tab;
+
+  g_assert (PTYXIS_IS_TAB_POOL (self));
+
+  if (self->settings == NULL ||
+      self->tabs.length >= ptyxis_settings_get_tab_pool_size (self->settings) ||
+      !(profile = ptyxis_application_dup_default_profile (PTYXIS_APPLICATION_DEFAULT)))
+    {
+      self->fill_source = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  /* Create a single tab per main loop iteration so that building the
+   * widget tree never delays a frame by more than one tab's worth.
+   *
+   * The tab is not registered with the scrollback budget or broadcast
+   * groups until it is taken from the pool.
+   */
+  tab = g_object_new (PTYXIS_TYPE_TAB,
+                      "profile", profile,
+                      NULL);
+  g_queue_push_tail (&self->tabs, g_object_ref_sink (tab));
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+ptyxis_tab_pool_queue_fill (PtyxisTabPool *self)
+{
+  g_assert (PTYXIS_IS_TAB_POOL (self));
+
+  if (self->fill_source != 0 || self->settings == NULL)
+    return;
+
+  if (self->tabs.length >= ptyxis_settings_get_tab_pool_size (self->settings))
+    return;
+
+  if (self->low_memory_time != 0 &&
+      g_get_monotonic_time () - self->low_memory_time < LOW_MEMORY_BACKOFF_SECONDS * G_USEC_PER_SEC)
+    return;
+
+  self->fill_source = g_idle_add_full (G_PRIORITY_LOW,
+                                       ptyxis_tab_pool_fill_cb,
+                                       self,
+                                       NULL);
+}
+
+static void
+ptyxis_tab_pool_notify_tab_pool_size_cb (PtyxisTabPool  *self,
+                                         GParamSpec     *pspec,
+                                         PtyxisSettings *settings)
+{
+  g_assert (PTYXIS_IS_TAB_POOL (self));
+  g_assert (PTYXIS_IS_SETTINGS (settings));
+
+  ptyxis_tab_pool_trim (self, ptyxis_settings_get_tab_pool_size (settings));
+  ptyxis_tab_pool_queue_fill (self);
+}
+
+static void
+ptyxis_tab_pool_notify_default_profile_uuid_cb (PtyxisTabPool  *self,
+                                                GParamSpec     *pspec,
+                                                PtyxisSettings *settings)
+{
+  g_assert (PTYXIS_IS_TAB_POOL (self));
+  g_assert (PTYXIS_IS_SETTINGS (settings));
+
+  ptyxis_tab_pool_clear (self);
+  ptyxis_tab_pool_queue_fill (self);
+}
+
+static void
+ptyxis_tab_pool_low_memory_warning_cb (PtyxisTabPool                *self,
+                                       GMemoryMonitorWarningLevel    level,
+                                       GMemoryMonitor               *memory_monitor)
+{
+  g_assert (PTYXIS_IS_TAB_POOL (self));
+  g_assert (G_IS_MEMORY_MONITOR (memory_monitor));
+
+  self->low_memory_time = g_get_monotonic_time ();
+
+  ptyxis_tab_pool_clear (self);
+}
+
+static void
+ptyxis_tab_pool_dispose (GObject *object)
+{
+  PtyxisTabPool *self = (PtyxisTabPool *)object;
+
+  ptyxis_tab_pool_clear (self);
+
+  g_clear_object (&self->memory_monitor);
+  g_clear_object (&self->settings);
+
+  G_OBJECT_CLASS (ptyxis_tab_pool_parent_class)->dispose (object);
+}
+
+static void
+ptyxis_tab_pool_class_init (PtyxisTabPoolClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = ptyxis_tab_pool_dispose;
+}
+
+static void
+ptyxis_tab_pool_init (PtyxisTabPool *self)
+{
+}
+
+PtyxisTabPool *
+ptyxis_tab_pool_new (PtyxisSettings *settings)
+{
+  PtyxisTabPool *self;
+
+  g_return_val_if_fail (PTYXIS_IS_SETTINGS (settings), NULL);
+
+  self = g_object_new (PTYXIS_TYPE_TAB_POOL, NULL);
+  self->settings = g_object_ref (settings);
+  self->memory_monitor = g_memory_monitor_dup_default ();
+
+  g_signal_connect_object (settings,
+                           "notify::tab-pool-size",
+                           G_CALLBACK (ptyxis_tab_pool_notify_tab_pool_size_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (settings,
+                           "notify::default-profile-uuid",
+                           G_CALLBACK (ptyxis_tab_pool_notify_default_profile_uuid_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (self->memory_monitor,
+                           "low-memory-warning",
+                           G_CALLBACK (ptyxis_tab_pool_low_memory_warning_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  ptyxis_tab_pool_queue_fill (self);
+
+  return self;
+}
+
+/**
+ * ptyxis_tab_pool_take:
+ * @self: a #PtyxisTabPool
+ * @profile: a #PtyxisProfile
+ *
+ * Gets a new tab for @profile.
+ *
+ * If a tab for @profile was created ahead of time it is returned,
+ * otherwise a new tab is created. Either way, the pool is refilled
+ * once the application is idle.
+ *
+ * The tab has not spawned anything yet, so callers may still change
+ * the command, container, or working directory before adding it to
+ * a window.
+ *
+ * Returns: (transfer floating): a #PtyxisTab
+ */
+PtyxisTab *
+ptyxis_tab_pool_take (PtyxisTabPool *self,
+                      PtyxisProfile *profile)
+{
+  PtyxisTab *tab = NULL;
+
+  g_return_val_if_fail (PTYXIS_IS_TAB_POOL (self), NULL);
+  g_return_val_if_fail (PTYXIS_IS_PROFILE (profile), NULL);
+
+  for (const GList *iter = self->tabs.head; iter; iter = iter->next)
+    {
+      if (g_strcmp0 (ptyxis_profile_get_uuid (ptyxis_tab_get_profile (iter->data)),
+                     ptyxis_profile_get_uuid (profile)) == 0)
+        {
+          tab = iter->data;
+          g_queue_delete_link (&self->tabs, (GList *)iter);
+          break;
+        }
+    }
+
+  /* Callers expect a floating reference just like ptyxis_tab_new() */
+  if (tab != NULL)
+    {
+      g_object_force_floating (G_OBJECT (tab));
+      _ptyxis_tab_register (tab);
+    }
+  else
+    tab = ptyxis_tab_new (profile);
+
+  ptyxis_tab_pool_queue_fill (self);
+
+  return tab;
+}
+
+/**
+ * ptyxis_tab_pool_clear:
+ * @self: a #PtyxisTabPool
+ *
+ * Releases all of the tabs that were created ahead of time.
+ */
+void
+ptyxis_tab_pool_clear (PtyxisTabPool *self)
+{
+  g_return_if_fail (PTYXIS_IS_TAB_POOL (self));
+
+  g_clear_handle_id (&self->fill_source, g_source_remove);
+
+  ptyxis_tab_pool_trim (self, 0);
+}
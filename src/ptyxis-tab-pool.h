@@ -0,0 +1,38 @@
+/*
+ * ptyxis-tab-pool.h
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "ptyxis-settings.h"
+#include "ptyxis-tab.h"
+
+G_BEGIN_DECLS
+
+#define PTYXIS_TYPE_TAB_POOL (ptyxis_tab_pool_get_type())
+
+G_DECLARE_FINAL_TYPE (PtyxisTabPool, ptyxis_tab_pool, PTYXIS, TAB_POOL, GObject)
+
+PtyxisTabPool *ptyxis_tab_pool_new   (PtyxisSettings *settings);
+PtyxisTab     *ptyxis_tab_pool_take  (PtyxisTabPool  *self,
+                                      PtyxisProfile  *profile);
+void           ptyxis_tab_pool_clear (PtyxisTabPool  *self);
+
+G_END_DECLS
@@ -25,6 +25,23 @@
 
 G_BEGIN_DECLS
 
-void _ptyxis_tab_ignore_snapshot (PtyxisTab *self);
+void     _ptyxis_tab_ignore_snapshot         (PtyxisTab            *self);
+gboolean _ptyxis_tab_is_background           (PtyxisTab            *self);
+gint64   _ptyxis_tab_get_last_active_time    (PtyxisTab            *self);
+guint64  _ptyxis_tab_get_scrollback_usage    (PtyxisTab            *self,
+                                              guint                *n_lines);
+gboolean _ptyxis_tab_prefetch                (PtyxisTab            *self,
+                                              PtyxisTab            *like);
+void     _ptyxis_tab_set_scrollback_override (PtyxisTab            *self,
+                                              long                  scrollback_lines);
+gboolean _ptyxis_tab_needs_spawn             (PtyxisTab            *self);
+void     _ptyxis_tab_register                (PtyxisTab            *self);
+void     _ptyxis_tab_spawn_async             (PtyxisTab            *self,
+                                              GCancellable         *cancellable,
+                                              GAsyncReadyCallback   callback,
+                                              gpointer              user_data);
+gboolean _ptyxis_tab_spawn_finish            (PtyxisTab            *self,
+                                              GAsyncResult         *result,
+                                              GError              **error);
 
 G_END_DECLS
@@ -34,10 +34,12 @@
 #include "ptyxis-application.h"
 #include "ptyxis-enums.h"
 #include "ptyxis-inspector.h"
+#include "ptyxis-output-log.h"
+#include "ptyxis-scrollback-budget.h"
 #include "ptyxis-tab-monitor.h"
 #include "ptyxis-tab-notify.h"
 #include "ptyxis-tab-private.h"
-#include "ptyxis-terminal.h"
+#include "ptyxis-terminal-private.h"
 #include "ptyxis-util.h"
 #include "ptyxis-window.h"
 
@@ -60,22 +62,36 @@ struct _PtyxisTab
   PtyxisIpcProcess        *process;
   char                    *title_prefix;
   PtyxisTabMonitor        *monitor;
+  PtyxisOutputLog         *output_log;
   char                    *uuid;
   PtyxisIpcContainer      *container_at_creation;
   char                   **command;
   char                    *initial_title;
   GdkTexture              *cached_texture;
+  GtkBox                  *box;
   AdwBanner               *banner;
+  AdwBanner               *paste_banner;
   GtkScrolledWindow       *scrolled_window;
   PtyxisTerminal          *terminal;
   char                    *command_line;
   char                    *program_name;
   PtyxisTabNotify          notify;
+  GCancellable            *cancellable;
+  GQueue                   spawn_tasks;
+  GList                    font_link;
+  GList                    pending_link;
 
   PtyxisTabState           state;
   GPid                     pid;
 
   gint64                   respawn_time;
+  gint64                   last_active_time;
+
+  long                     scrollback_override;
+
+  int                      paste_percent;
+
+  guint                    indicator_key;
 
   PtyxisZoomLevel          zoom : 5;
   PtyxisProcessLeaderKind  leader_kind : 3;
@@ -83,10 +99,18 @@ struct _PtyxisTab
   guint                    forced_exit : 1;
   guint                    ignore_osc_title : 1;
   guint                    ignore_snapshot : 1;
+  guint                    is_background : 1;
+  guint                    pending_title : 1;
+  guint                    pending_subtitle : 1;
+  guint                    pending_progress : 1;
+  guint                    pending_font : 1;
+  guint                    registered : 1;
 };
 
 enum {
   PROP_0,
+  PROP_BROADCAST_GROUP,
+  PROP_BROADCAST_INPUT,
   PROP_COMMAND_LINE,
   PROP_ICON,
   PROP_IGNORE_OSC_TITLE,
@@ -114,10 +138,38 @@ static void ptyxis_tab_respawn (PtyxisTab *self);
 
 G_DEFINE_FINAL_TYPE (PtyxisTab, ptyxis_tab, GTK_TYPE_WIDGET)
 
+#define BACKGROUND_HEARTBEAT_SECONDS 2
+
+/* Rough estimate of what VTE uses per cell of scrollback once it has
+ * been compressed into its ring stream. Only used for budgeting.
+ */
+#define SCROLLBACK_BYTES_PER_CELL 4
+
+/* Progress is drawn in this many steps. Updates within a step do not
+ * change the tab icon, and every tab at that step shares a texture.
+ */
+#define PROGRESS_BUCKETS 32
+#define MAX_CACHED_INDICATORS 256
+
 #ifdef __linux__
 static XdpPortal *portal;
 #endif
 
+/* Hidden tabs waiting for a new font. They are updated one at a time
+ * at idle priority so that changing the font with many tabs open does
+ * not stall the visible ones.
+ */
+static GQueue font_queue;
+static guint font_queue_source;
+
+/* Hidden tabs with deferred notifications. They are all flushed from a
+ * single seconds-based heartbeat rather than one timeout per tab.
+ */
+static GQueue pending_queue;
+static guint pending_queue_source;
+
+static GHashTable *indicator_cache;
+
 static GParamSpec *properties[N_PROPS];
 static guint signals[N_SIGNALS];
 static double zoom_font_scales[] = {
@@ -235,6 +287,13 @@ ptyxis_tab_update_scrollback_lines (PtyxisTab *self)
   if (ptyxis_profile_get_limit_scrollback (self->profile))
     scrollback_lines = ptyxis_profile_get_scrollback_lines (self->profile);
 
+  /* The scrollback budget may have asked us to hold fewer lines while
+   * we are in the background. Never grow beyond the profile limit.
+   */
+  if (self->scrollback_override > 0 &&
+      (scrollback_lines < 0 || self->scrollback_override < scrollback_lines))
+    scrollback_lines = self->scrollback_override;
+
   vte_terminal_set_scrollback_lines (VTE_TERMINAL (self->terminal), scrollback_lines);
 }
 
@@ -251,6 +310,31 @@ ptyxis_tab_update_cell_height_scale (PtyxisTab *self)
   vte_terminal_set_cell_height_scale (VTE_TERMINAL (self->terminal), cell_height_scale);
 }
 
+static void
+ptyxis_tab_update_output_log (PtyxisTab *self)
+{
+  gboolean log_output;
+  gboolean log_compress;
+
+  g_assert (PTYXIS_IS_TAB (self));
+
+  /* Pooled tabs have no output worth logging until they are handed out */
+  if (!self->registered)
+    return;
+
+  log_output = ptyxis_profile_get_log_output (self->profile);
+  log_compress = ptyxis_profile_get_log_compress (self->profile);
+
+  if (self->output_log != NULL &&
+      (!log_output || ptyxis_output_log_get_compress (self->output_log) != log_compress))
+    g_clear_object (&self->output_log);
+
+  if (log_output && self->output_log == NULL)
+    self->output_log = ptyxis_output_log_new (self->terminal,
+                                              self->uuid,
+                                              log_compress);
+}
+
 static gboolean
 ptyxis_tab_grab_focus (GtkWidget *widget)
 {
@@ -261,6 +345,55 @@ ptyxis_tab_grab_focus (GtkWidget *widget)
   return gtk_widget_grab_focus (GTK_WIDGET (self->terminal));
 }
 
+static void
+ptyxis_tab_cancel_paste_cb (PtyxisTab *self,
+                            AdwBanner *banner)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (ADW_IS_BANNER (banner));
+
+  ptyxis_terminal_cancel_paste (self->terminal);
+}
+
+static void
+ptyxis_tab_ensure_banner (PtyxisTab *self)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+
+  if (self->banner != NULL)
+    return;
+
+  /* We don't allow animations because it makes the terminal
+   * grid resize in a janky fashion.
+   */
+  self->banner = ADW_BANNER (adw_banner_new (NULL));
+  adw_banner_set_revealed (self->banner, TRUE);
+  gtk_widget_set_visible (GTK_WIDGET (self->banner), FALSE);
+  gtk_box_prepend (self->box, GTK_WIDGET (self->banner));
+}
+
+static void
+ptyxis_tab_ensure_paste_banner (PtyxisTab *self)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+
+  if (self->paste_banner != NULL)
+    return;
+
+  self->paste_banner = ADW_BANNER (adw_banner_new (NULL));
+  adw_banner_set_button_label (self->paste_banner, _("_Cancel"));
+  adw_banner_set_revealed (self->paste_banner, TRUE);
+  gtk_widget_set_visible (GTK_WIDGET (self->paste_banner), FALSE);
+  g_signal_connect_object (self->paste_banner,
+                           "button-clicked",
+                           G_CALLBACK (ptyxis_tab_cancel_paste_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+  gtk_box_insert_child_after (self->box,
+                              GTK_WIDGET (self->paste_banner),
+                              self->banner ? GTK_WIDGET (self->banner) : NULL);
+}
+
 static void
 ptyxis_tab_wait_cb (GObject      *object,
                     GAsyncResult *result,
@@ -301,6 +434,7 @@ ptyxis_tab_wait_cb (GObject      *object,
 
       title = g_strdup_printf (_("Process Exited from Signal %d"), WTERMSIG (exit_code));
 
+      ptyxis_tab_ensure_banner (self);
       adw_banner_set_title (self->banner, title);
       adw_banner_set_button_label (self->banner, _("_Restart"));
       gtk_actionable_set_action_name (GTK_ACTIONABLE (self->banner), "tab.respawn");
@@ -324,6 +458,7 @@ ptyxis_tab_wait_cb (GObject      *object,
    * display it again if the tab is removed from the parking lot and
    * restored into the window.
    */
+  ptyxis_tab_ensure_banner (self);
   adw_banner_set_title (self->banner, _("Process Exited"));
   adw_banner_set_button_label (self->banner, _("_Restart"));
   gtk_actionable_set_action_name (GTK_ACTIONABLE (self->banner), "tab.respawn");
@@ -364,6 +499,25 @@ ptyxis_tab_wait_cb (GObject      *object,
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TITLE]);
 }
 
+static void
+ptyxis_tab_complete_spawn (PtyxisTab    *self,
+                           const GError *error)
+{
+  GTask *task;
+
+  g_assert (PTYXIS_IS_TAB (self));
+
+  while ((task = g_queue_pop_head (&self->spawn_tasks)))
+    {
+      if (error != NULL)
+        g_task_return_error (task, g_error_copy (error));
+      else
+        g_task_return_boolean (task, TRUE);
+
+      g_object_unref (task);
+    }
+}
+
 static void
 ptyxis_tab_spawn_cb (GObject      *object,
                      GAsyncResult *result,
@@ -388,12 +542,15 @@ ptyxis_tab_spawn_cb (GObject      *object,
       vte_terminal_feed (VTE_TERMINAL (self->terminal), error->message, -1);
       vte_terminal_feed (VTE_TERMINAL (self->terminal), "\r\n", -1);
 
+      ptyxis_tab_ensure_banner (self);
       adw_banner_set_title (self->banner, _("Failed to launch terminal"));
       adw_banner_set_button_label (self->banner, _("Edit Profile"));
       gtk_actionable_set_action_target (GTK_ACTIONABLE (self->banner), "s", profile_uuid);
       gtk_actionable_set_action_name (GTK_ACTIONABLE (self->banner), "app.edit-profile");
       gtk_widget_set_visible (GTK_WIDGET (self->banner), TRUE);
 
+      ptyxis_tab_complete_spawn (self, error);
+
       return;
     }
 
@@ -402,6 +559,8 @@ ptyxis_tab_spawn_cb (GObject      *object,
 
   g_set_object (&self->process, process);
 
+  ptyxis_tab_complete_spawn (self, NULL);
+
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ICON]);
 
   ptyxis_application_wait_async (app,
@@ -411,15 +570,96 @@ ptyxis_tab_spawn_cb (GObject      *object,
                                  g_object_ref (self));
 }
 
+static void
+ptyxis_tab_spawn (PtyxisTab          *self,
+                  PtyxisIpcContainer *container,
+                  VtePty             *pty)
+{
+  const char *cwd_uri;
+
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (PTYXIS_IPC_IS_CONTAINER (container));
+  g_assert (VTE_IS_PTY (pty));
+  g_assert (self->state == PTYXIS_TAB_STATE_SPAWNING);
+
+  cwd_uri = self->previous_working_directory_uri;
+  if (self->initial_working_directory_uri)
+    cwd_uri = self->initial_working_directory_uri;
+
+  ptyxis_application_spawn_async (PTYXIS_APPLICATION_DEFAULT,
+                                  container,
+                                  self->profile,
+                                  cwd_uri,
+                                  pty,
+                                  (const char * const *)self->command,
+                                  NULL,
+                                  ptyxis_tab_spawn_cb,
+                                  g_object_ref (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TITLE]);
+}
+
+static void
+ptyxis_tab_create_pty_cb (GObject      *object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  PtyxisApplication *app = (PtyxisApplication *)object;
+  g_autoptr(PtyxisIpcContainer) container = NULL;
+  g_autoptr(PtyxisTab) self = user_data;
+  g_autofree char *default_container = NULL;
+  g_autoptr(VtePty) pty = NULL;
+  g_autoptr(GError) error = NULL;
+
+  g_assert (PTYXIS_IS_APPLICATION (app));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (PTYXIS_IS_TAB (self));
+
+  if (!(pty = ptyxis_application_create_pty_finish (app, result, &error)))
+    {
+      ptyxis_tab_complete_spawn (self, error);
+
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+      self->state = PTYXIS_TAB_STATE_FAILED;
+
+      ptyxis_tab_ensure_banner (self);
+      adw_banner_set_title (self->banner, _("Failed to create pseudo terminal device"));
+      adw_banner_set_button_label (self->banner, NULL);
+      gtk_actionable_set_action_name (GTK_ACTIONABLE (self->banner), NULL);
+      gtk_widget_set_visible (GTK_WIDGET (self->banner), TRUE);
+
+      return;
+    }
+
+  vte_terminal_set_pty (VTE_TERMINAL (self->terminal), pty);
+
+  /* Resolve the container again as it may have gone away meanwhile */
+  default_container = ptyxis_profile_dup_default_container (self->profile);
+  if (self->container_at_creation != NULL)
+    container = g_object_ref (self->container_at_creation);
+  else
+    container = ptyxis_application_lookup_container (app, default_container);
+
+  if (container == NULL)
+    {
+      /* Let respawn report the missing container */
+      self->state = PTYXIS_TAB_STATE_INITIAL;
+      ptyxis_tab_respawn (self);
+      return;
+    }
+
+  ptyxis_tab_spawn (self, container, pty);
+}
+
 static void
 ptyxis_tab_respawn (PtyxisTab *self)
 {
   g_autofree char *default_container = NULL;
   g_autoptr(PtyxisIpcContainer) container = NULL;
-  g_autoptr(VtePty) new_pty = NULL;
   PtyxisApplication *app;
   const char *profile_uuid;
-  const char *cwd_uri;
   VtePty *pty;
 
   g_assert (PTYXIS_IS_TAB (self));
@@ -427,7 +667,8 @@ ptyxis_tab_respawn (PtyxisTab *self)
             self->state == PTYXIS_TAB_STATE_EXITED ||
             self->state == PTYXIS_TAB_STATE_FAILED);
 
-  gtk_widget_set_visible (GTK_WIDGET (self->banner), FALSE);
+  if (self->banner != NULL)
+    gtk_widget_set_visible (GTK_WIDGET (self->banner), FALSE);
 
   app = PTYXIS_APPLICATION_DEFAULT;
   profile_uuid = ptyxis_profile_get_uuid (self->profile);
@@ -445,57 +686,35 @@ ptyxis_tab_respawn (PtyxisTab *self)
       self->state = PTYXIS_TAB_STATE_FAILED;
 
       title = g_strdup_printf (_("Cannot locate container “%s”"), default_container);
+      ptyxis_tab_ensure_banner (self);
       adw_banner_set_title (self->banner, title);
       adw_banner_set_button_label (self->banner, _("Edit Profile"));
       gtk_actionable_set_action_target (GTK_ACTIONABLE (self->banner), "s", profile_uuid);
       gtk_actionable_set_action_name (GTK_ACTIONABLE (self->banner), "app.edit-profile");
       gtk_widget_set_visible (GTK_WIDGET (self->banner), TRUE);
 
+      if (!g_queue_is_empty (&self->spawn_tasks))
+        {
+          g_autoptr(GError) error = g_error_new_literal (G_IO_ERROR, G_IO_ERROR_NOT_FOUND, title);
+          ptyxis_tab_complete_spawn (self, error);
+        }
+
       return;
     }
 
   self->state = PTYXIS_TAB_STATE_SPAWNING;
 
-  pty = vte_terminal_get_pty (VTE_TERMINAL (self->terminal));
-
-  if (pty == NULL)
+  /* Creating the PTY requires a round-trip to the agent */
+  if (!(pty = vte_terminal_get_pty (VTE_TERMINAL (self->terminal))))
     {
-      g_autoptr(GError) error = NULL;
-
-      new_pty = ptyxis_application_create_pty (PTYXIS_APPLICATION_DEFAULT, &error);
-
-      if (new_pty == NULL)
-        {
-          self->state = PTYXIS_TAB_STATE_FAILED;
-
-          adw_banner_set_title (self->banner, _("Failed to create pseudo terminal device"));
-          adw_banner_set_button_label (self->banner, NULL);
-          gtk_actionable_set_action_name (GTK_ACTIONABLE (self->banner), NULL);
-          gtk_widget_set_visible (GTK_WIDGET (self->banner), TRUE);
-
-          return;
-        }
-
-      vte_terminal_set_pty (VTE_TERMINAL (self->terminal), new_pty);
-
-      pty = new_pty;
+      ptyxis_application_create_pty_async (app,
+                                           self->cancellable,
+                                           ptyxis_tab_create_pty_cb,
+                                           g_object_ref (self));
+      return;
     }
 
-  cwd_uri = self->previous_working_directory_uri;
-  if (self->initial_working_directory_uri)
-    cwd_uri = self->initial_working_directory_uri;
-
-  ptyxis_application_spawn_async (PTYXIS_APPLICATION_DEFAULT,
-                                  container,
-                                  self->profile,
-                                  cwd_uri,
-                                  pty,
-                                  (const char * const *)self->command,
-                                  NULL,
-                                  ptyxis_tab_spawn_cb,
-                                  g_object_ref (self));
-
-  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TITLE]);
+  ptyxis_tab_spawn (self, container, pty);
 }
 
 static void
@@ -532,82 +751,351 @@ ptyxis_tab_inspect_action (GtkWidget  *widget,
   gtk_window_present (GTK_WINDOW (inspector));
 }
 
-static void
-ptyxis_tab_map (GtkWidget *widget)
+static guint
+ptyxis_tab_get_progress_bucket (PtyxisTab *self)
 {
-  PtyxisTab *self = (PtyxisTab *)widget;
+  g_assert (PTYXIS_IS_TAB (self));
 
-  g_assert (PTYXIS_IS_TAB (widget));
+  /* Round down so that a full circle always means completed */
+  return ptyxis_tab_get_progress_fraction (self) * PROGRESS_BUCKETS;
+}
 
-  GTK_WIDGET_CLASS (ptyxis_tab_parent_class)->map (widget);
+/*
+ * ptyxis_tab_update_indicator_key:
+ *
+ * Tracks what the progress indicator would currently look like.
+ *
+ * Returns: %TRUE if it changed since the last call
+ */
+static gboolean
+ptyxis_tab_update_indicator_key (PtyxisTab *self)
+{
+  PtyxisTabProgress progress;
+  guint key;
 
-  if (self->state == PTYXIS_TAB_STATE_INITIAL)
-    ptyxis_tab_respawn (self);
+  g_assert (PTYXIS_IS_TAB (self));
+
+  progress = ptyxis_tab_get_progress (self);
+  key = progress * (PROGRESS_BUCKETS + 1);
+
+  if (progress == PTYXIS_TAB_PROGRESS_ACTIVE)
+    key += ptyxis_tab_get_progress_bucket (self);
+
+  if (key == self->indicator_key)
+    return FALSE;
+
+  self->indicator_key = key;
+
+  return TRUE;
+}
+
+static inline gboolean
+ptyxis_tab_has_pending (PtyxisTab *self)
+{
+  return self->pending_title || self->pending_subtitle || self->pending_progress;
 }
 
 static void
-ptyxis_tab_notify_contains_focus_cb (PtyxisTab               *self,
-                                     GParamSpec              *pspec,
-                                     GtkEventControllerFocus *focus)
+ptyxis_tab_flush_pending (PtyxisTab *self)
 {
   g_assert (PTYXIS_IS_TAB (self));
-  g_assert (GTK_IS_EVENT_CONTROLLER_FOCUS (focus));
 
-  if (gtk_event_controller_focus_contains_focus (focus))
+  if (!ptyxis_tab_has_pending (self))
+    return;
+
+  g_queue_unlink (&pending_queue, &self->pending_link);
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  if (self->pending_title)
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TITLE]);
+
+  if (self->pending_subtitle)
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SUBTITLE]);
+
+  if (self->pending_progress)
     {
-      ptyxis_tab_set_needs_attention (self, FALSE);
-      g_application_withdraw_notification (G_APPLICATION (PTYXIS_APPLICATION_DEFAULT),
-                                           self->uuid);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PROGRESS]);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PROGRESS_FRACTION]);
+
+      if (ptyxis_tab_update_indicator_key (self))
+        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INDICATOR_ICON]);
     }
+
+  self->pending_title = FALSE;
+  self->pending_subtitle = FALSE;
+  self->pending_progress = FALSE;
+
+  g_object_thaw_notify (G_OBJECT (self));
 }
 
 static void
-ptyxis_tab_notify_window_title_cb (PtyxisTab      *self,
-                                   GParamSpec     *pspec,
-                                   PtyxisTerminal *terminal)
+ptyxis_tab_apply_font (PtyxisTab *self)
 {
+  PtyxisSettings *settings;
+
   g_assert (PTYXIS_IS_TAB (self));
-  g_assert (PTYXIS_IS_TERMINAL (terminal));
 
-  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TITLE]);
+  if (self->pending_font)
+    {
+      g_queue_unlink (&font_queue, &self->font_link);
+      self->pending_font = FALSE;
+    }
+
+  /* The description is shared by all tabs and VTE caches the font
+   * metrics for it, so only the first terminal pays for resolving it.
+   */
+  settings = ptyxis_application_get_settings (PTYXIS_APPLICATION_DEFAULT);
+  vte_terminal_set_font (VTE_TERMINAL (self->terminal),
+                         ptyxis_settings_get_font_desc (settings));
 }
 
-static void
-ptyxis_tab_notify_window_subtitle_cb (PtyxisTab      *self,
-                                      PtyxisTerminal *terminal)
+static gboolean
+ptyxis_tab_font_queue_cb (gpointer data)
 {
-  g_assert (PTYXIS_IS_TAB (self));
-  g_assert (PTYXIS_IS_TERMINAL (terminal));
+  PtyxisTab *self;
+
+  if ((self = g_queue_peek_head (&font_queue)))
+    ptyxis_tab_apply_font (self);
 
-  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SUBTITLE]);
+  if (!g_queue_is_empty (&font_queue))
+    return G_SOURCE_CONTINUE;
+
+  font_queue_source = 0;
+
+  return G_SOURCE_REMOVE;
 }
 
 static void
-ptyxis_tab_increase_font_size_cb (PtyxisTab      *self,
-                                  PtyxisTerminal *terminal)
+ptyxis_tab_queue_font (PtyxisTab *self)
 {
   g_assert (PTYXIS_IS_TAB (self));
-  g_assert (PTYXIS_IS_TERMINAL (terminal));
 
-  ptyxis_tab_zoom_in (self);
+  if (!self->is_background)
+    {
+      ptyxis_tab_apply_font (self);
+      return;
+    }
+
+  if (!self->pending_font)
+    {
+      self->font_link.data = self;
+      g_queue_push_tail_link (&font_queue, &self->font_link);
+      self->pending_font = TRUE;
+    }
+
+  if (font_queue_source == 0)
+    font_queue_source = g_idle_add_full (G_PRIORITY_LOW,
+                                         ptyxis_tab_font_queue_cb,
+                                         NULL, NULL);
 }
 
-static void
-ptyxis_tab_decrease_font_size_cb (PtyxisTab      *self,
-                                  PtyxisTerminal *terminal)
+static gboolean
+ptyxis_tab_pending_queue_cb (gpointer data)
 {
-  g_assert (PTYXIS_IS_TAB (self));
-  g_assert (PTYXIS_IS_TERMINAL (terminal));
+  PtyxisTab *self;
 
-  ptyxis_tab_zoom_out (self);
+  while ((self = g_queue_peek_head (&pending_queue)))
+    ptyxis_tab_flush_pending (self);
+
+  pending_queue_source = 0;
+
+  return G_SOURCE_REMOVE;
 }
 
+/*
+ * ptyxis_tab_queue_notify:
+ *
+ * Notifies @pspec immediately when the tab is visible. Otherwise the
+ * notification is deferred to a shared low-priority heartbeat so that
+ * a hidden tab receiving a flood of title or progress updates does not
+ * cause the tab bar to relayout for every one of them.
+ */
 static void
-ptyxis_tab_bell_cb (PtyxisTab      *self,
-                    PtyxisTerminal *terminal)
+ptyxis_tab_queue_notify (PtyxisTab  *self,
+                         GParamSpec *pspec)
 {
   g_assert (PTYXIS_IS_TAB (self));
-  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  if (!self->is_background)
+    {
+      g_object_notify_by_pspec (G_OBJECT (self), pspec);
+      return;
+    }
+
+  if (!ptyxis_tab_has_pending (self))
+    {
+      self->pending_link.data = self;
+      g_queue_push_tail_link (&pending_queue, &self->pending_link);
+    }
+
+  if (pspec == properties[PROP_TITLE])
+    self->pending_title = TRUE;
+  else if (pspec == properties[PROP_SUBTITLE])
+    self->pending_subtitle = TRUE;
+  else
+    self->pending_progress = TRUE;
+
+  /* Seconds based timeouts are aligned by GLib to the same point in
+   * each second so the heartbeat also shares its wakeup with others.
+   */
+  if (pending_queue_source == 0)
+    pending_queue_source = g_timeout_add_seconds_full (G_PRIORITY_LOW,
+                                                       BACKGROUND_HEARTBEAT_SECONDS,
+                                                       ptyxis_tab_pending_queue_cb,
+                                                       NULL, NULL);
+}
+
+static void
+ptyxis_tab_update_background (PtyxisTab *self)
+{
+  GtkRoot *root;
+  gboolean is_background;
+
+  g_assert (PTYXIS_IS_TAB (self));
+
+  root = gtk_widget_get_root (GTK_WIDGET (self));
+  is_background = !gtk_widget_get_mapped (GTK_WIDGET (self)) ||
+                  (GTK_IS_WINDOW (root) && gtk_window_is_suspended (GTK_WINDOW (root)));
+
+  if (is_background == self->is_background)
+    return;
+
+  self->is_background = is_background;
+  self->last_active_time = g_get_monotonic_time ();
+
+  if (self->monitor != NULL)
+    ptyxis_tab_monitor_set_background (self->monitor, is_background);
+
+  /* Catch up on anything that happened while we were hidden */
+  if (!is_background)
+    {
+      ptyxis_tab_flush_pending (self);
+      _ptyxis_tab_set_scrollback_override (self, 0);
+
+      if (self->pending_font)
+        ptyxis_tab_apply_font (self);
+    }
+  else
+    {
+      PtyxisScrollbackBudget *budget;
+
+      if ((budget = ptyxis_application_get_scrollback_budget (PTYXIS_APPLICATION_DEFAULT)))
+        ptyxis_scrollback_budget_queue_update (budget);
+    }
+}
+
+static void
+ptyxis_tab_window_notify_suspended_cb (PtyxisTab  *self,
+                                       GParamSpec *pspec,
+                                       GtkWindow  *window)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (GTK_IS_WINDOW (window));
+
+  ptyxis_tab_update_background (self);
+}
+
+static void
+ptyxis_tab_map (GtkWidget *widget)
+{
+  PtyxisTab *self = (PtyxisTab *)widget;
+
+  g_assert (PTYXIS_IS_TAB (widget));
+
+  GTK_WIDGET_CLASS (ptyxis_tab_parent_class)->map (widget);
+
+  ptyxis_tab_update_background (self);
+
+  if (self->state == PTYXIS_TAB_STATE_INITIAL)
+    ptyxis_tab_respawn (self);
+}
+
+static void
+ptyxis_tab_unmap (GtkWidget *widget)
+{
+  PtyxisTab *self = (PtyxisTab *)widget;
+
+  g_assert (PTYXIS_IS_TAB (widget));
+
+  GTK_WIDGET_CLASS (ptyxis_tab_parent_class)->unmap (widget);
+
+  ptyxis_tab_update_background (self);
+}
+
+static void
+ptyxis_tab_notify_contains_focus_cb (PtyxisTab               *self,
+                                     GParamSpec              *pspec,
+                                     GtkEventControllerFocus *focus)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (GTK_IS_EVENT_CONTROLLER_FOCUS (focus));
+
+  if (gtk_event_controller_focus_contains_focus (focus))
+    {
+      ptyxis_tab_set_needs_attention (self, FALSE);
+      g_application_withdraw_notification (G_APPLICATION (PTYXIS_APPLICATION_DEFAULT),
+                                           self->uuid);
+    }
+}
+
+static void
+ptyxis_tab_notify_window_title_cb (PtyxisTab      *self,
+                                   GParamSpec     *pspec,
+                                   PtyxisTerminal *terminal)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  ptyxis_tab_queue_notify (self, properties[PROP_TITLE]);
+}
+
+static void
+ptyxis_tab_shell_command_changed_cb (PtyxisTab      *self,
+                                     PtyxisTerminal *terminal)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  ptyxis_tab_queue_notify (self, properties[PROP_TITLE]);
+}
+
+static void
+ptyxis_tab_notify_window_subtitle_cb (PtyxisTab      *self,
+                                      PtyxisTerminal *terminal)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  ptyxis_tab_queue_notify (self, properties[PROP_SUBTITLE]);
+}
+
+static void
+ptyxis_tab_increase_font_size_cb (PtyxisTab      *self,
+                                  PtyxisTerminal *terminal)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  ptyxis_tab_zoom_in (self);
+}
+
+static void
+ptyxis_tab_decrease_font_size_cb (PtyxisTab      *self,
+                                  PtyxisTerminal *terminal)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  ptyxis_tab_zoom_out (self);
+}
+
+static void
+ptyxis_tab_bell_cb (PtyxisTab      *self,
+                    PtyxisTerminal *terminal)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
 
   g_signal_emit (self, signals[BELL], 0);
 }
@@ -739,6 +1227,17 @@ ptyxis_tab_update_scrollbar_policy (PtyxisTab *self)
     }
 }
 
+static void
+ptyxis_tab_notify_font_desc_cb (PtyxisTab      *self,
+                                GParamSpec     *pspec,
+                                PtyxisSettings *settings)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (PTYXIS_IS_SETTINGS (settings));
+
+  ptyxis_tab_queue_font (self);
+}
+
 static void
 ptyxis_tab_update_padding_cb (PtyxisTab      *self,
                               GParamSpec     *pspec,
@@ -767,6 +1266,22 @@ ptyxis_tab_update_word_char_exceptions (PtyxisTab      *self,
   vte_terminal_set_word_char_exceptions (VTE_TERMINAL (self->terminal), word_char_exceptions);
 }
 
+static void
+ptyxis_tab_broadcast_changed_cb (PtyxisTab       *self,
+                                 guint            group,
+                                 PtyxisBroadcast *broadcast)
+{
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (PTYXIS_IS_BROADCAST (broadcast));
+
+  if (group != ptyxis_broadcast_get_group (broadcast, self))
+    return;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BROADCAST_GROUP]);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BROADCAST_INPUT]);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INDICATOR_ICON]);
+}
+
 static void
 ptyxis_tab_constructed (GObject *object)
 {
@@ -788,9 +1303,6 @@ ptyxis_tab_constructed (GObject *object)
   g_object_bind_property (settings, "enable-a11y",
                           self->terminal, "enable-a11y",
                           G_BINDING_SYNC_CREATE);
-  g_object_bind_property (settings, "font-desc",
-                          self->terminal, "font-desc",
-                          G_BINDING_SYNC_CREATE);
   g_object_bind_property (settings, "text-blink-mode",
                           self->terminal, "text-blink-mode",
                           G_BINDING_SYNC_CREATE);
@@ -798,6 +1310,13 @@ ptyxis_tab_constructed (GObject *object)
                           self, "ignore-osc-title",
                           G_BINDING_SYNC_CREATE);
 
+  g_signal_connect_object (settings,
+                           "notify::font-desc",
+                           G_CALLBACK (ptyxis_tab_notify_font_desc_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+  ptyxis_tab_apply_font (self);
+
   g_signal_connect_object (settings,
                            "notify::disable-padding",
                            G_CALLBACK (ptyxis_tab_update_padding_cb),
@@ -836,6 +1355,18 @@ ptyxis_tab_constructed (GObject *object)
                            G_CONNECT_SWAPPED);
   ptyxis_tab_update_cell_height_scale (self);
 
+  g_signal_connect_object (G_OBJECT (self->profile),
+                           "notify::log-output",
+                           G_CALLBACK (ptyxis_tab_update_output_log),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (G_OBJECT (self->profile),
+                           "notify::log-compress",
+                           G_CALLBACK (ptyxis_tab_update_output_log),
+                           self,
+                           G_CONNECT_SWAPPED);
+  ptyxis_tab_update_output_log (self);
+
   g_signal_connect_object (settings,
                            "notify::word-char-exceptions",
                            G_CALLBACK (ptyxis_tab_update_word_char_exceptions),
@@ -844,6 +1375,7 @@ ptyxis_tab_constructed (GObject *object)
   ptyxis_tab_update_word_char_exceptions (self, NULL, settings);
 
   self->monitor = ptyxis_tab_monitor_new (self);
+  ptyxis_tab_monitor_set_background (self->monitor, self->is_background);
 }
 
 static void
@@ -951,9 +1483,20 @@ ptyxis_tab_invalidate_progress (PtyxisTab *self)
 {
   g_assert (PTYXIS_IS_TAB (self));
 
+  if (self->is_background)
+    {
+      ptyxis_tab_queue_notify (self, properties[PROP_PROGRESS]);
+      return;
+    }
+
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PROGRESS]);
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PROGRESS_FRACTION]);
-  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INDICATOR_ICON]);
+
+  /* Avoid replacing the tab icon (and relayout of the tab bar) unless
+   * the drawing would actually change.
+   */
+  if (ptyxis_tab_update_indicator_key (self))
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INDICATOR_ICON]);
 }
 
 static gboolean
@@ -978,6 +1521,41 @@ ptyxis_tab_match_clicked_cb (PtyxisTab       *self,
   return FALSE;
 }
 
+static void
+ptyxis_tab_notify_paste_cb (PtyxisTab      *self,
+                            GParamSpec     *pspec,
+                            PtyxisTerminal *terminal)
+{
+  g_autofree char *title = NULL;
+  int percent;
+
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  if (!ptyxis_terminal_get_pasting (terminal))
+    {
+      self->paste_percent = -1;
+      if (self->paste_banner != NULL)
+        gtk_widget_set_visible (GTK_WIDGET (self->paste_banner), FALSE);
+      return;
+    }
+
+  /* Only update the banner when the visible value changes as this is
+   * notified for every chunk written to the PTY.
+   */
+  percent = ptyxis_terminal_get_paste_fraction (terminal) * 100;
+  if (percent == self->paste_percent)
+    return;
+
+  self->paste_percent = percent;
+
+  /* translators: %d is the percentage of the paste which has been written */
+  title = g_strdup_printf (_("Pasting… %d%%"), percent);
+  ptyxis_tab_ensure_paste_banner (self);
+  adw_banner_set_title (self->paste_banner, title);
+  gtk_widget_set_visible (GTK_WIDGET (self->paste_banner), TRUE);
+}
+
 static void
 ptyxis_tab_root (GtkWidget *widget)
 {
@@ -989,6 +1567,27 @@ ptyxis_tab_root (GtkWidget *widget)
   self->ignore_snapshot = FALSE;
 
   GTK_WIDGET_CLASS (ptyxis_tab_parent_class)->root (widget);
+
+  /* Minimized or otherwise suspended windows put all of their
+   * tabs into background mode, not just the unmapped ones.
+   */
+  g_signal_connect_object (gtk_widget_get_root (widget),
+                           "notify::suspended",
+                           G_CALLBACK (ptyxis_tab_window_notify_suspended_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+}
+
+static void
+ptyxis_tab_unroot (GtkWidget *widget)
+{
+  PtyxisTab *self = PTYXIS_TAB (widget);
+
+  g_signal_handlers_disconnect_by_func (gtk_widget_get_root (widget),
+                                        G_CALLBACK (ptyxis_tab_window_notify_suspended_cb),
+                                        self);
+
+  GTK_WIDGET_CLASS (ptyxis_tab_parent_class)->unroot (widget);
 }
 
 static void
@@ -999,12 +1598,57 @@ ptyxis_tab_dispose (GObject *object)
 
   g_debug ("Disposing tab");
 
+  g_cancellable_cancel (self->cancellable);
+
+  if (!g_queue_is_empty (&self->spawn_tasks))
+    {
+      g_autoptr(GError) error = g_error_new_literal (G_IO_ERROR, G_IO_ERROR_CANCELLED, "The tab was closed");
+      ptyxis_tab_complete_spawn (self, error);
+    }
+
   ptyxis_tab_notify_destroy (&self->notify);
 
+  if (ptyxis_tab_has_pending (self))
+    {
+      g_queue_unlink (&pending_queue, &self->pending_link);
+      self->pending_title = FALSE;
+      self->pending_subtitle = FALSE;
+      self->pending_progress = FALSE;
+    }
+
+  if (self->pending_font)
+    {
+      g_queue_unlink (&font_queue, &self->font_link);
+      self->pending_font = FALSE;
+    }
+
+  if (PTYXIS_APPLICATION_DEFAULT != NULL)
+    {
+      PtyxisScrollbackBudget *budget;
+
+      if ((budget = ptyxis_application_get_scrollback_budget (PTYXIS_APPLICATION_DEFAULT)))
+        ptyxis_scrollback_budget_remove_tab (budget, self);
+    }
+
   ptyxis_tab_force_quit (self);
 
+  if (PTYXIS_APPLICATION_DEFAULT != NULL)
+    {
+      PtyxisBroadcast *broadcast;
+
+      if ((broadcast = ptyxis_application_get_broadcast (PTYXIS_APPLICATION_DEFAULT)))
+        ptyxis_broadcast_remove_tab (broadcast, self);
+    }
+
+  /* Flush the log while the terminal contents are still available */
+  g_clear_object (&self->output_log);
+
   gtk_widget_dispose_template (GTK_WIDGET (self), PTYXIS_TYPE_TAB);
 
+  /* Banners are created on demand and owned by the template's box */
+  self->banner = NULL;
+  self->paste_banner = NULL;
+
   while ((child = gtk_widget_get_first_child (GTK_WIDGET (self))))
     gtk_widget_unparent (child);
 
@@ -1013,6 +1657,7 @@ ptyxis_tab_dispose (GObject *object)
   g_clear_object (&self->process);
   g_clear_object (&self->monitor);
   g_clear_object (&self->container_at_creation);
+  g_clear_object (&self->cancellable);
 
   g_clear_pointer (&self->initial_working_directory_uri, g_free);
   g_clear_pointer (&self->previous_working_directory_uri, g_free);
@@ -1045,6 +1690,14 @@ ptyxis_tab_get_property (GObject    *object,
 
   switch (prop_id)
     {
+    case PROP_BROADCAST_GROUP:
+      g_value_set_uint (value, ptyxis_tab_get_broadcast_group (self));
+      break;
+
+    case PROP_BROADCAST_INPUT:
+      g_value_set_boolean (value, ptyxis_tab_get_broadcast_input (self));
+      break;
+
     case PROP_COMMAND_LINE:
       g_value_set_string (value, self->command_line);
       break;
@@ -1120,6 +1773,14 @@ ptyxis_tab_set_property (GObject      *object,
 
   switch (prop_id)
     {
+    case PROP_BROADCAST_GROUP:
+      ptyxis_tab_set_broadcast_group (self, g_value_get_uint (value));
+      break;
+
+    case PROP_BROADCAST_INPUT:
+      ptyxis_tab_set_broadcast_input (self, g_value_get_boolean (value));
+      break;
+
     case PROP_IGNORE_OSC_TITLE:
       ptyxis_tab_set_ignore_osc_title (self, g_value_get_boolean (value));
       break;
@@ -1159,9 +1820,25 @@ ptyxis_tab_class_init (PtyxisTabClass *klass)
 
   widget_class->grab_focus = ptyxis_tab_grab_focus;
   widget_class->map = ptyxis_tab_map;
+  widget_class->unmap = ptyxis_tab_unmap;
   widget_class->snapshot = ptyxis_tab_snapshot;
   widget_class->size_allocate = ptyxis_tab_size_allocate;
   widget_class->root = ptyxis_tab_root;
+  widget_class->unroot = ptyxis_tab_unroot;
+
+  properties[PROP_BROADCAST_GROUP] =
+    g_param_spec_uint ("broadcast-group", NULL, NULL,
+                       0, PTYXIS_BROADCAST_N_GROUPS, 0,
+                       (G_PARAM_READWRITE |
+                        G_PARAM_EXPLICIT_NOTIFY |
+                        G_PARAM_STATIC_STRINGS));
+
+  properties[PROP_BROADCAST_INPUT] =
+    g_param_spec_boolean ("broadcast-input", NULL, NULL,
+                          FALSE,
+                          (G_PARAM_READWRITE |
+                           G_PARAM_EXPLICIT_NOTIFY |
+                           G_PARAM_STATIC_STRINGS));
 
   properties[PROP_COMMAND_LINE] =
     g_param_spec_string ("command-line", NULL, NULL,
@@ -1276,13 +1953,14 @@ ptyxis_tab_class_init (PtyxisTabClass *klass)
   gtk_widget_class_set_layout_manager_type (widget_class, GTK_TYPE_BIN_LAYOUT);
   gtk_widget_class_set_css_name (widget_class, "ptyxistab");
 
-  gtk_widget_class_bind_template_child (widget_class, PtyxisTab, banner);
+  gtk_widget_class_bind_template_child (widget_class, PtyxisTab, box);
   gtk_widget_class_bind_template_child (widget_class, PtyxisTab, terminal);
   gtk_widget_class_bind_template_child (widget_class, PtyxisTab, scrolled_window);
 
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_tab_notify_contains_focus_cb);
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_tab_notify_window_title_cb);
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_tab_notify_window_subtitle_cb);
+  gtk_widget_class_bind_template_callback (widget_class, ptyxis_tab_shell_command_changed_cb);
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_tab_increase_font_size_cb);
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_tab_decrease_font_size_cb);
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_tab_notify_palette_cb);
@@ -1290,6 +1968,7 @@ ptyxis_tab_class_init (PtyxisTabClass *klass)
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_tab_invalidate_icon);
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_tab_invalidate_progress);
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_tab_match_clicked_cb);
+  gtk_widget_class_bind_template_callback (widget_class, ptyxis_tab_notify_paste_cb);
 
   gtk_widget_class_install_action (widget_class, "tab.respawn", NULL, ptyxis_tab_respawn_action);
   gtk_widget_class_install_action (widget_class, "tab.inspect", NULL, ptyxis_tab_inspect_action);
@@ -1305,6 +1984,10 @@ ptyxis_tab_init (PtyxisTab *self)
   self->state = PTYXIS_TAB_STATE_INITIAL;
   self->zoom = PTYXIS_ZOOM_LEVEL_DEFAULT;
   self->uuid = g_uuid_string_random ();
+  self->is_background = TRUE;
+  self->last_active_time = g_get_monotonic_time ();
+  self->cancellable = g_cancellable_new ();
+  self->paste_percent = -1;
 
   gtk_widget_init_template (GTK_WIDGET (self));
 
@@ -1339,11 +2022,16 @@ ptyxis_tab_init (PtyxisTab *self)
 PtyxisTab *
 ptyxis_tab_new (PtyxisProfile *profile)
 {
+  PtyxisTab *self;
+
   g_return_val_if_fail (PTYXIS_IS_PROFILE (profile), NULL);
 
-  return g_object_new (PTYXIS_TYPE_TAB,
+  self = g_object_new (PTYXIS_TYPE_TAB,
                        "profile", profile,
                        NULL);
+  _ptyxis_tab_register (self);
+
+  return self;
 }
 
 /**
@@ -1389,10 +2077,13 @@ ptyxis_tab_set_title_prefix (PtyxisTab  *self,
 char *
 ptyxis_tab_dup_title (PtyxisTab *self)
 {
+  const PtyxisCommand *running;
   GString *gstr;
 
   g_return_val_if_fail (PTYXIS_IS_TAB (self), NULL);
 
+  running = ptyxis_command_history_get_running (_ptyxis_terminal_get_command_history (self->terminal));
+
   gstr = g_string_new (self->title_prefix);
 
   if (!self->ignore_osc_title)
@@ -1418,6 +2109,8 @@ ptyxis_tab_dup_title (PtyxisTab *self)
     g_string_append_printf (gstr, " (%s)", _("Exited"));
   else if (self->state == PTYXIS_TAB_STATE_FAILED)
     g_string_append_printf (gstr, " (%s)", _("Failed"));
+  else if (running != NULL && !ptyxis_str_empty0 (running->command_line))
+    g_string_append_printf (gstr, " — %s", running->command_line);
   else if (self->has_foreground_process &&
            !ptyxis_str_empty0 (self->command_line) &&
            !ptyxis_str_empty0 (self->program_name) &&
@@ -1697,6 +2390,7 @@ ptyxis_tab_show_banner (PtyxisTab *self)
 {
   g_return_if_fail (PTYXIS_IS_TAB (self));
 
+  ptyxis_tab_ensure_banner (self);
   gtk_widget_set_visible (GTK_WIDGET (self->banner), TRUE);
 }
 
@@ -1985,36 +2679,26 @@ ptyxis_tab_open_uri_cb (GObject      *object,
     ptyxis_tab_toast (self, 3, _("Failed to open link"));
 }
 
-void
-ptyxis_tab_open_uri (PtyxisTab  *self,
-                     const char *uri)
+static void
+ptyxis_tab_open_translated_uri (PtyxisTab  *self,
+                                const char *uri)
 {
   g_autofree char *translated = NULL;
   GtkWindow *window;
   XdpParent *parent;
 
-  g_return_if_fail (PTYXIS_IS_TAB (self));
-  g_return_if_fail (uri != NULL);
+  g_assert (PTYXIS_IS_TAB (self));
+  g_assert (uri != NULL);
 
   window = GTK_WINDOW (gtk_widget_get_root (GTK_WIDGET (self)));
 
+  if (window == NULL)
+    return;
+
   if (g_str_has_prefix (uri, "file://"))
     {
-      g_autoptr(PtyxisIpcContainer) container = ptyxis_tab_dup_container (self);
       g_autoptr(GUri) guri = NULL;
 
-      if (container == NULL)
-        {
-          g_autofree char *default_container = ptyxis_profile_dup_default_container (self->profile);
-          container = ptyxis_application_lookup_container (PTYXIS_APPLICATION_DEFAULT, default_container);
-        }
-
-      if (container != NULL)
-        {
-          if (ptyxis_ipc_container_call_translate_uri_sync (container, uri, &translated, NULL, NULL))
-            uri = translated;
-        }
-
       if (ptyxis_get_process_kind () == PTYXIS_PROCESS_KIND_FLATPAK &&
           (guri = g_uri_parse (uri, 0, NULL)) &&
           !g_str_has_prefix (g_uri_get_path (guri), g_get_home_dir ()))
@@ -2032,7 +2716,6 @@ ptyxis_tab_open_uri (PtyxisTab  *self,
                                    g_uri_get_query (guri),
                                    g_uri_get_fragment (guri));
 
-          g_clear_pointer (&translated, g_free);
           uri = translated = g_uri_to_string (rewritten);
         }
     }
@@ -2050,44 +2733,185 @@ ptyxis_tab_open_uri (PtyxisTab  *self,
                        g_object_ref (self));
   xdp_parent_free (parent);
 }
-#else
-void
-ptyxis_tab_open_uri (PtyxisTab  *self,
-                     const char *uri)
+
+typedef struct _TranslateUri
 {
-  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
-  gtk_show_uri (GTK_WINDOW (gtk_widget_get_root (GTK_WIDGET (self))), uri, 0);
+  PtyxisTab *self;
+  char      *uri;
+} TranslateUri;
+
+static void
+translate_uri_free (TranslateUri *state)
+{
+  g_clear_object (&state->self);
+  g_clear_pointer (&state->uri, g_free);
+  g_free (state);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (TranslateUri, translate_uri_free)
+
+static void
+ptyxis_tab_translate_uri_cb (GObject      *object,
+                             GAsyncResult *result,
+                             gpointer      user_data)
+{
+  PtyxisIpcContainer *container = (PtyxisIpcContainer *)object;
+  g_autoptr(TranslateUri) state = user_data;
+  g_autofree char *translated = NULL;
+  g_autoptr(GError) error = NULL;
+  const char *uri;
+
+  g_assert (PTYXIS_IPC_IS_CONTAINER (container));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (state != NULL);
+  g_assert (PTYXIS_IS_TAB (state->self));
+  g_assert (state->uri != NULL);
+
+  if (!ptyxis_ipc_container_call_translate_uri_finish (container, &translated, result, &error))
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+      uri = state->uri;
+    }
+  else
+    {
+      uri = translated;
+    }
+
+  ptyxis_tab_open_translated_uri (state->self, uri);
+}
+
+void
+ptyxis_tab_open_uri (PtyxisTab  *self,
+                     const char *uri)
+{
+  g_autoptr(PtyxisIpcContainer) container = NULL;
+  TranslateUri *state;
+
+  g_return_if_fail (PTYXIS_IS_TAB (self));
+  g_return_if_fail (uri != NULL);
+
+  if (!g_str_has_prefix (uri, "file://"))
+    {
+      ptyxis_tab_open_translated_uri (self, uri);
+      return;
+    }
+
+  if (!(container = ptyxis_tab_dup_container (self)))
+    {
+      g_autofree char *default_container = ptyxis_profile_dup_default_container (self->profile);
+      container = ptyxis_application_lookup_container (PTYXIS_APPLICATION_DEFAULT, default_container);
+    }
+
+  if (container == NULL)
+    {
+      ptyxis_tab_open_translated_uri (self, uri);
+      return;
+    }
+
+  /* The container may need to translate the path to one that is
+   * reachable from the host, which requires a round-trip to the agent.
+   */
+  state = g_new0 (TranslateUri, 1);
+  state->self = g_object_ref (self);
+  state->uri = g_strdup (uri);
+
+  ptyxis_ipc_container_call_translate_uri (container,
+                                           uri,
+                                           self->cancellable,
+                                           ptyxis_tab_translate_uri_cb,
+                                           state);
+}
+#else
+void
+ptyxis_tab_open_uri (PtyxisTab  *self,
+                     const char *uri)
+{
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+  gtk_show_uri (GTK_WINDOW (gtk_widget_get_root (GTK_WIDGET (self))), uri, 0);
   G_GNUC_END_IGNORE_DEPRECATIONS
 }
 #endif
 
-char *
-ptyxis_tab_query_working_directory_from_agent (PtyxisTab *self)
+static void
+ptyxis_tab_query_working_directory_cb (GObject      *object,
+                                       GAsyncResult *result,
+                                       gpointer      user_data)
 {
+  PtyxisIpcProcess *process = (PtyxisIpcProcess *)object;
   g_autofree char *path = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GTask) task = user_data;
+
+  g_assert (PTYXIS_IPC_IS_PROCESS (process));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (G_IS_TASK (task));
+
+  if (!ptyxis_ipc_process_call_get_working_directory_finish (process, &path, NULL, result, &error))
+    g_task_return_error (task, g_steal_pointer (&error));
+  else
+    g_task_return_pointer (task, g_steal_pointer (&path), g_free);
+}
+
+void
+ptyxis_tab_query_working_directory_from_agent_async (PtyxisTab           *self,
+                                                     GCancellable        *cancellable,
+                                                     GAsyncReadyCallback  callback,
+                                                     gpointer             user_data)
+{
   g_autoptr(GUnixFDList) fd_list = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GTask) task = NULL;
   VtePty *pty;
-  int pty_fd;
   int handle;
 
-  g_return_val_if_fail (PTYXIS_IS_TAB (self), NULL);
+  g_return_if_fail (PTYXIS_IS_TAB (self));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  if (self->process == NULL)
-    return NULL;
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, ptyxis_tab_query_working_directory_from_agent_async);
+
+  if (self->process == NULL ||
+      !(pty = vte_terminal_get_pty (VTE_TERMINAL (self->terminal))))
+    {
+      g_task_return_new_error (task,
+                               G_IO_ERROR,
+                               G_IO_ERROR_NOT_CONNECTED,
+                               "No process is running");
+      return;
+    }
 
-  pty = vte_terminal_get_pty (VTE_TERMINAL (self->terminal));
-  pty_fd = vte_pty_get_fd (pty);
   fd_list = g_unix_fd_list_new ();
-  handle = g_unix_fd_list_append (fd_list, pty_fd, NULL);
+  if (-1 == (handle = g_unix_fd_list_append (fd_list, vte_pty_get_fd (pty), &error)))
+    {
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
+    }
 
-  if (ptyxis_ipc_process_call_get_working_directory_sync (self->process,
-                                                          g_variant_new_handle (handle),
-                                                          fd_list,
-                                                          &path,
-                                                          NULL, NULL, NULL))
-    return g_steal_pointer (&path);
+  ptyxis_ipc_process_call_get_working_directory (self->process,
+                                                 g_variant_new_handle (handle),
+                                                 fd_list,
+                                                 cancellable,
+                                                 ptyxis_tab_query_working_directory_cb,
+                                                 g_steal_pointer (&task));
+}
 
-  return NULL;
+/**
+ * ptyxis_tab_query_working_directory_from_agent_finish:
+ *
+ * Returns: (transfer full): the working directory path or %NULL and
+ *   @error is set
+ */
+char *
+ptyxis_tab_query_working_directory_from_agent_finish (PtyxisTab     *self,
+                                                      GAsyncResult  *result,
+                                                      GError       **error)
+{
+  g_return_val_if_fail (PTYXIS_IS_TAB (self), NULL);
+  g_return_val_if_fail (G_IS_TASK (result), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 PtyxisTabProgress
@@ -2192,7 +3016,8 @@ G_GNUC_END_IGNORE_DEPRECATIONS
  * ptyxis_tab_dup_indicator_icon:
  * @self: a #PtyxisTab
  *
- * Gets the progress indicator icon.
+ * Gets the indicator icon, showing progress or that input to the tab
+ * is being broadcast to its group.
  *
  * Due to libadwaita not providing a way to do progress natively (as of 1.6)
  * this uses indicator icon to generate a progress icon using a drawing.
@@ -2211,23 +3036,53 @@ ptyxis_tab_dup_indicator_icon (PtyxisTab *self)
   if (progress == PTYXIS_TAB_PROGRESS_ERROR)
     return g_themed_icon_new ("dialog-error-symbolic");
 
+  if (progress != PTYXIS_TAB_PROGRESS_ACTIVE &&
+      ptyxis_tab_get_broadcast_input (self))
+    return g_themed_icon_new ("input-keyboard-symbolic");
+
   if (progress == PTYXIS_TAB_PROGRESS_INDETERMINATE)
     return NULL;
 
   if (progress == PTYXIS_TAB_PROGRESS_ACTIVE)
     {
-      g_autoptr(GdkTexture) texture = NULL;
       g_autoptr(GBytes) bytes = NULL;
+      GtkStyleContext *style_context;
       cairo_surface_t *surface;
+      GdkTexture *texture;
       cairo_t *cr;
-      double fraction;
+      GdkRGBA rgba;
+      gint64 key;
+      guint bucket;
       int stride;
       int scale;
       int width;
       int height;
 
-      fraction = ptyxis_tab_get_progress_fraction (self);
+      bucket = ptyxis_tab_get_progress_bucket (self);
       scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
+
+      G_GNUC_BEGIN_IGNORE_DEPRECATIONS {
+        style_context = gtk_widget_get_style_context (GTK_WIDGET (self));
+        gtk_style_context_get_color (style_context, &rgba);
+      } G_GNUC_END_IGNORE_DEPRECATIONS
+
+      /* Textures are shared by every tab with the same step, scale and
+       * foreground color so that many tabs reporting progress do not
+       * each render and upload their own.
+       */
+      key = ((gint64)bucket << 40) |
+            ((gint64)MIN (scale, 0xFF) << 32) |
+            ((gint64)(guint8)(rgba.red * 255) << 24) |
+            ((gint64)(guint8)(rgba.green * 255) << 16) |
+            ((gint64)(guint8)(rgba.blue * 255) << 8) |
+            (gint64)(guint8)(rgba.alpha * 255);
+
+      if (indicator_cache == NULL)
+        indicator_cache = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, g_object_unref);
+
+      if ((texture = g_hash_table_lookup (indicator_cache, &key)))
+        return G_ICON (g_object_ref (texture));
+
       width = 16 * scale;
       height = 16 * scale;
 
@@ -2236,23 +3091,125 @@ ptyxis_tab_dup_indicator_icon (PtyxisTab *self)
       cr = cairo_create (surface);
 
       G_GNUC_BEGIN_IGNORE_DEPRECATIONS {
-        GtkStyleContext *style_context = gtk_widget_get_style_context (GTK_WIDGET (self));
-        draw_progress (cr, style_context, width, height, fraction);
+        draw_progress (cr, style_context, width, height, bucket / (double)PROGRESS_BUCKETS);
       } G_GNUC_END_IGNORE_DEPRECATIONS
 
       cairo_destroy (cr);
+      cairo_surface_flush (surface);
 
       bytes = g_bytes_new (cairo_image_surface_get_data (surface), height * stride);
       texture = gdk_memory_texture_new (width, height, GDK_MEMORY_DEFAULT, bytes, stride);
 
       cairo_surface_destroy (surface);
 
-      return G_ICON (g_steal_pointer (&texture));
+      if (g_hash_table_size (indicator_cache) >= MAX_CACHED_INDICATORS)
+        g_hash_table_remove_all (indicator_cache);
+
+      g_hash_table_insert (indicator_cache,
+                           g_memdup2 (&key, sizeof key),
+                           g_object_ref (texture));
+
+      return G_ICON (texture);
     }
 
   return NULL;
 }
 
+/**
+ * ptyxis_tab_get_broadcast_group:
+ * @self: a #PtyxisTab
+ *
+ * Gets the broadcast group @self belongs to.
+ *
+ * Returns: a group number, or 0 if @self is not in a group
+ */
+guint
+ptyxis_tab_get_broadcast_group (PtyxisTab *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_TAB (self), 0);
+
+  return ptyxis_broadcast_get_group (ptyxis_application_get_broadcast (PTYXIS_APPLICATION_DEFAULT), self);
+}
+
+void
+ptyxis_tab_set_broadcast_group (PtyxisTab *self,
+                                guint      group)
+{
+  PtyxisBroadcast *broadcast;
+  guint old_group;
+
+  g_return_if_fail (PTYXIS_IS_TAB (self));
+  g_return_if_fail (group <= PTYXIS_BROADCAST_N_GROUPS);
+
+  broadcast = ptyxis_application_get_broadcast (PTYXIS_APPLICATION_DEFAULT);
+  old_group = ptyxis_broadcast_get_group (broadcast, self);
+
+  ptyxis_broadcast_set_group (broadcast, self, group);
+
+  /* Leaving a group is not announced to us by ::changed since we are
+   * no longer a member by the time it is emitted.
+   */
+  if (old_group != 0 && group == 0)
+    {
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BROADCAST_GROUP]);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BROADCAST_INPUT]);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INDICATOR_ICON]);
+    }
+}
+
+/**
+ * ptyxis_tab_get_broadcast_input:
+ * @self: a #PtyxisTab
+ *
+ * Gets whether input to @self is written to every tab in its group.
+ *
+ * Returns: %TRUE if input is broadcast
+ */
+gboolean
+ptyxis_tab_get_broadcast_input (PtyxisTab *self)
+{
+  PtyxisBroadcast *broadcast;
+
+  g_return_val_if_fail (PTYXIS_IS_TAB (self), FALSE);
+
+  broadcast = ptyxis_application_get_broadcast (PTYXIS_APPLICATION_DEFAULT);
+
+  return ptyxis_broadcast_get_enabled (broadcast, ptyxis_broadcast_get_group (broadcast, self));
+}
+
+/**
+ * ptyxis_tab_set_broadcast_input:
+ * @self: a #PtyxisTab
+ * @broadcast_input: if input should be broadcast
+ *
+ * Sets whether input is broadcast to every tab in the group of @self.
+ *
+ * This affects all members of the group. If @self is not in a group,
+ * it is placed in the first group.
+ */
+void
+ptyxis_tab_set_broadcast_input (PtyxisTab *self,
+                                gboolean   broadcast_input)
+{
+  PtyxisBroadcast *broadcast;
+  guint group;
+
+  g_return_if_fail (PTYXIS_IS_TAB (self));
+
+  broadcast = ptyxis_application_get_broadcast (PTYXIS_APPLICATION_DEFAULT);
+
+  if (!(group = ptyxis_broadcast_get_group (broadcast, self)))
+    {
+      if (!broadcast_input)
+        return;
+
+      group = 1;
+      ptyxis_broadcast_set_group (broadcast, self, group);
+    }
+
+  ptyxis_broadcast_set_enabled (broadcast, group, broadcast_input);
+}
+
 gboolean
 ptyxis_tab_get_ignore_osc_title (PtyxisTab *self)
 {
@@ -2284,3 +3241,232 @@ _ptyxis_tab_ignore_snapshot (PtyxisTab *self)
 
   self->ignore_snapshot = TRUE;
 }
+
+gint64
+_ptyxis_tab_get_last_active_time (PtyxisTab *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_TAB (self), 0);
+
+  if (!self->is_background)
+    return g_get_monotonic_time ();
+
+  return self->last_active_time;
+}
+
+gboolean
+_ptyxis_tab_is_background (PtyxisTab *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_TAB (self), FALSE);
+
+  return self->is_background;
+}
+
+/*
+ * _ptyxis_tab_get_scrollback_usage:
+ * @self: a #PtyxisTab
+ * @n_lines: (out) (nullable): location for number of lines
+ *
+ * Estimates how much memory the scrollback of @self is using. VTE does
+ * not expose this directly, so it is derived from the scroll range and
+ * the column count.
+ *
+ * Returns: the approximate number of bytes used
+ */
+guint64
+_ptyxis_tab_get_scrollback_usage (PtyxisTab *self,
+                                  guint     *n_lines)
+{
+  gint64 first_row;
+  gint64 end_row;
+  gint64 lines;
+  glong columns;
+
+  g_return_val_if_fail (PTYXIS_IS_TAB (self), 0);
+
+  ptyxis_vte_get_row_bounds (VTE_TERMINAL (self->terminal), &first_row, NULL, &end_row);
+  lines = end_row - first_row;
+  columns = vte_terminal_get_column_count (VTE_TERMINAL (self->terminal));
+
+  if (lines < 0)
+    lines = 0;
+
+  if (n_lines != NULL)
+    *n_lines = lines;
+
+  return (guint64)lines * MAX (columns, 1) * SCROLLBACK_BYTES_PER_CELL;
+}
+
+/*
+ * _ptyxis_tab_set_scrollback_override:
+ * @self: a #PtyxisTab
+ * @scrollback_lines: the maximum number of lines, or 0 to unset
+ *
+ * Temporarily limits the scrollback of @self below what the profile
+ * allows. This is used by #PtyxisScrollbackBudget to shrink background
+ * tabs and is cleared when the tab is shown again.
+ */
+void
+_ptyxis_tab_set_scrollback_override (PtyxisTab *self,
+                                     long       scrollback_lines)
+{
+  g_return_if_fail (PTYXIS_IS_TAB (self));
+
+  if (scrollback_lines < 0)
+    scrollback_lines = 0;
+
+  if (self->scrollback_override != scrollback_lines)
+    {
+      self->scrollback_override = scrollback_lines;
+      ptyxis_tab_update_scrollback_lines (self);
+    }
+}
+
+/*
+ * _ptyxis_tab_prefetch:
+ * @self: a #PtyxisTab
+ * @like: the #PtyxisTab currently visible in the same window
+ *
+ * Prepares a hidden @self to be shown in place of @like by matching its
+ * grid size ahead of time. VTE reflows the whole scrollback when the
+ * grid changes, which is the most expensive part of showing a tab that
+ * was last allocated at another size.
+ *
+ * Nothing is done unless both terminals use the same cell size, since
+ * the grid would be recalculated on allocation anyway. Tabs that have
+ * not spawned yet are left alone so that no process is started.
+ *
+ * Returns: %TRUE if the grid of @self was changed
+ */
+gboolean
+_ptyxis_tab_prefetch (PtyxisTab *self,
+                      PtyxisTab *like)
+{
+  VteTerminal *terminal;
+  VteTerminal *like_terminal;
+  glong columns;
+  glong rows;
+
+  g_return_val_if_fail (PTYXIS_IS_TAB (self), FALSE);
+  g_return_val_if_fail (PTYXIS_IS_TAB (like), FALSE);
+
+  if (self == like ||
+      !self->is_background ||
+      self->state != PTYXIS_TAB_STATE_RUNNING)
+    return FALSE;
+
+  terminal = VTE_TERMINAL (self->terminal);
+  like_terminal = VTE_TERMINAL (like->terminal);
+
+  if (vte_terminal_get_char_width (terminal) != vte_terminal_get_char_width (like_terminal) ||
+      vte_terminal_get_char_height (terminal) != vte_terminal_get_char_height (like_terminal))
+    return FALSE;
+
+  columns = vte_terminal_get_column_count (like_terminal);
+  rows = vte_terminal_get_row_count (like_terminal);
+
+  if (columns == vte_terminal_get_column_count (terminal) &&
+      rows == vte_terminal_get_row_count (terminal))
+    return FALSE;
+
+  vte_terminal_set_size (terminal, columns, rows);
+
+  return TRUE;
+}
+
+/*
+ * _ptyxis_tab_needs_spawn:
+ * @self: a #PtyxisTab
+ *
+ * Checks if the process for @self has not been spawned yet, nor is it
+ * being spawned.
+ *
+ * Returns: %TRUE if nothing has been spawned for @self
+ */
+gboolean
+_ptyxis_tab_needs_spawn (PtyxisTab *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_TAB (self), FALSE);
+
+  return self->state == PTYXIS_TAB_STATE_INITIAL;
+}
+
+/**
+ * _ptyxis_tab_spawn_async:
+ * @self: a #PtyxisTab
+ *
+ * Spawns the process for @self now rather than waiting for the tab to
+ * be mapped.
+ *
+ * If the process is already running, or has exited, the operation
+ * completes immediately. If it is being spawned, this waits for that.
+ */
+void
+_ptyxis_tab_spawn_async (PtyxisTab           *self,
+                         GCancellable        *cancellable,
+                         GAsyncReadyCallback  callback,
+                         gpointer             user_data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (PTYXIS_IS_TAB (self));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, _ptyxis_tab_spawn_async);
+
+  if (self->state == PTYXIS_TAB_STATE_INITIAL ||
+      self->state == PTYXIS_TAB_STATE_SPAWNING)
+    {
+      g_queue_push_tail (&self->spawn_tasks, g_steal_pointer (&task));
+
+      if (self->state == PTYXIS_TAB_STATE_INITIAL)
+        ptyxis_tab_respawn (self);
+
+      return;
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+gboolean
+_ptyxis_tab_spawn_finish (PtyxisTab     *self,
+                          GAsyncResult  *result,
+                          GError       **error)
+{
+  g_return_val_if_fail (PTYXIS_IS_TAB (self), FALSE);
+  g_return_val_if_fail (G_IS_TASK (result), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/*
+ * _ptyxis_tab_register:
+ * @self: a #PtyxisTab
+ *
+ * Registers @self with the application-wide scrollback budget and
+ * broadcast groups, and starts the output log if the profile wants one.
+ *
+ * Tabs created by ptyxis_tab_new() are registered right away, while
+ * the tab pool defers this until the tab is handed out so that hidden
+ * tabs cost nothing beyond their widgets.
+ */
+void
+_ptyxis_tab_register (PtyxisTab *self)
+{
+  g_return_if_fail (PTYXIS_IS_TAB (self));
+
+  if (self->registered)
+    return;
+
+  self->registered = TRUE;
+
+  ptyxis_scrollback_budget_add_tab (ptyxis_application_get_scrollback_budget (PTYXIS_APPLICATION_DEFAULT), self);
+
+  g_signal_connect_object (ptyxis_application_get_broadcast (PTYXIS_APPLICATION_DEFAULT),
+                           "changed",
+                           G_CALLBACK (ptyxis_tab_broadcast_changed_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  ptyxis_tab_update_output_log (self);
+}
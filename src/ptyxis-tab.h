@@ -80,6 +80,12 @@ void                ptyxis_tab_set_command                        (PtyxisTab
 GIcon              *ptyxis_tab_dup_indicator_icon                 (PtyxisTab            *self);
 char               *ptyxis_tab_dup_subtitle                       (PtyxisTab            *self);
 char               *ptyxis_tab_dup_title                          (PtyxisTab            *self);
+guint               ptyxis_tab_get_broadcast_group                (PtyxisTab            *self);
+void                ptyxis_tab_set_broadcast_group                (PtyxisTab            *self,
+                                                                   guint                 group);
+gboolean            ptyxis_tab_get_broadcast_input                (PtyxisTab            *self);
+void                ptyxis_tab_set_broadcast_input                (PtyxisTab            *self,
+                                                                   gboolean              broadcast_input);
 gboolean            ptyxis_tab_get_ignore_osc_title               (PtyxisTab            *self);
 void                ptyxis_tab_set_ignore_osc_title               (PtyxisTab            *self,
                                                                    gboolean              ignore_osc_title);
@@ -123,6 +129,12 @@ gboolean            ptyxis_tab_poll_agent_finish                  (PtyxisTab
                                                                    GError              **error);
 void                ptyxis_tab_open_uri                           (PtyxisTab            *self,
                                                                    const char           *uri);
-char               *ptyxis_tab_query_working_directory_from_agent (PtyxisTab            *self);
+void                ptyxis_tab_query_working_directory_from_agent_async  (PtyxisTab            *self,
+                                                                          GCancellable         *cancellable,
+                                                                          GAsyncReadyCallback   callback,
+                                                                          gpointer              user_data);
+char               *ptyxis_tab_query_working_directory_from_agent_finish (PtyxisTab            *self,
+                                                                          GAsyncResult         *result,
+                                                                          GError              **error);
 
 G_END_DECLS
@@ -0,0 +1,811 @@
+/*
+ * ptyxis-tabs-service.c
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gio/gunixfdlist.h>
+
+#include "ptyxis-application.h"
+#include "ptyxis-layout.h"
+#include "ptyxis-tab.h"
+#include "ptyxis-tabs-service.h"
+#include "ptyxis-terminal-private.h"
+#include "ptyxis-window.h"
+
+#define MAX_PENDING_BYTES (1024 * 1024)
+#define ROWS_PER_UPDATE   500
+
+typedef struct _PtyxisTabsSubscription
+{
+  PtyxisTabsService *service;
+  PtyxisTerminal    *terminal;
+  GSocket           *socket;
+  GSource           *socket_source;
+  GByteArray        *pending;
+  gint64             next_row;
+  gsize              dropped_bytes;
+  gulong             contents_changed_handler;
+  gulong             destroy_handler;
+  guint              update_source;
+  guint              watching_output : 1;
+} PtyxisTabsSubscription;
+
+struct _PtyxisTabsService
+{
+  PtyxisIpcTabsSkeleton  parent_instance;
+  GPtrArray             *subscriptions;
+};
+
+static void tabs_iface_init                      (PtyxisIpcTabsIface     *iface);
+static void ptyxis_tabs_subscription_watch       (PtyxisTabsSubscription *sub);
+
+G_DEFINE_FINAL_TYPE_WITH_CODE (PtyxisTabsService, ptyxis_tabs_service, PTYXIS_IPC_TYPE_TABS_SKELETON,
+                               G_IMPLEMENT_INTERFACE (PTYXIS_IPC_TYPE_TABS, tabs_iface_init))
+
+static void
+ptyxis_tabs_subscription_free (gpointer data)
+{
+  PtyxisTabsSubscription *sub = data;
+
+  g_clear_handle_id (&sub->update_source, g_source_remove);
+
+  if (sub->terminal != NULL)
+    {
+      g_clear_signal_handler (&sub->contents_changed_handler, sub->terminal);
+      g_clear_signal_handler (&sub->destroy_handler, sub->terminal);
+      g_clear_weak_pointer (&sub->terminal);
+    }
+
+  if (sub->socket_source != NULL)
+    {
+      g_source_destroy (sub->socket_source);
+      g_clear_pointer (&sub->socket_source, g_source_unref);
+    }
+
+  if (sub->socket != NULL)
+    {
+      g_socket_close (sub->socket, NULL);
+      g_clear_object (&sub->socket);
+    }
+
+  g_clear_pointer (&sub->pending, g_byte_array_unref);
+
+  g_free (sub);
+}
+
+static void
+ptyxis_tabs_subscription_unsubscribe (PtyxisTabsSubscription *sub)
+{
+  g_assert (sub != NULL);
+  g_assert (PTYXIS_IS_TABS_SERVICE (sub->service));
+
+  g_ptr_array_remove (sub->service->subscriptions, sub);
+}
+
+static void
+ptyxis_tabs_subscription_push (PtyxisTabsSubscription *sub,
+                               const guint8           *data,
+                               gsize                   len)
+{
+  g_assert (sub != NULL);
+
+  if (len == 0)
+    return;
+
+  /* Never let a slow reader grow our memory without bound. Drop what
+   * does not fit and tell the reader how much once it catches up.
+   */
+  if (sub->pending->len + len > MAX_PENDING_BYTES)
+    {
+      sub->dropped_bytes += len;
+      return;
+    }
+
+  if (sub->dropped_bytes > 0)
+    {
+      g_autofree char *marker = NULL;
+
+      marker = g_strdup_printf ("[ptyxis: %"G_GSIZE_FORMAT" bytes of output dropped]\n",
+                                sub->dropped_bytes);
+      g_byte_array_append (sub->pending, (const guint8 *)marker, strlen (marker));
+      sub->dropped_bytes = 0;
+    }
+
+  g_byte_array_append (sub->pending, data, len);
+}
+
+static gboolean
+ptyxis_tabs_subscription_flush (PtyxisTabsSubscription *sub)
+{
+  g_assert (sub != NULL);
+
+  while (sub->pending->len > 0)
+    {
+      g_autoptr(GError) error = NULL;
+      gssize n_written;
+
+      n_written = g_socket_send_with_blocking (sub->socket,
+                                               (const char *)sub->pending->data,
+                                               sub->pending->len,
+                                               FALSE,
+                                               NULL,
+                                               &error);
+
+      if (n_written < 0)
+        {
+          if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            break;
+
+          return FALSE;
+        }
+
+      g_byte_array_remove_range (sub->pending, 0, n_written);
+    }
+
+  ptyxis_tabs_subscription_watch (sub);
+
+  return TRUE;
+}
+
+static gboolean
+ptyxis_tabs_subscription_socket_cb (GSocket      *socket,
+                                    GIOCondition  condition,
+                                    gpointer      user_data)
+{
+  PtyxisTabsSubscription *sub = user_data;
+
+  g_assert (G_IS_SOCKET (socket));
+  g_assert (sub != NULL);
+
+  /* The reader closing their side shows up as a hang-up here or as an
+   * error the next time we send.
+   */
+  if (condition & (G_IO_HUP | G_IO_ERR))
+    goto unsubscribe;
+
+  if (condition & G_IO_OUT)
+    {
+      /* Flushing may replace this source, so the return value is moot
+       * when it succeeds.
+       */
+      if (!ptyxis_tabs_subscription_flush (sub))
+        goto unsubscribe;
+    }
+
+  return G_SOURCE_CONTINUE;
+
+unsubscribe:
+  ptyxis_tabs_subscription_unsubscribe (sub);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ptyxis_tabs_subscription_watch (PtyxisTabsSubscription *sub)
+{
+  GIOCondition condition = G_IO_HUP | G_IO_ERR;
+  gboolean watch_output;
+
+  g_assert (sub != NULL);
+
+  watch_output = sub->pending->len > 0;
+
+  if (sub->socket_source != NULL && sub->watching_output == watch_output)
+    return;
+
+  if (sub->socket_source != NULL)
+    {
+      g_source_destroy (sub->socket_source);
+      g_clear_pointer (&sub->socket_source, g_source_unref);
+    }
+
+  if (watch_output)
+    condition |= G_IO_OUT;
+
+  sub->watching_output = watch_output;
+  sub->socket_source = g_socket_create_source (sub->socket, condition, NULL);
+  g_source_set_priority (sub->socket_source, G_PRIORITY_LOW);
+  g_source_set_static_name (sub->socket_source, "[ptyxis-tabs-subscription]");
+  g_source_set_callback (sub->socket_source,
+                         (GSourceFunc)(GCallback)ptyxis_tabs_subscription_socket_cb,
+                         sub, NULL);
+  g_source_attach (sub->socket_source, NULL);
+}
+
+static gboolean
+ptyxis_tabs_subscription_update_cb (gpointer user_data)
+{
+  PtyxisTabsSubscription *sub = user_data;
+  g_autoptr(GBytes) bytes = NULL;
+  gint64 n_lost = 0;
+  gboolean has_more;
+
+  g_assert (sub != NULL);
+
+  sub->update_source = 0;
+
+  if (sub->terminal == NULL)
+    return G_SOURCE_REMOVE;
+
+  has_more = _ptyxis_terminal_read_rows (sub->terminal,
+                                         &sub->next_row,
+                                         ROWS_PER_UPDATE,
+                                         FALSE,
+                                         &n_lost,
+                                         &bytes);
+
+  if (n_lost > 0)
+    {
+      g_autofree char *marker = NULL;
+
+      marker = g_strdup_printf ("[ptyxis: %"G_GINT64_FORMAT" lines left the scrollback before delivery]\n",
+                                n_lost);
+      ptyxis_tabs_subscription_push (sub, (const guint8 *)marker, strlen (marker));
+    }
+
+  if (bytes != NULL)
+    ptyxis_tabs_subscription_push (sub,
+                                   g_bytes_get_data (bytes, NULL),
+                                   g_bytes_get_size (bytes));
+
+  if (!ptyxis_tabs_subscription_flush (sub))
+    {
+      ptyxis_tabs_subscription_unsubscribe (sub);
+      return G_SOURCE_REMOVE;
+    }
+
+  if (has_more)
+    sub->update_source = g_idle_add_full (G_PRIORITY_LOW,
+                                          ptyxis_tabs_subscription_update_cb,
+                                          sub, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ptyxis_tabs_subscription_contents_changed_cb (PtyxisTabsSubscription *sub,
+                                              PtyxisTerminal         *terminal)
+{
+  g_assert (sub != NULL);
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  if (sub->update_source == 0)
+    sub->update_source = g_idle_add_full (G_PRIORITY_LOW,
+                                          ptyxis_tabs_subscription_update_cb,
+                                          sub, NULL);
+}
+
+static void
+ptyxis_tabs_subscription_destroy_cb (PtyxisTabsSubscription *sub,
+                                     PtyxisTerminal         *terminal)
+{
+  g_assert (sub != NULL);
+  g_assert (PTYXIS_IS_TERMINAL (terminal));
+
+  /* Closing our side lets the reader see end-of-file */
+  ptyxis_tabs_subscription_unsubscribe (sub);
+}
+
+static PtyxisTab *
+ptyxis_tabs_service_find_tab (const char *uuid)
+{
+  g_assert (uuid != NULL);
+
+  for (const GList *iter = gtk_application_get_windows (GTK_APPLICATION (PTYXIS_APPLICATION_DEFAULT));
+       iter != NULL;
+       iter = iter->next)
+    {
+      g_autoptr(GListModel) pages = NULL;
+      guint n_items;
+
+      if (!PTYXIS_IS_WINDOW (iter->data))
+        continue;
+
+      pages = ptyxis_window_list_pages (PTYXIS_WINDOW (iter->data));
+      n_items = g_list_model_get_n_items (pages);
+
+      for (guint i = 0; i < n_items; i++)
+        {
+          g_autoptr(AdwTabPage) page = g_list_model_get_item (pages, i);
+          PtyxisTab *tab = PTYXIS_TAB (adw_tab_page_get_child (page));
+
+          if (g_strcmp0 (uuid, ptyxis_tab_get_uuid (tab)) == 0)
+            return tab;
+        }
+    }
+
+  return NULL;
+}
+
+static PtyxisWindow *
+ptyxis_tabs_service_get_current_window (void)
+{
+  GtkApplication *app = GTK_APPLICATION (PTYXIS_APPLICATION_DEFAULT);
+  GtkWindow *active_window;
+
+  if ((active_window = gtk_application_get_active_window (app)) &&
+      PTYXIS_IS_WINDOW (active_window))
+    return PTYXIS_WINDOW (active_window);
+
+  for (const GList *iter = gtk_application_get_windows (app);
+       iter != NULL;
+       iter = iter->next)
+    {
+      if (PTYXIS_IS_WINDOW (iter->data))
+        return PTYXIS_WINDOW (iter->data);
+    }
+
+  return NULL;
+}
+
+static void
+ptyxis_tabs_service_return_not_found (GDBusMethodInvocation *invocation,
+                                      const char            *uuid)
+{
+  g_dbus_method_invocation_return_error (invocation,
+                                         G_IO_ERROR,
+                                         G_IO_ERROR_NOT_FOUND,
+                                         "No tab found with uuid \"%s\"",
+                                         uuid);
+}
+
+static gboolean
+ptyxis_tabs_service_handle_list_tabs (PtyxisIpcTabs         *tabs,
+                                      GDBusMethodInvocation *invocation)
+{
+  GVariantBuilder builder;
+
+  g_assert (PTYXIS_IS_TABS_SERVICE (tabs));
+  g_assert (G_IS_DBUS_METHOD_INVOCATION (invocation));
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sa{sv})"));
+
+  for (const GList *iter = gtk_application_get_windows (GTK_APPLICATION (PTYXIS_APPLICATION_DEFAULT));
+       iter != NULL;
+       iter = iter->next)
+    {
+      g_autoptr(GListModel) pages = NULL;
+      guint window_id;
+      guint n_items;
+
+      if (!PTYXIS_IS_WINDOW (iter->data))
+        continue;
+
+      window_id = gtk_application_window_get_id (GTK_APPLICATION_WINDOW (iter->data));
+      pages = ptyxis_window_list_pages (PTYXIS_WINDOW (iter->data));
+      n_items = g_list_model_get_n_items (pages);
+
+      for (guint i = 0; i < n_items; i++)
+        {
+          g_autoptr(AdwTabPage) page = g_list_model_get_item (pages, i);
+          PtyxisTab *tab = PTYXIS_TAB (adw_tab_page_get_child (page));
+          PtyxisTerminal *terminal = ptyxis_tab_get_terminal (tab);
+          PtyxisProfile *profile = ptyxis_tab_get_profile (tab);
+          g_autofree char *title = ptyxis_tab_dup_title (tab);
+          g_autofree char *cwd = ptyxis_tab_dup_current_directory_uri (tab);
+          const char *process = ptyxis_tab_get_command_line (tab);
+          const char *container = ptyxis_terminal_get_current_container_name (terminal);
+          GVariantBuilder info;
+
+          g_variant_builder_init (&info, G_VARIANT_TYPE_VARDICT);
+
+          if (title != NULL)
+            g_variant_builder_add (&info, "{sv}", "title", g_variant_new_string (title));
+
+          if (cwd != NULL)
+            g_variant_builder_add (&info, "{sv}", "cwd", g_variant_new_string (cwd));
+
+          if (process != NULL)
+            g_variant_builder_add (&info, "{sv}", "process", g_variant_new_string (process));
+
+          if (container != NULL)
+            g_variant_builder_add (&info, "{sv}", "container", g_variant_new_string (container));
+
+          if (profile != NULL)
+            g_variant_builder_add (&info, "{sv}", "profile",
+                                   g_variant_new_string (ptyxis_profile_get_uuid (profile)));
+
+          g_variant_builder_add (&info, "{sv}", "window", g_variant_new_uint32 (window_id));
+          g_variant_builder_add (&info, "{sv}", "read-only",
+                                 g_variant_new_boolean (!vte_terminal_get_input_enabled (VTE_TERMINAL (terminal))));
+
+          g_variant_builder_add (&builder, "(sa{sv})", ptyxis_tab_get_uuid (tab), &info);
+        }
+    }
+
+  ptyxis_ipc_tabs_complete_list_tabs (tabs, invocation, g_variant_builder_end (&builder));
+
+  return TRUE;
+}
+
+typedef struct _CreateTab
+{
+  PtyxisProfile  *profile;
+  char          **argv;
+  char           *cwd_uri;
+  char           *title;
+  gboolean        new_window;
+} CreateTab;
+
+static void
+create_tab_free (gpointer data)
+{
+  CreateTab *create = data;
+
+  g_clear_object (&create->profile);
+  g_clear_pointer (&create->argv, g_strfreev);
+  g_clear_pointer (&create->cwd_uri, g_free);
+  g_clear_pointer (&create->title, g_free);
+  g_free (create);
+}
+
+static CreateTab *
+ptyxis_tabs_service_parse_request (GVariant  *request,
+                                   GError   **error)
+{
+  g_autoptr(GVariantDict) dict = NULL;
+  g_autoptr(PtyxisProfile) profile = NULL;
+  g_autofree char *cwd_uri = NULL;
+  g_autofree char *title = NULL;
+  g_auto(GStrv) argv = NULL;
+  const char *profile_uuid = NULL;
+  const char *cwd = NULL;
+  gboolean new_window = FALSE;
+  CreateTab *create;
+
+  g_assert (request != NULL);
+
+  dict = g_variant_dict_new (request);
+
+  g_variant_dict_lookup (dict, "profile", "&s", &profile_uuid);
+  g_variant_dict_lookup (dict, "cwd", "&s", &cwd);
+  g_variant_dict_lookup (dict, "command", "^as", &argv);
+  g_variant_dict_lookup (dict, "title", "s", &title);
+  g_variant_dict_lookup (dict, "new-window", "b", &new_window);
+
+  if (profile_uuid != NULL && profile_uuid[0] != 0)
+    profile = ptyxis_application_dup_profile (PTYXIS_APPLICATION_DEFAULT, profile_uuid);
+  else
+    profile = ptyxis_application_dup_default_profile (PTYXIS_APPLICATION_DEFAULT);
+
+  if (profile == NULL)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_NOT_FOUND,
+                   "No profile found with uuid \"%s\"",
+                   profile_uuid);
+      return NULL;
+    }
+
+  /* The caller's working directory means nothing to us, so relative
+   * paths cannot be resolved.
+   */
+  if (cwd != NULL && cwd[0] != 0)
+    {
+      if (g_path_is_absolute (cwd))
+        cwd_uri = g_filename_to_uri (cwd, NULL, NULL);
+      else if (g_uri_peek_scheme (cwd) != NULL)
+        cwd_uri = g_strdup (cwd);
+
+      if (cwd_uri == NULL)
+        {
+          g_set_error (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_ARGUMENT,
+                       "Working directory \"%s\" must be an absolute path or URI",
+                       cwd);
+          return NULL;
+        }
+    }
+
+  create = g_new0 (CreateTab, 1);
+  create->profile = g_steal_pointer (&profile);
+  create->argv = g_steal_pointer (&argv);
+  create->cwd_uri = g_steal_pointer (&cwd_uri);
+  create->title = g_steal_pointer (&title);
+  create->new_window = new_window;
+
+  return create;
+}
+
+static gboolean
+ptyxis_tabs_service_handle_create_tabs (PtyxisIpcTabs         *tabs,
+                                        GDBusMethodInvocation *invocation,
+                                        GVariant              *requests)
+{
+  g_autoptr(GPtrArray) parsed = NULL;
+  g_autoptr(GPtrArray) windows = NULL;
+  g_autoptr(GPtrArray) created = NULL;
+  g_autoptr(GStrvBuilder) uuids = NULL;
+  g_auto(GStrv) strv = NULL;
+  PtyxisWindow *window;
+  GVariantIter iter;
+  GVariant *request;
+
+  g_assert (PTYXIS_IS_TABS_SERVICE (tabs));
+  g_assert (G_IS_DBUS_METHOD_INVOCATION (invocation));
+  g_assert (requests != NULL);
+
+  /* Validate every request before creating anything so that a bad
+   * entry does not leave the earlier tabs behind.
+   */
+  parsed = g_ptr_array_new_with_free_func (create_tab_free);
+
+  g_variant_iter_init (&iter, requests);
+
+  while ((request = g_variant_iter_next_value (&iter)))
+    {
+      g_autoptr(GError) error = NULL;
+      CreateTab *create;
+
+      create = ptyxis_tabs_service_parse_request (request, &error);
+      g_variant_unref (request);
+
+      if (create == NULL)
+        {
+          g_dbus_method_invocation_return_gerror (invocation, error);
+          return TRUE;
+        }
+
+      g_ptr_array_add (parsed, create);
+    }
+
+  windows = g_ptr_array_new ();
+  created = g_ptr_array_new ();
+  uuids = g_strv_builder_new ();
+  window = ptyxis_tabs_service_get_current_window ();
+
+  for (guint i = 0; i < parsed->len; i++)
+    {
+      const CreateTab *create = g_ptr_array_index (parsed, i);
+      PtyxisTab *tab;
+
+      if (create->new_window || window == NULL)
+        {
+          window = ptyxis_window_new_empty ();
+          g_ptr_array_add (windows, window);
+        }
+
+      if (create->argv != NULL && create->argv[0] != NULL)
+        {
+          tab = ptyxis_window_add_tab_for_command (window,
+                                                   create->profile,
+                                                   (const char * const *)create->argv,
+                                                   create->cwd_uri);
+        }
+      else
+        {
+          tab = ptyxis_tab_new (create->profile);
+
+          if (create->cwd_uri != NULL)
+            ptyxis_tab_set_initial_working_directory_uri (tab, create->cwd_uri);
+
+          ptyxis_window_add_tab (window, tab);
+        }
+
+      if (create->title != NULL)
+        ptyxis_tab_set_title_prefix (tab, create->title);
+
+      g_strv_builder_add (uuids, ptyxis_tab_get_uuid (tab));
+      g_ptr_array_add (created, tab);
+    }
+
+  strv = g_strv_builder_end (uuids);
+  ptyxis_ipc_tabs_complete_create_tabs (tabs, invocation, (const char * const *)strv);
+
+  for (guint i = 0; i < windows->len; i++)
+    gtk_window_present (g_ptr_array_index (windows, i));
+
+  ptyxis_layout_spawn_tabs ((PtyxisTab * const *)created->pdata, created->len);
+
+  return TRUE;
+}
+
+static gboolean
+ptyxis_tabs_service_handle_send_input (PtyxisIpcTabs         *tabs,
+                                       GDBusMethodInvocation *invocation,
+                                       const char            *uuid,
+                                       GVariant              *data)
+{
+  PtyxisTerminal *terminal;
+  const char *buf;
+  PtyxisTab *tab;
+  gsize len;
+
+  g_assert (PTYXIS_IS_TABS_SERVICE (tabs));
+  g_assert (G_IS_DBUS_METHOD_INVOCATION (invocation));
+  g_assert (uuid != NULL);
+  g_assert (data != NULL);
+
+  if (!(tab = ptyxis_tabs_service_find_tab (uuid)))
+    {
+      ptyxis_tabs_service_return_not_found (invocation, uuid);
+      return TRUE;
+    }
+
+  terminal = ptyxis_tab_get_terminal (tab);
+
+  if (!vte_terminal_get_input_enabled (VTE_TERMINAL (terminal)))
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_IO_ERROR,
+                                             G_IO_ERROR_PERMISSION_DENIED,
+                                             "Tab \"%s\" is read-only",
+                                             uuid);
+      return TRUE;
+    }
+
+  buf = g_variant_get_fixed_array (data, &len, sizeof (guint8));
+
+  if (len > 0)
+    vte_terminal_feed_child (VTE_TERMINAL (terminal), buf, len);
+
+  ptyxis_ipc_tabs_complete_send_input (tabs, invocation);
+
+  return TRUE;
+}
+
+static gboolean
+ptyxis_tabs_service_handle_subscribe_output (PtyxisIpcTabs         *tabs,
+                                             GDBusMethodInvocation *invocation,
+                                             GUnixFDList           *in_fd_list,
+                                             const char            *uuid)
+{
+  PtyxisTabsService *self = (PtyxisTabsService *)tabs;
+  g_autoptr(GUnixFDList) out_fd_list = NULL;
+  g_autoptr(GSocket) socket = NULL;
+  g_autoptr(GError) error = NULL;
+  PtyxisTabsSubscription *sub;
+  PtyxisTerminal *terminal;
+  PtyxisTab *tab;
+  int fds[2];
+  int handle;
+  long column;
+
+  g_assert (PTYXIS_IS_TABS_SERVICE (self));
+  g_assert (G_IS_DBUS_METHOD_INVOCATION (invocation));
+  g_assert (uuid != NULL);
+
+  if (!(tab = ptyxis_tabs_service_find_tab (uuid)))
+    {
+      ptyxis_tabs_service_return_not_found (invocation, uuid);
+      return TRUE;
+    }
+
+  /* A stream socket rather than a pipe so that a reader going away
+   * shows up as an error on send() instead of SIGPIPE. Readers may
+   * treat it exactly like the read end of a pipe.
+   */
+  if (socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+    {
+      int errsv = errno;
+      g_dbus_method_invocation_return_error_literal (invocation,
+                                                     G_IO_ERROR,
+                                                     g_io_error_from_errno (errsv),
+                                                     g_strerror (errsv));
+      return TRUE;
+    }
+
+  if (!(socket = g_socket_new_from_fd (fds[0], &error)))
+    {
+      close (fds[0]);
+      close (fds[1]);
+      g_dbus_method_invocation_return_gerror (invocation, error);
+      return TRUE;
+    }
+
+  g_socket_set_blocking (socket, FALSE);
+
+  out_fd_list = g_unix_fd_list_new ();
+  handle = g_unix_fd_list_append (out_fd_list, fds[1], &error);
+  close (fds[1]);
+
+  if (handle < 0)
+    {
+      g_dbus_method_invocation_return_gerror (invocation, error);
+      return TRUE;
+    }
+
+  terminal = ptyxis_tab_get_terminal (tab);
+
+  sub = g_new0 (PtyxisTabsSubscription, 1);
+  sub->service = self;
+  sub->socket = g_steal_pointer (&socket);
+  sub->pending = g_byte_array_new ();
+  vte_terminal_get_cursor_position (VTE_TERMINAL (terminal), &column, &sub->next_row);
+  g_set_weak_pointer (&sub->terminal, terminal);
+  sub->contents_changed_handler =
+    g_signal_connect_swapped (terminal,
+                              "contents-changed",
+                              G_CALLBACK (ptyxis_tabs_subscription_contents_changed_cb),
+                              sub);
+  sub->destroy_handler =
+    g_signal_connect_swapped (terminal,
+                              "destroy",
+                              G_CALLBACK (ptyxis_tabs_subscription_destroy_cb),
+                              sub);
+  ptyxis_tabs_subscription_watch (sub);
+
+  g_ptr_array_add (self->subscriptions, sub);
+
+  ptyxis_ipc_tabs_complete_subscribe_output (tabs,
+                                             invocation,
+                                             out_fd_list,
+                                             g_variant_new_handle (handle));
+
+  return TRUE;
+}
+
+static void
+tabs_iface_init (PtyxisIpcTabsIface *iface)
+{
+  iface->handle_list_tabs = ptyxis_tabs_service_handle_list_tabs;
+  iface->handle_create_tabs = ptyxis_tabs_service_handle_create_tabs;
+  iface->handle_send_input = ptyxis_tabs_service_handle_send_input;
+  iface->handle_subscribe_output = ptyxis_tabs_service_handle_subscribe_output;
+}
+
+static void
+ptyxis_tabs_service_dispose (GObject *object)
+{
+  PtyxisTabsService *self = (PtyxisTabsService *)object;
+
+  if (self->subscriptions != NULL)
+    g_ptr_array_set_size (self->subscriptions, 0);
+
+  G_OBJECT_CLASS (ptyxis_tabs_service_parent_class)->dispose (object);
+}
+
+static void
+ptyxis_tabs_service_finalize (GObject *object)
+{
+  PtyxisTabsService *self = (PtyxisTabsService *)object;
+
+  g_clear_pointer (&self->subscriptions, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (ptyxis_tabs_service_parent_class)->finalize (object);
+}
+
+static void
+ptyxis_tabs_service_class_init (PtyxisTabsServiceClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = ptyxis_tabs_service_dispose;
+  object_class->finalize = ptyxis_tabs_service_finalize;
+}
+
+static void
+ptyxis_tabs_service_init (PtyxisTabsService *self)
+{
+  self->subscriptions = g_ptr_array_new_with_free_func (ptyxis_tabs_subscription_free);
+}
+
+PtyxisTabsService *
+ptyxis_tabs_service_new (void)
+{
+  return g_object_new (PTYXIS_TYPE_TABS_SERVICE, NULL);
+}
@@ -0,0 +1,38 @@
+/*
+ * ptyxis-terminal-private.h
+ *
+ * Copyright 2025 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "ptyxis-command-history.h"
+#include "ptyxis-terminal.h"
+
+G_BEGIN_DECLS
+
+PtyxisCommandHistory *_ptyxis_terminal_get_command_history (PtyxisTerminal  *self);
+gboolean              _ptyxis_terminal_is_user_input       (PtyxisTerminal  *self);
+gboolean              _ptyxis_terminal_read_rows           (PtyxisTerminal  *self,
+                                                            gint64          *next_row,
+                                                            gint64           max_rows,
+                                                            gboolean         include_cursor,
+                                                            gint64          *n_lost,
+                                                            GBytes         **bytes);
+
+G_END_DECLS
@@ -29,17 +29,30 @@
 #include <adwaita.h>
 
 #include <glib/gi18n.h>
+#include <glib-unix.h>
 
 #include "ptyxis-application.h"
+#include "ptyxis-command-history.h"
+#include "ptyxis-export.h"
+#include "ptyxis-prompt-marks.h"
 #include "ptyxis-shortcuts.h"
 #include "ptyxis-tab.h"
-#include "ptyxis-terminal.h"
+#include "ptyxis-terminal-private.h"
 #include "ptyxis-util.h"
 #include "ptyxis-window.h"
 
 #include "terminal-regex.h"
 
 #define SIZE_DISMISS_TIMEOUT_MSEC 1000
+
+/* While the allocation keeps changing, such as an interactive resize
+ * or the fullscreen animation, the grid (and therefore the PTY window
+ * size) is only updated once the size has been stable for
+ * RESIZE_SETTLE_MSEC or at most every RESIZE_MAX_DELAY_MSEC.
+ */
+#define RESIZE_SETTLE_MSEC    100
+#define RESIZE_MAX_DELAY_MSEC 250
+
 #define URL_MATCH_CURSOR_NAME "pointer"
 
 #define DROP_REQUEST_PRIORITY               G_PRIORITY_DEFAULT
@@ -48,6 +61,22 @@
 #define TEXT_X_MOZ_URL                      "text/x-moz-url"
 #define TEXT_URI_LIST                       "text/uri-list"
 
+/* Enough shell prompts to cover a long session at 8 bytes each */
+#define PROMPT_MARKS_CAPACITY 2048
+
+/* Commands kept per terminal for notifications and titles */
+#define COMMAND_HISTORY_MAX 256
+
+/* Pastes larger than this are streamed to the PTY in chunks of
+ * PASTE_CHUNK_SIZE so that VTE never has to convert and queue
+ * megabytes of input within a single main loop iteration.
+ */
+#define PASTE_CHUNK_SIZE      4096
+#define PASTE_CHUNK_THRESHOLD (PASTE_CHUNK_SIZE * 16)
+
+#define BRACKETED_PASTE_BEGIN "\033[200~"
+#define BRACKETED_PASTE_END   "\033[201~"
+
 struct _PtyxisTerminal
 {
   VteTerminal        parent_instance;
@@ -57,7 +86,6 @@ struct _PtyxisTerminal
   char               *url;
 
   GtkPopover         *popover;
-  GMenu              *terminal_menu;
   GtkWidget          *drop_highlight;
   GtkDropTargetAsync *drop_target;
   GtkRevealer        *size_revealer;
@@ -65,9 +93,59 @@ struct _PtyxisTerminal
 
   GdkRGBA             background;
 
+  /* Remaining text of a large paste which is written one chunk at a
+   * time whenever the PTY becomes writable.
+   */
+  GString            *paste_buffer;
+  gsize               paste_pos;
+  guint               paste_source;
+
+  /* Cancelled on dispose so exports stop touching the terminal */
+  GCancellable       *export_cancellable;
+
+  /* Rows where shell integration reported a prompt or command output */
+  PtyxisPromptMarks  *prompt_marks;
+
+  /* Commands reported by shell integration along with the position
+   * where the user started typing at the prompt so the command text
+   * can be read back from the terminal when it starts executing.
+   */
+  PtyxisCommandHistory *command_history;
+  glong               input_row;
+  glong               input_column;
+  int                 last_exit_status;
+
+  /* Scratch space for ptyxis_terminal_rewrite_snapshot() */
+  GPtrArray          *rewrite_children;
+
   guint               size_dismiss_source;
   guint               n_columns;
   guint               n_rows;
+
+  /* Size last given to VTE and when the current run of changes began */
+  int                 governed_width;
+  int                 governed_height;
+  gint64              resize_begin_time;
+  guint               resize_source;
+
+  guint               resize_flush : 1;
+
+  guint               at_prompt : 1;
+  guint               has_input_position : 1;
+
+  /* Set while a key is held or a paste is being written so that input
+   * from the user can be told apart from replies generated by VTE.
+   */
+  guint               key_down : 1;
+  guint               in_paste : 1;
+
+  /* Used to learn from VTE whether the application enabled bracketed
+   * paste, and if so, that the stream was opened with one frame.
+   */
+  guint               paste_probing : 1;
+  guint               paste_probe_committed : 1;
+  guint               paste_probe_bracketed : 1;
+  guint               paste_framed : 1;
 };
 
 enum {
@@ -75,6 +153,8 @@ enum {
   PROP_CURRENT_CONTAINER_NAME,
   PROP_CURRENT_CONTAINER_RUNTIME,
   PROP_PALETTE,
+  PROP_PASTE_FRACTION,
+  PROP_PASTING,
   PROP_SHORTCUTS,
   N_PROPS
 };
@@ -98,6 +178,12 @@ static const char * const url_regexes_str[] = {
 };
 static VteRegex *url_regexes[G_N_ELEMENTS(url_regexes_str)];
 
+/* The context menu is the same for every terminal, so one model is
+ * shared and its accelerators are kept current in a single place.
+ */
+static GMenu *shared_terminal_menu;
+static gboolean shared_terminal_menu_tracked;
+
 static void
 ptyxis_terminal_update_colors (PtyxisTerminal *self)
 {
@@ -257,6 +343,22 @@ ptyxis_terminal_setup_context_menu (VteTerminal           *terminal,
     gtk_widget_set_halign (GTK_WIDGET (self->popover), GTK_ALIGN_START);
 }
 
+static gboolean
+ptyxis_terminal_primary_paste_enabled (PtyxisTerminal *self)
+{
+  gboolean enabled = TRUE;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  g_object_get (gtk_widget_get_settings (GTK_WIDGET (self)),
+                "gtk-enable-primary-paste", &enabled,
+                NULL);
+
+  return enabled;
+}
+
+static void ptyxis_terminal_paste_primary (PtyxisTerminal *self);
+
 static void
 ptyxis_terminal_capture_click_pressed_cb (PtyxisTerminal  *self,
                                           int              n_press,
@@ -293,6 +395,22 @@ ptyxis_terminal_capture_click_pressed_cb (PtyxisTerminal  *self,
         handled = ptyxis_terminal_match_clicked (self, x, y, button, state, match);
     }
 
+  /* Take over Shift+middle-click paste from VTE so that a large
+   * selection is streamed like any other paste. With Shift, VTE pastes
+   * even if the application is tracking the mouse, so this never takes
+   * a click away from the application. Without Shift, VTE decides.
+   */
+  if (n_press == 1 &&
+      !handled &&
+      button == 2 &&
+      (state & GDK_SHIFT_MASK) &&
+      ptyxis_terminal_primary_paste_enabled (self))
+    {
+      gtk_widget_grab_focus (GTK_WIDGET (self));
+      ptyxis_terminal_paste_primary (self);
+      handled = TRUE;
+    }
+
   if (handled)
     gtk_gesture_set_state (GTK_GESTURE (click), GTK_EVENT_SEQUENCE_CLAIMED);
   else
@@ -320,6 +438,19 @@ ptyxis_terminal_scroll_to_bottom (PtyxisTerminal *self)
     gtk_adjustment_set_value (adjustment, upper - page_size);
 }
 
+static void
+ptyxis_terminal_capture_key_released_cb (PtyxisTerminal     *self,
+                                         guint               keyval,
+                                         guint               keycode,
+                                         GdkModifierType     state,
+                                         GtkEventController *controller)
+{
+  g_assert (PTYXIS_IS_TERMINAL (self));
+  g_assert (GTK_IS_EVENT_CONTROLLER_KEY (controller));
+
+  self->key_down = FALSE;
+}
+
 static gboolean
 ptyxis_terminal_capture_key_pressed_cb (PtyxisTerminal     *self,
                                         guint               keyval,
@@ -337,6 +468,7 @@ ptyxis_terminal_capture_key_pressed_cb (PtyxisTerminal     *self,
   g_assert (PTYXIS_IS_TERMINAL (self));
   g_assert (GTK_IS_EVENT_CONTROLLER_KEY (controller));
 
+  self->key_down = TRUE;
 
   /* HACK:
    *
@@ -421,6 +553,207 @@ copy_clipboard_action (GtkWidget  *widget,
     }
 }
 
+static void
+ptyxis_terminal_save_output_cb (GObject      *object,
+                                GAsyncResult *result,
+                                gpointer      user_data)
+{
+  PtyxisTerminal *self = (PtyxisTerminal *)object;
+  g_autoptr(GError) error = NULL;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+  g_assert (G_IS_ASYNC_RESULT (result));
+
+  if (!ptyxis_export_finish (VTE_TERMINAL (self), result, &error))
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          g_warning ("Failed to save terminal output: %s", error->message);
+          ptyxis_terminal_toast (self, 5, _("Failed to save output"));
+        }
+
+      return;
+    }
+
+  ptyxis_terminal_toast (self, 3, _("Output saved"));
+}
+
+static void
+ptyxis_terminal_save_output_dialog_cb (GObject      *object,
+                                       GAsyncResult *result,
+                                       gpointer      user_data)
+{
+  GtkFileDialog *dialog = (GtkFileDialog *)object;
+  g_autoptr(PtyxisTerminal) self = user_data;
+  g_autoptr(GFile) file = NULL;
+  g_autofree char *name = NULL;
+  PtyxisExportFormat format = PTYXIS_EXPORT_FORMAT_TEXT;
+  PtyxisExportFlags flags = PTYXIS_EXPORT_FLAGS_NONE;
+
+  g_assert (GTK_IS_FILE_DIALOG (dialog));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  if (!(file = gtk_file_dialog_save_finish (dialog, result, NULL)))
+    return;
+
+  /* The file name decides the format, such as "output.html.gz" */
+  name = g_file_get_basename (file);
+
+  if (g_str_has_suffix (name, ".gz"))
+    {
+      flags |= PTYXIS_EXPORT_FLAGS_COMPRESS;
+      name[strlen (name) - strlen (".gz")] = 0;
+    }
+
+  if (g_str_has_suffix (name, ".html") || g_str_has_suffix (name, ".htm"))
+    format = PTYXIS_EXPORT_FORMAT_HTML;
+
+  if (self->export_cancellable == NULL)
+    self->export_cancellable = g_cancellable_new ();
+
+  ptyxis_export_async (VTE_TERMINAL (self),
+                       file,
+                       format,
+                       flags,
+                       self->export_cancellable,
+                       ptyxis_terminal_save_output_cb,
+                       NULL);
+}
+
+static PtyxisPromptMarks *
+ptyxis_terminal_get_prompt_marks (PtyxisTerminal *self)
+{
+  gint64 first_row;
+  glong cursor_row;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  /* Forget marks which have been trimmed from the scrollback or which
+   * were invalidated by a reset before anyone looks at them.
+   */
+  ptyxis_vte_get_row_bounds (VTE_TERMINAL (self), &first_row, NULL, NULL);
+  vte_terminal_get_cursor_position (VTE_TERMINAL (self), NULL, &cursor_row);
+  ptyxis_prompt_marks_clamp (self->prompt_marks, first_row, cursor_row);
+
+  return self->prompt_marks;
+}
+
+static void
+previous_prompt_action (GtkWidget  *widget,
+                        const char *action_name,
+                        GVariant   *param)
+{
+  PtyxisTerminal *self = PTYXIS_TERMINAL (widget);
+  PtyxisPromptMarks *marks = ptyxis_terminal_get_prompt_marks (self);
+  gint64 top_row;
+  gint64 row;
+
+  ptyxis_vte_get_row_bounds (VTE_TERMINAL (self), NULL, &top_row, NULL);
+
+  if (ptyxis_prompt_marks_find_previous (marks, top_row, PTYXIS_PROMPT_MARK_PROMPT, &row))
+    ptyxis_vte_scroll_to_row (VTE_TERMINAL (self), row);
+  else
+    gtk_widget_error_bell (widget);
+}
+
+static void
+next_prompt_action (GtkWidget  *widget,
+                    const char *action_name,
+                    GVariant   *param)
+{
+  PtyxisTerminal *self = PTYXIS_TERMINAL (widget);
+  PtyxisPromptMarks *marks = ptyxis_terminal_get_prompt_marks (self);
+  gint64 top_row;
+  gint64 row;
+
+  ptyxis_vte_get_row_bounds (VTE_TERMINAL (self), NULL, &top_row, NULL);
+
+  if (ptyxis_prompt_marks_find_next (marks, top_row, PTYXIS_PROMPT_MARK_PROMPT, &row))
+    ptyxis_vte_scroll_to_row (VTE_TERMINAL (self), row);
+  else
+    ptyxis_terminal_scroll_to_bottom (self);
+}
+
+static void
+copy_last_output_action (GtkWidget  *widget,
+                         const char *action_name,
+                         GVariant   *param)
+{
+  PtyxisTerminal *self = PTYXIS_TERMINAL (widget);
+  PtyxisPromptMarks *marks = ptyxis_terminal_get_prompt_marks (self);
+  g_autofree char *text = NULL;
+  gint64 begin_row;
+  gint64 end_row;
+
+  if (!ptyxis_prompt_marks_get_last_output (marks, &begin_row, &end_row) ||
+      end_row <= begin_row)
+    {
+      gtk_widget_error_bell (widget);
+      return;
+    }
+
+  text = vte_terminal_get_text_range_format (VTE_TERMINAL (self),
+                                             VTE_FORMAT_TEXT,
+                                             begin_row, 0,
+                                             end_row - 1,
+                                             vte_terminal_get_column_count (VTE_TERMINAL (self)),
+                                             NULL);
+
+  if (text != NULL && text[0] != 0)
+    {
+      PtyxisSettings *settings = ptyxis_application_get_settings (PTYXIS_APPLICATION_DEFAULT);
+
+      gdk_clipboard_set_text (gtk_widget_get_clipboard (widget), text);
+
+      if (ptyxis_settings_get_toast_on_copy_clipboard (settings))
+        ptyxis_terminal_toast (self, 1, _("Copied output to clipboard"));
+    }
+}
+
+static void
+save_output_action (GtkWidget  *widget,
+                    const char *action_name,
+                    GVariant   *param)
+{
+  PtyxisTerminal *self = PTYXIS_TERMINAL (widget);
+  g_autoptr(GtkFileDialog) dialog = NULL;
+  g_autoptr(GtkFileFilter) text = NULL;
+  g_autoptr(GtkFileFilter) html = NULL;
+  g_autoptr(GtkFileFilter) compressed = NULL;
+  g_autoptr(GListStore) filters = NULL;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  text = gtk_file_filter_new ();
+  gtk_file_filter_set_name (text, _("Plain Text"));
+  gtk_file_filter_add_suffix (text, "txt");
+
+  html = gtk_file_filter_new ();
+  gtk_file_filter_set_name (html, _("HTML with Colors"));
+  gtk_file_filter_add_suffix (html, "html");
+
+  compressed = gtk_file_filter_new ();
+  gtk_file_filter_set_name (compressed, _("Compressed"));
+  gtk_file_filter_add_suffix (compressed, "gz");
+
+  filters = g_list_store_new (GTK_TYPE_FILE_FILTER);
+  g_list_store_append (filters, text);
+  g_list_store_append (filters, html);
+  g_list_store_append (filters, compressed);
+
+  dialog = gtk_file_dialog_new ();
+  gtk_file_dialog_set_title (dialog, _("Save Output"));
+  gtk_file_dialog_set_accept_label (dialog, _("_Save"));
+  gtk_file_dialog_set_initial_name (dialog, "output.txt");
+  gtk_file_dialog_set_filters (dialog, G_LIST_MODEL (filters));
+  gtk_file_dialog_save (dialog,
+                        GTK_WINDOW (gtk_widget_get_root (widget)),
+                        NULL,
+                        ptyxis_terminal_save_output_dialog_cb,
+                        g_object_ref (self));
+}
+
 static void
 paste_clipboard_action (GtkWidget  *widget,
                         const char *action_name,
@@ -471,6 +804,297 @@ open_link_action (GtkWidget  *widget,
   ptyxis_tab_open_uri (tab, self->url);
 }
 
+static void ptyxis_terminal_paste_queue (PtyxisTerminal *self);
+
+static void
+ptyxis_terminal_paste_clear (PtyxisTerminal *self)
+{
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  if (self->paste_buffer == NULL)
+    return;
+
+  /* Never leave the application inside an open bracketed paste */
+  if (self->paste_framed && vte_terminal_get_pty (VTE_TERMINAL (self)) != NULL)
+    {
+      self->in_paste = TRUE;
+      vte_terminal_feed_child (VTE_TERMINAL (self), BRACKETED_PASTE_END, -1);
+      self->in_paste = FALSE;
+    }
+
+  g_clear_handle_id (&self->paste_source, g_source_remove);
+  g_string_free (g_steal_pointer (&self->paste_buffer), TRUE);
+  self->paste_pos = 0;
+  self->paste_framed = FALSE;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PASTING]);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PASTE_FRACTION]);
+}
+
+/* Filters @text the way VTE does for pastes, converting line endings
+ * to carriage returns and dropping control characters other than tab.
+ */
+static void
+ptyxis_terminal_append_pastified (GString    *str,
+                                  const char *text,
+                                  gsize       len)
+{
+  g_assert (str != NULL);
+  g_assert (text != NULL);
+
+  for (gsize i = 0; i < len; i++)
+    {
+      guchar ch = text[i];
+
+      if (ch == '\n')
+        {
+          if (i == 0 || text[i - 1] != '\r')
+            g_string_append_c (str, '\r');
+        }
+      else if (ch == 0xc2 && i + 1 < len && (guchar)text[i + 1] >= 0x80 && (guchar)text[i + 1] <= 0x9f)
+        {
+          /* C1 control characters */
+          i++;
+        }
+      else if (ch == '\t' || ch == '\r' || (ch >= 0x20 && ch != 0x7f))
+        {
+          g_string_append_c (str, ch);
+        }
+    }
+}
+
+static void
+ptyxis_terminal_paste_chunk (PtyxisTerminal *self)
+{
+  g_autoptr(GString) chunk = NULL;
+  const char *begin;
+  const char *end;
+  gsize remaining;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+  g_assert (self->paste_buffer != NULL);
+  g_assert (self->paste_pos < self->paste_buffer->len);
+
+  begin = &self->paste_buffer->str[self->paste_pos];
+  remaining = self->paste_buffer->len - self->paste_pos;
+
+  if (remaining <= PASTE_CHUNK_SIZE)
+    {
+      end = begin + remaining;
+    }
+  else
+    {
+      /* Never split a UTF-8 sequence, nor a CRLF pair which would
+       * otherwise turn into two line endings.
+       */
+      end = g_utf8_find_prev_char (begin, begin + PASTE_CHUNK_SIZE + 1);
+
+      if (end == NULL || end == begin)
+        end = begin + PASTE_CHUNK_SIZE;
+
+      if (end > begin + 1 && end[-1] == '\r' && end[0] == '\n')
+        end--;
+    }
+
+  chunk = g_string_sized_new (end - begin);
+  ptyxis_terminal_append_pastified (chunk, begin, end - begin);
+
+  self->paste_pos += end - begin;
+
+  /* The stream is one bracketed paste when the application asked for
+   * them, so the frame is only closed after the last chunk.
+   */
+  if (self->paste_framed && self->paste_pos >= self->paste_buffer->len)
+    {
+      g_string_append (chunk, BRACKETED_PASTE_END);
+      self->paste_framed = FALSE;
+    }
+
+  self->in_paste = TRUE;
+  vte_terminal_feed_child (VTE_TERMINAL (self), chunk->str, chunk->len);
+  self->in_paste = FALSE;
+
+  if (self->paste_pos >= self->paste_buffer->len)
+    ptyxis_terminal_paste_clear (self);
+  else
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PASTE_FRACTION]);
+}
+
+static gboolean
+ptyxis_terminal_paste_writable_cb (int          fd,
+                                   GIOCondition condition,
+                                   gpointer     user_data)
+{
+  PtyxisTerminal *self = user_data;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  self->paste_source = 0;
+
+  /* Nothing left to write into once the child has gone away */
+  if ((condition & (G_IO_HUP | G_IO_ERR)) != 0 ||
+      vte_terminal_get_pty (VTE_TERMINAL (self)) == NULL)
+    {
+      ptyxis_terminal_paste_clear (self);
+      return G_SOURCE_REMOVE;
+    }
+
+  ptyxis_terminal_paste_chunk (self);
+  ptyxis_terminal_paste_queue (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ptyxis_terminal_paste_queue (PtyxisTerminal *self)
+{
+  VtePty *pty;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  if (self->paste_buffer == NULL || self->paste_source != 0)
+    return;
+
+  if (!(pty = vte_terminal_get_pty (VTE_TERMINAL (self))))
+    {
+      ptyxis_terminal_paste_clear (self);
+      return;
+    }
+
+  /* Only write the next chunk once the child has made room for it.
+   * The low priority lets input and drawing run in between.
+   */
+  self->paste_source = g_unix_fd_add_full (G_PRIORITY_LOW,
+                                           vte_pty_get_fd (pty),
+                                           G_IO_OUT | G_IO_HUP | G_IO_ERR,
+                                           ptyxis_terminal_paste_writable_cb,
+                                           self, NULL);
+}
+
+/* VTE does not say whether the application enabled bracketed paste,
+ * so an empty paste is made through VTE to see how it gets framed.
+ * Returns FALSE if that could not be determined, in which case the
+ * paste must go through VTE in one piece.
+ */
+static gboolean
+ptyxis_terminal_paste_probe (PtyxisTerminal *self,
+                             gboolean       *bracketed)
+{
+  g_assert (PTYXIS_IS_TERMINAL (self));
+  g_assert (bracketed != NULL);
+
+  self->paste_probing = TRUE;
+  self->paste_probe_committed = FALSE;
+  self->paste_probe_bracketed = FALSE;
+
+  vte_terminal_paste_text (VTE_TERMINAL (self), "");
+
+  self->paste_probing = FALSE;
+
+  *bracketed = self->paste_probe_bracketed;
+
+  return self->paste_probe_committed;
+}
+
+static void
+ptyxis_terminal_paste_text (PtyxisTerminal *self,
+                            const char     *text,
+                            gssize          len)
+{
+  gboolean bracketed = FALSE;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+  g_assert (text != NULL);
+
+  if (len < 0)
+    len = strlen (text);
+
+  if (len == 0)
+    return;
+
+  /* Small pastes go straight through unless they would jump ahead
+   * of a paste which is still in progress.
+   */
+  if (self->paste_buffer == NULL &&
+      (len <= PASTE_CHUNK_THRESHOLD ||
+       vte_terminal_get_pty (VTE_TERMINAL (self)) == NULL ||
+       !ptyxis_terminal_paste_probe (self, &bracketed)))
+    {
+      g_autofree char *copy = g_strndup (text, len);
+
+      self->in_paste = TRUE;
+      vte_terminal_paste_text (VTE_TERMINAL (self), copy);
+      self->in_paste = FALSE;
+      return;
+    }
+
+  if (self->paste_buffer == NULL)
+    {
+      self->paste_buffer = g_string_new_len (text, len);
+      self->paste_pos = 0;
+
+      if (bracketed)
+        {
+          self->paste_framed = TRUE;
+          self->in_paste = TRUE;
+          vte_terminal_feed_child (VTE_TERMINAL (self), BRACKETED_PASTE_BEGIN, -1);
+          self->in_paste = FALSE;
+        }
+
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PASTING]);
+    }
+  else
+    {
+      g_string_append_len (self->paste_buffer, text, len);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PASTE_FRACTION]);
+
+  ptyxis_terminal_paste_queue (self);
+}
+
+static void
+ptyxis_terminal_paste_clipboard_cb (GObject      *object,
+                                    GAsyncResult *result,
+                                    gpointer      user_data)
+{
+  GdkClipboard *clipboard = (GdkClipboard *)object;
+  g_autoptr(PtyxisTerminal) self = user_data;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *text = NULL;
+
+  g_assert (GDK_IS_CLIPBOARD (clipboard));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  if (!(text = gdk_clipboard_read_text_finish (clipboard, result, &error)))
+    {
+      if (error != NULL)
+        g_debug ("Failed to read clipboard: %s", error->message);
+      return;
+    }
+
+  ptyxis_terminal_paste_text (self, text, -1);
+
+  if (vte_terminal_get_scroll_on_keystroke (VTE_TERMINAL (self)))
+    ptyxis_terminal_scroll_to_bottom (self);
+}
+
+static void
+ptyxis_terminal_paste_primary (PtyxisTerminal *self)
+{
+  GdkClipboard *clipboard;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  clipboard = gtk_widget_get_primary_clipboard (GTK_WIDGET (self));
+
+  gdk_clipboard_read_text_async (clipboard,
+                                 NULL,
+                                 ptyxis_terminal_paste_clipboard_cb,
+                                 g_object_ref (self));
+}
+
 typedef struct {
   PtyxisTerminal *terminal;
   GdkDrop *drop;
@@ -523,7 +1147,7 @@ ptyxis_terminal_drop_file_list (PtyxisTerminal *self,
     }
 
   if (string->len > 0)
-    vte_terminal_paste_text (VTE_TERMINAL (self), string->str);
+    ptyxis_terminal_paste_text (self, string->str, string->len);
 }
 
 static void
@@ -690,7 +1314,7 @@ ptyxis_terminal_drop_string_cb (GObject      *object,
   string = g_value_get_string (value);
 
   if (string != NULL && string[0] != 0)
-    vte_terminal_paste_text (VTE_TERMINAL (self), string);
+    ptyxis_terminal_paste_text (self, string, -1);
 
   gdk_drop_finish (drop, GDK_ACTION_COPY);
 }
@@ -865,6 +1489,79 @@ dismiss_size_label_cb (gpointer user_data)
   return G_SOURCE_REMOVE;
 }
 
+static gboolean
+ptyxis_terminal_resize_settled_cb (gpointer user_data)
+{
+  PtyxisTerminal *self = user_data;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  self->resize_source = 0;
+  self->resize_flush = TRUE;
+
+  gtk_widget_queue_allocate (GTK_WIDGET (self));
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * ptyxis_terminal_govern_size:
+ *
+ * Decides what size VTE should be allocated. The widget itself always
+ * takes the new size so that it renders at the correct pixel size, but
+ * VTE keeps the previous size (and grid) until the resize settles so
+ * that applications in the terminal are not sent a SIGWINCH for every
+ * intermediate size.
+ */
+static void
+ptyxis_terminal_govern_size (PtyxisTerminal *self,
+                             int             width,
+                             int             height)
+{
+  gint64 now;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  now = g_get_monotonic_time ();
+
+  if (width == self->governed_width && height == self->governed_height)
+    {
+      g_clear_handle_id (&self->resize_source, g_source_remove);
+      self->resize_begin_time = 0;
+      self->resize_flush = FALSE;
+    }
+  else if (self->resize_flush ||
+           self->governed_width == 0 ||
+           self->governed_height == 0 ||
+           !gtk_widget_get_mapped (GTK_WIDGET (self)))
+    {
+      g_clear_handle_id (&self->resize_source, g_source_remove);
+      self->resize_begin_time = 0;
+      self->resize_flush = FALSE;
+      self->governed_width = width;
+      self->governed_height = height;
+    }
+  else
+    {
+      g_clear_handle_id (&self->resize_source, g_source_remove);
+      self->resize_source = g_timeout_add (RESIZE_SETTLE_MSEC,
+                                           ptyxis_terminal_resize_settled_cb,
+                                           self);
+
+      if (self->resize_begin_time == 0)
+        {
+          self->resize_begin_time = now;
+        }
+      else if (now - self->resize_begin_time >= RESIZE_MAX_DELAY_MSEC * 1000)
+        {
+          /* Still changing, but let the grid catch up at a capped rate */
+          self->resize_begin_time = now;
+          self->governed_width = width;
+          self->governed_height = height;
+        }
+    }
+}
+
 static void
 ptyxis_terminal_size_allocate (GtkWidget *widget,
                                int        width,
@@ -882,7 +1579,12 @@ ptyxis_terminal_size_allocate (GtkWidget *widget,
 
   g_assert (PTYXIS_IS_TERMINAL (self));
 
-  GTK_WIDGET_CLASS (ptyxis_terminal_parent_class)->size_allocate (widget, width, height, baseline);
+  ptyxis_terminal_govern_size (self, width, height);
+
+  GTK_WIDGET_CLASS (ptyxis_terminal_parent_class)->size_allocate (widget,
+                                                                  self->governed_width,
+                                                                  self->governed_height,
+                                                                  baseline);
 
   column_count = vte_terminal_get_column_count (VTE_TERMINAL (self));
   row_count = vte_terminal_get_row_count (VTE_TERMINAL (self));
@@ -959,52 +1661,60 @@ static void
 ptyxis_terminal_rewrite_snapshot (GtkWidget   *widget,
                                   GtkSnapshot *snapshot)
 {
+  PtyxisTerminal *self = PTYXIS_TERMINAL (widget);
   g_autoptr(GtkSnapshot) alternate = NULL;
   g_autoptr(GskRenderNode) root = NULL;
-  g_autoptr(GPtrArray) children = NULL;
+  GPtrArray *children;
   gboolean dropped_bg = FALSE;
 
+  g_assert (PTYXIS_IS_TERMINAL (self));
   g_assert (GTK_IS_SNAPSHOT (snapshot));
 
   alternate = gtk_snapshot_new ();
-  children = g_ptr_array_new ();
 
   GTK_WIDGET_CLASS (ptyxis_terminal_parent_class)->snapshot (widget, alternate);
 
   if (!(root = gtk_snapshot_free_to_node (g_steal_pointer (&alternate))))
     return;
 
-  if (gsk_render_node_get_node_type (root) == GSK_CONTAINER_NODE)
+  if (gsk_render_node_get_node_type (root) != GSK_CONTAINER_NODE)
     {
-      guint n_children = gsk_container_node_get_n_children (root);
+      gtk_snapshot_append_node (snapshot, root);
+      return;
+    }
+
+  if (self->rewrite_children == NULL)
+    self->rewrite_children = g_ptr_array_new ();
 
-      for (guint i = 0; i < n_children; i++)
+  children = self->rewrite_children;
+  g_ptr_array_set_size (children, 0);
+
+  for (guint i = 0, n_children = gsk_container_node_get_n_children (root); i < n_children; i++)
+    {
+      GskRenderNode *node = gsk_container_node_get_child (root, i);
+      GskRenderNodeType node_type = gsk_render_node_get_node_type (node);
+
+      /* Drop the color node because we get that for free from our
+       * background recoloring. This avoids an extra large overdraw
+       * as a bonus optimization while we fix clipping.
+       */
+      if (!dropped_bg && node_type == GSK_COLOR_NODE)
         {
-          GskRenderNode *node = gsk_container_node_get_child (root, i);
-          GskRenderNodeType node_type = gsk_render_node_get_node_type (node);
-
-          /* Drop the color node because we get that for free from our
-           * background recoloring. This avoids an extra large overdraw
-           * as a bonus optimization while we fix clipping.
-           */
-          if (!dropped_bg && node_type == GSK_COLOR_NODE)
-            {
-              dropped_bg = TRUE;
-              continue;
-            }
-
-          /* If we get a clip node here, it's because we're in some
-           * sort of window size that has partial line offset in the
-           * drag resize, or we're scrolled up a bit so the line doesn't
-           * exactly match our actual sizing. In that case we'll replace
-           * the clip with our own so that we get nice padding normally
-           * but appropriate draws up to the border elsewise.
-           */
-          if (node_type == GSK_CLIP_NODE)
-            node = gsk_clip_node_get_child (node);
-
-          g_ptr_array_add (children, node);
+          dropped_bg = TRUE;
+          continue;
         }
+
+      /* If we get a clip node here, it's because we're in some
+       * sort of window size that has partial line offset in the
+       * drag resize, or we're scrolled up a bit so the line doesn't
+       * exactly match our actual sizing. In that case we'll replace
+       * the clip with our own so that we get nice padding normally
+       * but appropriate draws up to the border elsewise.
+       */
+      if (node_type == GSK_CLIP_NODE)
+        node = gsk_clip_node_get_child (node);
+
+      g_ptr_array_add (children, node);
     }
 
   if (children->len > 0)
@@ -1016,6 +1726,9 @@ ptyxis_terminal_rewrite_snapshot (GtkWidget   *widget,
       root = new_root;
     }
 
+  /* We don't own references to the children, drop them now */
+  g_ptr_array_set_size (children, 0);
+
   gtk_snapshot_append_node (snapshot, root);
 }
 
@@ -1046,29 +1759,153 @@ ptyxis_terminal_snapshot (GtkWidget   *widget,
 }
 
 static void
-ptyxis_terminal_shortcuts_notify_cb (PtyxisTerminal  *self,
+ptyxis_terminal_shortcuts_notify_cb (GMenu           *menu,
                                      GParamSpec      *pspec,
                                      PtyxisShortcuts *shortcuts)
 {
-  g_assert (PTYXIS_IS_TERMINAL (self));
+  g_assert (G_IS_MENU (menu));
   g_assert (PTYXIS_IS_SHORTCUTS (shortcuts));
 
-  ptyxis_shortcuts_update_menu (shortcuts, self->terminal_menu);
+  ptyxis_shortcuts_update_menu (shortcuts, menu);
+}
+
+static void
+ptyxis_terminal_add_prompt_mark (PtyxisTerminal       *self,
+                                 PtyxisPromptMarkKind  kind)
+{
+  glong cursor_row;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  vte_terminal_get_cursor_position (VTE_TERMINAL (self), NULL, &cursor_row);
+  ptyxis_prompt_marks_add (self->prompt_marks, cursor_row, kind);
+}
+
+static char *
+ptyxis_terminal_dup_input_text (PtyxisTerminal *self)
+{
+  g_autofree char *text = NULL;
+  glong cursor_row;
+  glong end_row;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  if (!self->has_input_position)
+    return NULL;
+
+  /* The shell has already moved to the next line by the time preexec
+   * is reported, so the command ends on the row above the cursor.
+   */
+  vte_terminal_get_cursor_position (VTE_TERMINAL (self), NULL, &cursor_row);
+  end_row = MAX (self->input_row, cursor_row - 1);
+
+  text = vte_terminal_get_text_range_format (VTE_TERMINAL (self),
+                                             VTE_FORMAT_TEXT,
+                                             self->input_row,
+                                             self->input_column,
+                                             end_row,
+                                             vte_terminal_get_column_count (VTE_TERMINAL (self)),
+                                             NULL);
+
+  if (text == NULL || g_strstrip (text)[0] == 0)
+    return NULL;
+
+  return g_steal_pointer (&text);
+}
+
+static void
+ptyxis_terminal_commit_cb (PtyxisTerminal *self,
+                           const char     *text,
+                           guint           size)
+{
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  if (self->paste_probing)
+    {
+      self->paste_probe_committed = TRUE;
+      self->paste_probe_bracketed = size >= strlen (BRACKETED_PASTE_BEGIN) &&
+                                    memcmp (text, BRACKETED_PASTE_BEGIN, strlen (BRACKETED_PASTE_BEGIN)) == 0;
+      return;
+    }
+
+  /* The first input after the prompt is drawn marks where the command
+   * text begins. Nothing else is done per keystroke.
+   */
+  if (self->at_prompt && !self->has_input_position)
+    {
+      vte_terminal_get_cursor_position (VTE_TERMINAL (self),
+                                        &self->input_column,
+                                        &self->input_row);
+      self->has_input_position = TRUE;
+    }
+}
+
+static void
+ptyxis_terminal_shell_postexec_cb (PtyxisTerminal *self)
+{
+  guint64 value;
+
+  g_assert (PTYXIS_IS_TERMINAL (self));
+
+  /* When the status arrives along with the next prompt, precmd has
+   * already read it and this would only leave a stale status behind.
+   */
+  if (self->at_prompt)
+    return;
+
+  if (vte_terminal_get_termprop_uint_by_id (VTE_TERMINAL (self),
+                                            VTE_PROPERTY_ID_SHELL_POSTEXEC,
+                                            &value))
+    self->last_exit_status = MIN (value, G_MAXINT);
 }
 
 static void
 ptyxis_terminal_emit_shell_precmd (PtyxisTerminal *self)
 {
+  int exit_status = self->last_exit_status;
+  guint64 value;
+
   g_assert (PTYXIS_IS_TERMINAL (self));
 
+  ptyxis_terminal_add_prompt_mark (self, PTYXIS_PROMPT_MARK_PROMPT);
+
+  /* VTE emits changed termprops in the order of their ids, so precmd
+   * runs before postexec when the shell sends both together. Read the
+   * status here rather than relying on postexec having run first.
+   */
+  if (vte_terminal_get_termprop_uint_by_id (VTE_TERMINAL (self),
+                                            VTE_PROPERTY_ID_SHELL_POSTEXEC,
+                                            &value))
+    exit_status = MIN (value, G_MAXINT);
+
+  ptyxis_command_history_end (self->command_history,
+                              exit_status,
+                              g_get_monotonic_time ());
+
+  self->last_exit_status = -1;
+  self->at_prompt = TRUE;
+  self->has_input_position = FALSE;
+
   g_signal_emit (self, signals[SHELL_PRECMD], 0);
 }
 
 static void
 ptyxis_terminal_emit_shell_preexec (PtyxisTerminal *self)
 {
+  g_autofree char *command_line = NULL;
+
   g_assert (PTYXIS_IS_TERMINAL (self));
 
+  ptyxis_terminal_add_prompt_mark (self, PTYXIS_PROMPT_MARK_OUTPUT);
+
+  command_line = ptyxis_terminal_dup_input_text (self);
+  ptyxis_command_history_begin (self->command_history,
+                                command_line,
+                                g_get_monotonic_time ());
+
+  self->at_prompt = FALSE;
+  self->has_input_position = FALSE;
+
   g_signal_emit (self, signals[SHELL_PREEXEC], 0);
 }
 
@@ -1111,10 +1948,21 @@ ptyxis_terminal_dispose (GObject *object)
 
   gtk_widget_dispose_template (GTK_WIDGET (self), PTYXIS_TYPE_TERMINAL);
 
+  g_cancellable_cancel (self->export_cancellable);
+  g_clear_object (&self->export_cancellable);
+
   g_clear_object (&self->palette);
   g_clear_object (&self->shortcuts);
   g_clear_handle_id (&self->size_dismiss_source, g_source_remove);
+  g_clear_handle_id (&self->resize_source, g_source_remove);
+  g_clear_handle_id (&self->paste_source, g_source_remove);
   g_clear_pointer (&self->url, g_free);
+  if (self->paste_buffer != NULL)
+    g_string_free (g_steal_pointer (&self->paste_buffer), TRUE);
+  g_clear_pointer (&self->prompt_marks, ptyxis_prompt_marks_free);
+  g_clear_pointer (&self->command_history, ptyxis_command_history_free);
+
+  g_clear_pointer (&self->rewrite_children, g_ptr_array_unref);
 
   G_OBJECT_CLASS (ptyxis_terminal_parent_class)->dispose (object);
 }
@@ -1147,6 +1995,14 @@ ptyxis_terminal_get_property (GObject    *object,
       g_value_set_object (value, ptyxis_terminal_get_palette (self));
       break;
 
+    case PROP_PASTE_FRACTION:
+      g_value_set_double (value, ptyxis_terminal_get_paste_fraction (self));
+      break;
+
+    case PROP_PASTING:
+      g_value_set_boolean (value, ptyxis_terminal_get_pasting (self));
+      break;
+
     case PROP_SHORTCUTS:
       g_value_set_object (value, self->shortcuts);
       break;
@@ -1181,6 +2037,7 @@ ptyxis_terminal_class_init (PtyxisTerminalClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
   VteTerminalClass *terminal_class = VTE_TERMINAL_CLASS (klass);
+  g_autoptr(GtkBuilder) builder = NULL;
 
   object_class->constructed = ptyxis_terminal_constructed;
   object_class->dispose = ptyxis_terminal_dispose;
@@ -1213,6 +2070,20 @@ ptyxis_terminal_class_init (PtyxisTerminalClass *klass)
                           G_PARAM_EXPLICIT_NOTIFY |
                           G_PARAM_STATIC_STRINGS));
 
+  properties[PROP_PASTE_FRACTION] =
+    g_param_spec_double ("paste-fraction", NULL, NULL,
+                         0, 1, 0,
+                         (G_PARAM_READABLE |
+                          G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS));
+
+  properties[PROP_PASTING] =
+    g_param_spec_boolean ("pasting", NULL, NULL,
+                          FALSE,
+                          (G_PARAM_READABLE |
+                           G_PARAM_EXPLICIT_NOTIFY |
+                           G_PARAM_STATIC_STRINGS));
+
   properties[PROP_SHORTCUTS] =
     g_param_spec_object ("shortcuts", NULL, NULL,
                          PTYXIS_TYPE_SHORTCUTS,
@@ -1267,13 +2138,12 @@ ptyxis_terminal_class_init (PtyxisTerminalClass *klass)
 
   gtk_widget_class_bind_template_child (widget_class, PtyxisTerminal, drop_highlight);
   gtk_widget_class_bind_template_child (widget_class, PtyxisTerminal, drop_target);
-  gtk_widget_class_bind_template_child (widget_class, PtyxisTerminal, popover);
   gtk_widget_class_bind_template_child (widget_class, PtyxisTerminal, size_label);
   gtk_widget_class_bind_template_child (widget_class, PtyxisTerminal, size_revealer);
-  gtk_widget_class_bind_template_child (widget_class, PtyxisTerminal, terminal_menu);
 
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_terminal_capture_click_pressed_cb);
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_terminal_capture_key_pressed_cb);
+  gtk_widget_class_bind_template_callback (widget_class, ptyxis_terminal_capture_key_released_cb);
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_terminal_drop_target_drag_enter);
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_terminal_drop_target_drag_leave);
   gtk_widget_class_bind_template_callback (widget_class, ptyxis_terminal_drop_target_drop);
@@ -1284,6 +2154,13 @@ ptyxis_terminal_class_init (PtyxisTerminalClass *klass)
   gtk_widget_class_install_action (widget_class, "clipboard.paste", NULL, paste_clipboard_action);
   gtk_widget_class_install_action (widget_class, "terminal.open-link", NULL, open_link_action);
   gtk_widget_class_install_action (widget_class, "terminal.select-all", "b", select_all_action);
+  gtk_widget_class_install_action (widget_class, "terminal.save-output", NULL, save_output_action);
+  gtk_widget_class_install_action (widget_class, "terminal.previous-prompt", NULL, previous_prompt_action);
+  gtk_widget_class_install_action (widget_class, "terminal.next-prompt", NULL, next_prompt_action);
+  gtk_widget_class_install_action (widget_class, "terminal.copy-last-output", NULL, copy_last_output_action);
+
+  builder = gtk_builder_new_from_resource ("/org/gnome/Ptyxis/ptyxis-terminal-menu.ui");
+  shared_terminal_menu = g_object_ref (G_MENU (gtk_builder_get_object (builder, "terminal_menu")));
 
   for (guint i = 0; i < G_N_ELEMENTS (url_regexes); i++)
     {
@@ -1314,14 +2191,30 @@ ptyxis_terminal_init (PtyxisTerminal *self)
 
   g_set_object (&self->shortcuts, shortcuts);
 
+  self->prompt_marks = ptyxis_prompt_marks_new (PROMPT_MARKS_CAPACITY);
+  self->command_history = ptyxis_command_history_new (COMMAND_HISTORY_MAX);
+  self->last_exit_status = -1;
+
   gtk_widget_init_template (GTK_WIDGET (self));
 
-  g_signal_connect_object (shortcuts,
-                           "notify",
-                           G_CALLBACK (ptyxis_terminal_shortcuts_notify_cb),
-                           self,
-                           G_CONNECT_SWAPPED);
-  ptyxis_terminal_shortcuts_notify_cb (self, NULL, shortcuts);
+  /* Shortcuts belong to the application which may not exist yet
+   * when the class is initialized, so track them with the first
+   * terminal instead.
+   */
+  if (!shared_terminal_menu_tracked)
+    {
+      shared_terminal_menu_tracked = TRUE;
+      g_signal_connect_object (shortcuts,
+                               "notify",
+                               G_CALLBACK (ptyxis_terminal_shortcuts_notify_cb),
+                               shared_terminal_menu,
+                               G_CONNECT_SWAPPED);
+      ptyxis_terminal_shortcuts_notify_cb (shared_terminal_menu, NULL, shortcuts);
+    }
+
+  self->popover = GTK_POPOVER (gtk_popover_menu_new_from_model (G_MENU_MODEL (shared_terminal_menu)));
+  gtk_popover_set_has_arrow (self->popover, FALSE);
+  vte_terminal_set_context_menu (VTE_TERMINAL (self), GTK_WIDGET (self->popover));
 
   for (guint i = 0; i < G_N_ELEMENTS (url_regexes); i++)
     {
@@ -1355,6 +2248,14 @@ ptyxis_terminal_init (PtyxisTerminal *self)
                     "termprop-changed::" VTE_TERMPROP_SHELL_PREEXEC,
                     G_CALLBACK (ptyxis_terminal_emit_shell_preexec),
                     NULL);
+  g_signal_connect (self,
+                    "termprop-changed::" VTE_TERMPROP_SHELL_POSTEXEC,
+                    G_CALLBACK (ptyxis_terminal_shell_postexec_cb),
+                    NULL);
+  g_signal_connect (self,
+                    "commit",
+                    G_CALLBACK (ptyxis_terminal_commit_cb),
+                    NULL);
   g_signal_connect (self,
                     "termprop-changed::" VTE_TERMPROP_CONTAINER_NAME,
                     G_CALLBACK (notify_property_changed),
@@ -1465,10 +2366,184 @@ ptyxis_terminal_can_paste (PtyxisTerminal *self)
 void
 ptyxis_terminal_paste (PtyxisTerminal *self)
 {
+  GdkClipboard *clipboard;
+
   g_return_if_fail (PTYXIS_IS_TERMINAL (self));
 
-  vte_terminal_paste_clipboard (VTE_TERMINAL (self));
+  clipboard = gtk_widget_get_clipboard (GTK_WIDGET (self));
+
+  gdk_clipboard_read_text_async (clipboard,
+                                 NULL,
+                                 ptyxis_terminal_paste_clipboard_cb,
+                                 g_object_ref (self));
+}
 
-  if (vte_terminal_get_scroll_on_keystroke (VTE_TERMINAL (self)))
-    ptyxis_terminal_scroll_to_bottom (self);
+
+/**
+ * ptyxis_terminal_get_pasting:
+ * @self: a #PtyxisTerminal
+ *
+ * Checks if a large paste is still being streamed to the PTY.
+ */
+gboolean
+ptyxis_terminal_get_pasting (PtyxisTerminal *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_TERMINAL (self), FALSE);
+
+  return self->paste_buffer != NULL;
+}
+
+/**
+ * ptyxis_terminal_get_paste_fraction:
+ * @self: a #PtyxisTerminal
+ *
+ * Returns: how much of the current paste has been written, between
+ *   0 and 1, or 0 if there is no paste in progress
+ */
+double
+ptyxis_terminal_get_paste_fraction (PtyxisTerminal *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_TERMINAL (self), 0);
+
+  if (self->paste_buffer == NULL || self->paste_buffer->len == 0)
+    return 0;
+
+  return (double)self->paste_pos / (double)self->paste_buffer->len;
+}
+
+/**
+ * ptyxis_terminal_cancel_paste:
+ * @self: a #PtyxisTerminal
+ *
+ * Stops streaming the current paste. Whatever has already been
+ * written to the PTY is left as is.
+ */
+void
+ptyxis_terminal_cancel_paste (PtyxisTerminal *self)
+{
+  g_return_if_fail (PTYXIS_IS_TERMINAL (self));
+
+  ptyxis_terminal_paste_clear (self);
+}
+
+/**
+ * _ptyxis_terminal_read_rows:
+ * @self: a #PtyxisTerminal
+ * @next_row: (inout): the first row which has not yet been read
+ * @max_rows: the maximum number of rows to read
+ * @include_cursor: if the row containing the cursor should be read
+ * @n_lost: (out) (optional): location for the number of rows which left
+ *   the scrollback before they could be read
+ * @bytes: (out) (transfer full) (nullable): location for the text
+ *
+ * Helper for consumers which follow the output of the terminal row by
+ * row, such as output logging. Only completed rows are read unless
+ * @include_cursor is set, since the row containing the cursor may
+ * still change.
+ *
+ * Returns: %TRUE if there are more completed rows to read
+ */
+gboolean
+_ptyxis_terminal_read_rows (PtyxisTerminal  *self,
+                            gint64          *next_row,
+                            gint64           max_rows,
+                            gboolean         include_cursor,
+                            gint64          *n_lost,
+                            GBytes         **bytes)
+{
+  glong cursor_row;
+  gint64 lower;
+  gint64 upper;
+  gint64 end_row;
+  gsize len = 0;
+  char *text;
+
+  g_return_val_if_fail (PTYXIS_IS_TERMINAL (self), FALSE);
+  g_return_val_if_fail (next_row != NULL, FALSE);
+  g_return_val_if_fail (max_rows > 0, FALSE);
+  g_return_val_if_fail (bytes != NULL, FALSE);
+
+  *bytes = NULL;
+
+  if (n_lost != NULL)
+    *n_lost = 0;
+
+  ptyxis_vte_get_row_bounds (VTE_TERMINAL (self), &lower, NULL, &upper);
+  vte_terminal_get_cursor_position (VTE_TERMINAL (self), NULL, &cursor_row);
+
+  /* The cursor moving up (such as to redraw a progress bar) must not
+   * cause rows to be read again, so only start over once the rows we
+   * have read no longer exist because the terminal was reset or its
+   * history cleared.
+   */
+  if (upper < *next_row)
+    *next_row = lower;
+
+  if (lower > *next_row)
+    {
+      if (n_lost != NULL)
+        *n_lost = lower - *next_row;
+      *next_row = lower;
+    }
+
+  end_row = include_cursor ? cursor_row + 1 : cursor_row;
+
+  if (end_row - *next_row > max_rows)
+    end_row = *next_row + max_rows;
+
+  if (end_row <= *next_row)
+    return FALSE;
+
+  text = vte_terminal_get_text_range_format (VTE_TERMINAL (self),
+                                             VTE_FORMAT_TEXT,
+                                             *next_row, 0,
+                                             end_row - 1,
+                                             vte_terminal_get_column_count (VTE_TERMINAL (self)),
+                                             &len);
+  *next_row = end_row;
+
+  if (text != NULL && len > 0)
+    *bytes = g_bytes_new_take (text, len);
+  else
+    g_free (text);
+
+  return *next_row < cursor_row;
+}
+
+/**
+ * _ptyxis_terminal_get_command_history:
+ * @self: a #PtyxisTerminal
+ *
+ * Gets the commands which have been reported by shell integration.
+ *
+ * Returns: (transfer none): a #PtyxisCommandHistory
+ */
+PtyxisCommandHistory *
+_ptyxis_terminal_get_command_history (PtyxisTerminal *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_TERMINAL (self), NULL);
+
+  return self->command_history;
+}
+
+/**
+ * _ptyxis_terminal_is_user_input:
+ * @self: a #PtyxisTerminal
+ *
+ * Checks if the #VteTerminal::commit being emitted comes from the user
+ * typing into the focused terminal or pasting into it, rather than from
+ * a reply generated by VTE or input fed to the child by other means.
+ *
+ * Returns: %TRUE if the commit is input from the user
+ */
+gboolean
+_ptyxis_terminal_is_user_input (PtyxisTerminal *self)
+{
+  g_return_val_if_fail (PTYXIS_IS_TERMINAL (self), FALSE);
+
+  if (self->paste_probing)
+    return FALSE;
+
+  return self->in_paste ||
+         (self->key_down && gtk_widget_has_focus (GTK_WIDGET (self)));
 }
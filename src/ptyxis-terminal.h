@@ -40,5 +40,8 @@ char          *ptyxis_terminal_dup_current_directory_uri     (PtyxisTerminal *se
 char          *ptyxis_terminal_dup_current_file_uri          (PtyxisTerminal *self);
 gboolean       ptyxis_terminal_can_paste                     (PtyxisTerminal *self);
 void           ptyxis_terminal_paste                         (PtyxisTerminal *self);
+gboolean       ptyxis_terminal_get_pasting                   (PtyxisTerminal *self);
+double         ptyxis_terminal_get_paste_fraction            (PtyxisTerminal *self);
+void           ptyxis_terminal_cancel_paste                  (PtyxisTerminal *self);
 
 G_END_DECLS
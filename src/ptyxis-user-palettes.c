@@ -30,6 +30,7 @@ struct _PtyxisUserPalettes
   GFileMonitor *monitor;
   GHashTable   *file_to_palette;
   GPtrArray    *items;
+  guint         loaded : 1;
 };
 
 static gpointer
@@ -70,42 +71,52 @@ G_DEFINE_FINAL_TYPE_WITH_CODE (PtyxisUserPalettes, ptyxis_user_palettes, G_TYPE_
                                G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, list_model_iface_init))
 
 static void
-ptyxis_user_palettes_load_file (PtyxisUserPalettes *self,
-                                const char         *path)
+ptyxis_user_palettes_add (PtyxisUserPalettes *self,
+                          const char         *path,
+                          PtyxisPalette      *palette)
 {
-  g_autoptr(PtyxisPalette) palette = NULL;
-  g_autoptr(GError) error = NULL;
+  PtyxisPalette *previous;
 
   g_assert (PTYXIS_IS_USER_PALETTES (self));
   g_assert (path != NULL);
+  g_assert (PTYXIS_IS_PALETTE (palette));
 
-  if ((palette = ptyxis_palette_new_from_file (path, &error)))
+  if ((previous = g_hash_table_lookup (self->file_to_palette, path)))
     {
-      PtyxisPalette *previous;
+      guint pos;
 
-      if ((previous = g_hash_table_lookup (self->file_to_palette, path)))
+      if (g_ptr_array_find (self->items, previous, &pos))
         {
-          guint pos;
-
-          if (g_ptr_array_find (self->items, previous, &pos))
-            {
-              g_object_unref (g_ptr_array_index (self->items, pos));
-              g_ptr_array_index (self->items, pos) = g_object_ref (palette);
-              g_hash_table_insert (self->file_to_palette,
-                                   g_strdup (path),
-                                   g_object_ref (palette));
-              g_list_model_items_changed (G_LIST_MODEL (self), pos, 1, 1);
-              return;
-            }
+          g_object_unref (g_ptr_array_index (self->items, pos));
+          g_ptr_array_index (self->items, pos) = g_object_ref (palette);
+          g_hash_table_insert (self->file_to_palette,
+                               g_strdup (path),
+                               g_object_ref (palette));
+          g_list_model_items_changed (G_LIST_MODEL (self), pos, 1, 1);
+          return;
         }
-
-      g_hash_table_insert (self->file_to_palette,
-                           g_strdup (path),
-                           g_object_ref (palette));
-      g_ptr_array_add (self->items, g_object_ref (palette));
-      g_list_model_items_changed (G_LIST_MODEL (self), self->items->len - 1, 0, 1);
     }
 
+  g_hash_table_insert (self->file_to_palette,
+                       g_strdup (path),
+                       g_object_ref (palette));
+  g_ptr_array_add (self->items, g_object_ref (palette));
+  g_list_model_items_changed (G_LIST_MODEL (self), self->items->len - 1, 0, 1);
+}
+
+static void
+ptyxis_user_palettes_load_file (PtyxisUserPalettes *self,
+                                const char         *path)
+{
+  g_autoptr(PtyxisPalette) palette = NULL;
+  g_autoptr(GError) error = NULL;
+
+  g_assert (PTYXIS_IS_USER_PALETTES (self));
+  g_assert (path != NULL);
+
+  if ((palette = ptyxis_palette_new_from_file (path, &error)))
+    ptyxis_user_palettes_add (self, path, palette);
+
   if (error)
     g_warning ("%s", error->message);
 }
@@ -160,31 +171,92 @@ ptyxis_user_palettes_init (PtyxisUserPalettes *self)
 }
 
 static void
-ptyxis_user_palettes_load (PtyxisUserPalettes *self)
+ptyxis_user_palettes_load_worker (GTask        *task,
+                                  gpointer      source_object,
+                                  gpointer      task_data,
+                                  GCancellable *cancellable)
 {
   g_autoptr(GFileEnumerator) enumerator = NULL;
+  g_autoptr(GHashTable) palettes = NULL;
+  GFile *directory = task_data;
   gpointer infoptr;
 
-  g_assert (PTYXIS_IS_USER_PALETTES (self));
-  g_assert (G_IS_FILE (self->directory));
+  g_assert (G_IS_TASK (task));
+  g_assert (G_IS_FILE (directory));
 
-  enumerator = g_file_enumerate_children (self->directory,
+  palettes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+  enumerator = g_file_enumerate_children (directory,
                                           G_FILE_ATTRIBUTE_STANDARD_NAME,
                                           0,
-                                          NULL,
+                                          cancellable,
                                           NULL);
-  if (enumerator == NULL)
-    return;
 
-  while ((infoptr = g_file_enumerator_next_file (enumerator, NULL, NULL)))
+  while (enumerator != NULL &&
+         (infoptr = g_file_enumerator_next_file (enumerator, cancellable, NULL)))
     {
       g_autoptr(GFileInfo) info = infoptr;
       g_autoptr(GFile) file = g_file_enumerator_get_child (enumerator, info);
+      g_autoptr(PtyxisPalette) palette = NULL;
+      g_autoptr(GError) error = NULL;
       const char *path = g_file_peek_path (file);
 
-      if (g_str_has_suffix (path, ".palette"))
-        ptyxis_user_palettes_load_file (self, path);
+      if (!g_str_has_suffix (path, ".palette"))
+        continue;
+
+      if ((palette = ptyxis_palette_new_from_file (path, &error)))
+        g_hash_table_insert (palettes, g_strdup (path), g_steal_pointer (&palette));
+      else
+        g_warning ("%s", error->message);
     }
+
+  g_task_return_pointer (task,
+                         g_steal_pointer (&palettes),
+                         (GDestroyNotify)g_hash_table_unref);
+}
+
+static void
+ptyxis_user_palettes_load_cb (GObject      *object,
+                              GAsyncResult *result,
+                              gpointer      user_data)
+{
+  PtyxisUserPalettes *self = (PtyxisUserPalettes *)object;
+  g_autoptr(GHashTable) palettes = NULL;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_assert (PTYXIS_IS_USER_PALETTES (self));
+  g_assert (G_IS_TASK (result));
+
+  if (!(palettes = g_task_propagate_pointer (G_TASK (result), NULL)) ||
+      self->directory == NULL)
+    return;
+
+  self->loaded = TRUE;
+
+  /* Anything the monitor loaded while we were scanning is newer */
+  g_hash_table_iter_init (&iter, palettes);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      if (!g_hash_table_contains (self->file_to_palette, key))
+        ptyxis_user_palettes_add (self, key, value);
+    }
+}
+
+static void
+ptyxis_user_palettes_load (PtyxisUserPalettes *self)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_assert (PTYXIS_IS_USER_PALETTES (self));
+  g_assert (G_IS_FILE (self->directory));
+
+  /* Parsing every palette can take a while with many of them, so do
+   * it on a worker thread and add them as a batch when done.
+   */
+  task = g_task_new (self, NULL, ptyxis_user_palettes_load_cb, NULL);
+  g_task_set_source_tag (task, ptyxis_user_palettes_load);
+  g_task_set_task_data (task, g_object_ref (self->directory), g_object_unref);
+  g_task_run_in_thread (task, ptyxis_user_palettes_load_worker);
 }
 
 static void
@@ -258,3 +330,39 @@ ptyxis_user_palettes_new (const char *directory)
 
   return self;
 }
+
+/**
+ * ptyxis_user_palettes_load_path:
+ * @self: a #PtyxisUserPalettes
+ * @path: the path of a palette file within the directory
+ *
+ * Gets the palette for @path. Until the directory has been scanned the
+ * file is loaded right away and kept, so that the scan does not have to
+ * be waited on nor the file parsed again.
+ *
+ * Returns: (transfer full) (nullable): a #PtyxisPalette or %NULL
+ */
+PtyxisPalette *
+ptyxis_user_palettes_load_path (PtyxisUserPalettes *self,
+                                const char         *path)
+{
+  g_autoptr(PtyxisPalette) palette = NULL;
+  PtyxisPalette *existing;
+
+  g_return_val_if_fail (PTYXIS_IS_USER_PALETTES (self), NULL);
+  g_return_val_if_fail (path != NULL, NULL);
+
+  if ((existing = g_hash_table_lookup (self->file_to_palette, path)))
+    return g_object_ref (existing);
+
+  /* The monitor keeps us up to date once the scan has completed */
+  if (self->loaded)
+    return NULL;
+
+  if (!(palette = ptyxis_palette_new_from_file (path, NULL)))
+    return NULL;
+
+  ptyxis_user_palettes_add (self, path, palette);
+
+  return g_steal_pointer (&palette);
+}
@@ -456,3 +456,75 @@ ptyxis_make_default (void)
 
   return ptyxis_is_default ();
 }
+
+static double
+ptyxis_vte_get_scroll_unit (VteTerminal *terminal)
+{
+  /* With pixel scrolling the adjustment is in pixels rather than rows */
+  if (vte_terminal_get_scroll_unit_is_pixels (terminal))
+    return MAX (1, vte_terminal_get_char_height (terminal));
+
+  return 1;
+}
+
+/**
+ * ptyxis_vte_get_row_bounds:
+ * @terminal: a #VteTerminal
+ * @first_row: (out) (optional): the oldest row still in the scrollback
+ * @top_row: (out) (optional): the row at the top of the view
+ * @end_row: (out) (optional): the row after the last row
+ *
+ * Gets the range of rows in @terminal from its vertical adjustment,
+ * regardless of whether it scrolls by rows or pixels.
+ */
+void
+ptyxis_vte_get_row_bounds (VteTerminal *terminal,
+                           gint64      *first_row,
+                           gint64      *top_row,
+                           gint64      *end_row)
+{
+  GtkAdjustment *vadj;
+  double unit;
+
+  g_return_if_fail (VTE_IS_TERMINAL (terminal));
+
+  vadj = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (terminal));
+  unit = ptyxis_vte_get_scroll_unit (terminal);
+
+  if (first_row != NULL)
+    *first_row = (gint64)(gtk_adjustment_get_lower (vadj) / unit);
+
+  if (top_row != NULL)
+    *top_row = (gint64)(gtk_adjustment_get_value (vadj) / unit);
+
+  if (end_row != NULL)
+    *end_row = (gint64)(gtk_adjustment_get_upper (vadj) / unit);
+}
+
+/**
+ * ptyxis_vte_scroll_to_row:
+ * @terminal: a #VteTerminal
+ * @row: the row to place at the top of the view
+ *
+ * Scrolls @terminal so that @row is at the top of the view, or as close
+ * to it as the scrollback allows.
+ */
+void
+ptyxis_vte_scroll_to_row (VteTerminal *terminal,
+                          gint64       row)
+{
+  GtkAdjustment *vadj;
+  double lower;
+  double upper;
+
+  g_return_if_fail (VTE_IS_TERMINAL (terminal));
+
+  vadj = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (terminal));
+  lower = gtk_adjustment_get_lower (vadj);
+  upper = gtk_adjustment_get_upper (vadj) - gtk_adjustment_get_page_size (vadj);
+
+  gtk_adjustment_set_value (vadj,
+                            CLAMP (row * ptyxis_vte_get_scroll_unit (terminal),
+                                   lower,
+                                   MAX (lower, upper)));
+}
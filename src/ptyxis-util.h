@@ -59,6 +59,12 @@ GVariant           *ptyxis_variant_new_toast     (const char *title,
                                                   guint       timeout);
 gboolean            ptyxis_is_default            (void);
 gboolean            ptyxis_make_default          (void);
+void                ptyxis_vte_get_row_bounds    (VteTerminal *terminal,
+                                                  gint64      *first_row,
+                                                  gint64      *top_row,
+                                                  gint64      *end_row);
+void                ptyxis_vte_scroll_to_row     (VteTerminal *terminal,
+                                                  gint64       row);
 
 static inline void
 ptyxis_take_str (char **out_str,
@@ -28,15 +28,30 @@
 #include "ptyxis-application.h"
 #include "ptyxis-window-dressing.h"
 
-struct _PtyxisWindowDressing
+/* Styles no longer used by any window which are kept around so that
+ * switching back to them does not require parsing CSS again.
+ */
+#define MAX_UNUSED_STYLES 4
+
+/* A CSS provider shared by every window dressing with the same inputs.
+ * Each style has its own CSS class which windows using it are given.
+ */
+typedef struct _PtyxisDressingStyle
 {
-  GObject         parent_instance;
-  GWeakRef        window_wr;
-  PtyxisPalette  *palette;
-  GtkCssProvider *css_provider;
+  char           *key;
   char           *css_class;
-  double          opacity;
-  guint           queued_update;
+  GtkCssProvider *css_provider;
+  guint           n_users;
+} PtyxisDressingStyle;
+
+struct _PtyxisWindowDressing
+{
+  GObject              parent_instance;
+  GWeakRef             window_wr;
+  PtyxisPalette       *palette;
+  PtyxisDressingStyle *style;
+  double               opacity;
+  guint                queued_update;
 };
 
 enum {
@@ -51,21 +66,87 @@ G_DEFINE_FINAL_TYPE (PtyxisWindowDressing, ptyxis_window_dressing, G_TYPE_OBJECT
 
 static GParamSpec *properties[N_PROPS];
 static guint last_sequence;
+static GHashTable *styles;
+static GQueue unused_styles;
 
 static void
-ptyxis_window_dressing_update (PtyxisWindowDressing *self)
+ptyxis_dressing_style_free (PtyxisDressingStyle *style)
+{
+  g_assert (style->n_users == 0);
+
+  g_clear_pointer (&style->key, g_free);
+  g_clear_pointer (&style->css_class, g_free);
+  g_clear_object (&style->css_provider);
+  g_free (style);
+}
+
+static void
+ptyxis_dressing_style_release (PtyxisDressingStyle *style)
+{
+  g_assert (style != NULL);
+  g_assert (style->n_users > 0);
+
+  if (--style->n_users > 0)
+    return;
+
+  gtk_style_context_remove_provider_for_display (gdk_display_get_default (),
+                                                 GTK_STYLE_PROVIDER (style->css_provider));
+
+  g_queue_push_head (&unused_styles, style);
+
+  while (unused_styles.length > MAX_UNUSED_STYLES)
+    {
+      PtyxisDressingStyle *expired = g_queue_pop_tail (&unused_styles);
+
+      g_hash_table_remove (styles, expired->key);
+    }
+}
+
+static char *
+ptyxis_window_dressing_build_key (PtyxisWindowDressing *self,
+                                  gboolean              dark)
+{
+  PtyxisSettings *settings = ptyxis_application_get_settings (PTYXIS_APPLICATION_DEFAULT);
+  g_autofree char *checksum = NULL;
+  char opacity_str[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_assert (PTYXIS_IS_WINDOW_DRESSING (self));
+
+  if (self->palette == NULL)
+    return g_strdup ("");
+
+  /* User palettes may be edited without changing their id, so the
+   * colors themselves are part of the key.
+   */
+  checksum = g_compute_checksum_for_data (G_CHECKSUM_MD5,
+                                          (const guint8 *)ptyxis_palette_get_face (self->palette, dark),
+                                          sizeof (PtyxisPaletteFace));
+  g_ascii_dtostr (opacity_str, sizeof opacity_str, self->opacity);
+
+  return g_strdup_printf ("%s:%s:%s:%d:%d:%s",
+                          ptyxis_palette_get_id (self->palette),
+                          dark ? "dark" : "light",
+                          opacity_str,
+                          ptyxis_settings_get_visual_process_leader (settings),
+                          ptyxis_palette_use_system_accent (self->palette),
+                          checksum);
+}
+
+static char *
+ptyxis_window_dressing_build_css (PtyxisWindowDressing *self,
+                                  const char           *css_class,
+                                  gboolean              dark)
 {
   g_autoptr(GString) string = NULL;
 
   g_assert (PTYXIS_IS_WINDOW_DRESSING (self));
+  g_assert (css_class != NULL);
 
   string = g_string_new (NULL);
 
   if (self->palette != NULL)
     {
       PtyxisSettings *settings = ptyxis_application_get_settings (PTYXIS_APPLICATION_DEFAULT);
-      AdwStyleManager *style_manager = adw_style_manager_get_default ();
-      gboolean dark = adw_style_manager_get_dark (style_manager);
       const PtyxisPaletteFace *face = ptyxis_palette_get_face (self->palette, dark);
       g_autofree char *bg = NULL;
       g_autofree char *fg = NULL;
@@ -114,70 +195,70 @@ ptyxis_window_dressing_update (PtyxisWindowDressing *self)
 
       g_string_append_printf (string,
                               "window.%s { color: %s; background-color: alpha(%s, %s); }\n",
-                              self->css_class, fg, bg, window_alpha_str);
+                              css_class, fg, bg, window_alpha_str);
       g_string_append_printf (string,
                               "window.%s .window-contents popover > contents { color: %s; background-color: alpha(%s, %s); }\n",
-                              self->css_class, titlebar_fg, titlebar_bg, popover_alpha_str);
+                              css_class, titlebar_fg, titlebar_bg, popover_alpha_str);
       g_string_append_printf (string,
                               "window.%s .window-contents popover > arrow { background-color: alpha(%s, %s); }\n",
-                              self->css_class, titlebar_bg, popover_alpha_str);
+                              css_class, titlebar_bg, popover_alpha_str);
       g_string_append_printf (string,
                               "window.%s .window-contents vte-terminal > revealer.size label { color: %s; background-color: %s; }\n",
-                              self->css_class, titlebar_fg, revealer_bg);
+                              css_class, titlebar_fg, revealer_bg);
       /* It would be super if we could make these match the color of the
        * actual tab contents rather than the active tab profile.
        */
       g_string_append_printf (string,
                               "window.%s .window-contents toolbarview.overview overlay.card { background-color: %s; color: %s; }\n",
-                              self->css_class, bg, fg);
+                              css_class, bg, fg);
       g_string_append_printf (string,
                               "window.%s .window-contents toolbarview.overview tabthumbnail .icon-title-box { color: %s; }\n",
-                              self->css_class, fg);
+                              css_class, fg);
       g_string_append_printf (string,
                               "window.%s .window-contents toolbarview.overview { background-color: %s; color: %s; }\n",
-                              self->css_class, titlebar_bg, titlebar_fg);
+                              css_class, titlebar_bg, titlebar_fg);
       g_string_append_printf (string,
                               "window.%s .window-contents revealer.raised.top-bar { background-color: %s; color: %s; }\n",
-                              self->css_class, titlebar_bg, titlebar_fg);
+                              css_class, titlebar_bg, titlebar_fg);
       g_string_append_printf (string,
                               "window.%s .window-contents box.visual-bell headerbar { background-color: transparent; }\n"
                               "window.%s .window-contents box.visual-bell { animation: visual-bell-%s-%s 0.3s ease-out; }\n"
                               "@keyframes visual-bell-%s-%s { 50%% { background-color: %s; color: %s; } }\n",
-                              self->css_class,
-                              self->css_class, self->css_class, dark ? "dark" : "light",
-                              self->css_class, dark ? "dark" : "light", bell_bg, bell_fg);
+                              css_class,
+                              css_class, css_class, dark ? "dark" : "light",
+                              css_class, dark ? "dark" : "light", bell_bg, bell_fg);
       g_string_append_printf (string,
                               "window.%s .window-contents banner > revealer > widget { background-color: %s; color: %s; }\n",
-                              self->css_class, bell_bg, bell_fg);
+                              css_class, bell_bg, bell_fg);
       g_string_append_printf (string,
                               "window.%s taboverview.window-contents tabthumbnail button { background-color: alpha(%s,.15); color: %s; }\n"
                               "window.%s taboverview.window-contents tabthumbnail button:hover { background-color: alpha(%s,.25); }\n"
                               "window.%s taboverview.window-contents tabthumbnail button:active { background-color: alpha(%s,.55); }\n",
-                              self->css_class, fg, fg,
-                              self->css_class, fg,
-                              self->css_class, fg);
+                              css_class, fg, fg,
+                              css_class, fg,
+                              css_class, fg);
 
       visual_process_leader = ptyxis_settings_get_visual_process_leader (settings);
 
       g_string_append_printf (string,
                               "window.%s .window-contents > revealer windowhandle { color: %s; background-color: %s; }\n",
-                              self->css_class, titlebar_fg, titlebar_bg);
+                              css_class, titlebar_fg, titlebar_bg);
       g_string_append_printf (string,
                               "window.%s:backdrop .window-contents revealer > windowhandle { color: mix(%s,%s,.025); background-color: mix(%s,%s,.99); }\n",
-                              self->css_class, fg, bg, fg, bg);
+                              css_class, fg, bg, fg, bg);
 
       if (visual_process_leader)
         {
           g_string_append_printf (string,
                                   "window.%s.remote .window-contents headerbar { background-color: %s; color: %s; }\n"
                                   "window.%s.remote .window-contents toolbarview > revealer > windowhandle { background-color: %s; color: %s; }\n",
-                                  self->css_class, rm_bg, rm_fg,
-                                  self->css_class, rm_bg, rm_fg);
+                                  css_class, rm_bg, rm_fg,
+                                  css_class, rm_bg, rm_fg);
           g_string_append_printf (string,
                                   "window.%s.superuser .window-contents headerbar { background-color: %s; color: %s; }\n"
                                   "window.%s.superuser .window-contents toolbarview > revealer > windowhandle { background-color: %s; color: %s; }\n",
-                                  self->css_class, su_bg, su_fg,
-                                  self->css_class, su_bg, su_fg);
+                                  css_class, su_bg, su_fg,
+                                  css_class, su_bg, su_fg);
         }
 
       if (!ptyxis_palette_use_system_accent (self->palette))
@@ -187,14 +268,77 @@ ptyxis_window_dressing_update (PtyxisWindowDressing *self)
 
           g_string_append_printf (string,
                                   "window.%s { --accent-fg-color: %s; --accent-bg-color: mix(%s,%s,.15); }\n",
-                                  self->css_class,
+                                  css_class,
                                   dark ? titlebar_fg : titlebar_bg,
                                   accent_mix_str,
                                   bg);
         }
     }
 
-  gtk_css_provider_load_from_string (self->css_provider, string->str);
+  return g_string_free (g_steal_pointer (&string), FALSE);
+}
+
+static void
+ptyxis_window_dressing_update (PtyxisWindowDressing *self)
+{
+  g_autoptr(PtyxisWindow) window = NULL;
+  g_autofree char *key = NULL;
+  PtyxisDressingStyle *style;
+  gboolean dark;
+
+  g_assert (PTYXIS_IS_WINDOW_DRESSING (self));
+
+  dark = adw_style_manager_get_dark (adw_style_manager_get_default ());
+  key = ptyxis_window_dressing_build_key (self, dark);
+
+  if (self->style != NULL && g_str_equal (key, self->style->key))
+    return;
+
+  if (styles == NULL)
+    styles = g_hash_table_new_full (g_str_hash,
+                                    g_str_equal,
+                                    NULL,
+                                    (GDestroyNotify)ptyxis_dressing_style_free);
+
+  if ((style = g_hash_table_lookup (styles, key)))
+    {
+      if (style->n_users == 0)
+        {
+          g_queue_remove (&unused_styles, style);
+          gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                                      GTK_STYLE_PROVIDER (style->css_provider),
+                                                      GTK_STYLE_PROVIDER_PRIORITY_USER + 1);
+        }
+    }
+  else
+    {
+      g_autofree char *css = NULL;
+
+      style = g_new0 (PtyxisDressingStyle, 1);
+      style->key = g_steal_pointer (&key);
+      style->css_class = g_strdup_printf ("window-dressing-%u", ++last_sequence);
+      style->css_provider = gtk_css_provider_new ();
+
+      css = ptyxis_window_dressing_build_css (self, style->css_class, dark);
+      gtk_css_provider_load_from_string (style->css_provider, css);
+
+      gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                                  GTK_STYLE_PROVIDER (style->css_provider),
+                                                  GTK_STYLE_PROVIDER_PRIORITY_USER + 1);
+      g_hash_table_insert (styles, style->key, style);
+    }
+
+  style->n_users++;
+
+  if ((window = ptyxis_window_dressing_dup_window (self)))
+    {
+      if (self->style != NULL)
+        gtk_widget_remove_css_class (GTK_WIDGET (window), self->style->css_class);
+      gtk_widget_add_css_class (GTK_WIDGET (window), style->css_class);
+    }
+
+  g_clear_pointer (&self->style, ptyxis_dressing_style_release);
+  self->style = style;
 }
 
 static gboolean
@@ -229,7 +373,8 @@ ptyxis_window_dressing_set_window (PtyxisWindowDressing *self,
 
   g_weak_ref_set (&self->window_wr, window);
 
-  gtk_widget_add_css_class (GTK_WIDGET (window), self->css_class);
+  if (self->style != NULL)
+    gtk_widget_add_css_class (GTK_WIDGET (window), self->style->css_class);
 }
 
 static void
@@ -247,10 +392,6 @@ ptyxis_window_dressing_constructed (GObject *object)
                            self,
                            G_CONNECT_SWAPPED);
 
-  gtk_style_context_add_provider_for_display (gdk_display_get_default (),
-                                              GTK_STYLE_PROVIDER (self->css_provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_USER + 1);
-
   g_signal_connect_object (style_manager,
                            "notify::dark",
                            G_CALLBACK (ptyxis_window_dressing_queue_update),
@@ -272,11 +413,15 @@ ptyxis_window_dressing_dispose (GObject *object)
 
   ptyxis_window_dressing_set_palette (self, NULL);
 
-  if (self->css_provider != NULL) {
-    gtk_style_context_remove_provider_for_display (gdk_display_get_default (),
-                                                   GTK_STYLE_PROVIDER (self->css_provider));
-    g_clear_object (&self->css_provider);
-  }
+  if (self->style != NULL)
+    {
+      g_autoptr(PtyxisWindow) window = ptyxis_window_dressing_dup_window (self);
+
+      if (window != NULL)
+        gtk_widget_remove_css_class (GTK_WIDGET (window), self->style->css_class);
+
+      g_clear_pointer (&self->style, ptyxis_dressing_style_release);
+    }
 
   g_clear_object (&self->palette);
   g_weak_ref_set (&self->window_wr, NULL);
@@ -292,11 +437,10 @@ ptyxis_window_dressing_finalize (GObject *object)
   PtyxisWindowDressing *self = (PtyxisWindowDressing *)object;
 
   g_weak_ref_clear (&self->window_wr);
-  g_clear_pointer (&self->css_class, g_free);
 
   g_assert (self->palette == NULL);
   g_assert (self->queued_update == 0);
-  g_assert (self->css_provider == NULL);
+  g_assert (self->style == NULL);
 
   G_OBJECT_CLASS (ptyxis_window_dressing_parent_class)->finalize (object);
 }
@@ -393,8 +537,6 @@ ptyxis_window_dressing_class_init (PtyxisWindowDressingClass *klass)
 static void
 ptyxis_window_dressing_init (PtyxisWindowDressing *self)
 {
-  self->css_provider = gtk_css_provider_new ();
-  self->css_class = g_strdup_printf ("window-dressing-%u", ++last_sequence);
   self->opacity = 1.0;
 
   g_weak_ref_init (&self->window_wr, NULL);
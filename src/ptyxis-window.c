@@ -38,6 +38,9 @@
 #include "ptyxis-window.h"
 #include "ptyxis-window-dressing.h"
 
+#define PREFETCH_DELAY_MSEC  250
+#define PREFETCH_BUDGET_USEC 4000
+
 struct _PtyxisWindow
 {
   AdwApplicationWindow   parent_instance;
@@ -66,12 +69,15 @@ struct _PtyxisWindow
   GBindingGroup         *profile_bindings;
   GBindingGroup         *active_tab_bindings;
   GSignalGroup          *active_tab_signals;
+  GSignalGroup          *active_terminal_signals;
   GSignalGroup          *selected_page_signals;
   PtyxisWindowDressing  *dressing;
   GtkBox                *visual_bell;
 
   guint                  visual_bell_source;
   guint                  focus_active_tab_source;
+  guint                  prefetch_source;
+  guint                  prefetch_step;
 
   guint                  tab_overview_animating : 1;
   guint                  disposed : 1;
@@ -427,11 +433,100 @@ bind_title_cb (GBinding     *binding,
   return TRUE;
 }
 
+static void
+ptyxis_window_cancel_prefetch (PtyxisWindow *self)
+{
+  g_assert (PTYXIS_IS_WINDOW (self));
+
+  g_clear_handle_id (&self->prefetch_source, g_source_remove);
+}
+
+static gboolean
+ptyxis_window_prefetch_cb (gpointer user_data)
+{
+  static const int offsets[] = { 1, -1 };
+  PtyxisWindow *self = user_data;
+  AdwTabPage *selected;
+  int n_pages;
+
+  g_assert (PTYXIS_IS_WINDOW (self));
+
+  selected = adw_tab_view_get_selected_page (self->tab_view);
+  n_pages = adw_tab_view_get_n_pages (self->tab_view);
+
+  /* Warm the tab after the selected one first since that is where
+   * Ctrl+PageDown goes. Only one tab is resized per dispatch so that
+   * the frame clock gets a chance to run in between.
+   */
+  while (selected != NULL && self->prefetch_step < G_N_ELEMENTS (offsets))
+    {
+      PtyxisTab *active_tab = PTYXIS_TAB (adw_tab_page_get_child (selected));
+      AdwTabPage *page;
+      gint64 begin;
+      int position;
+
+      position = adw_tab_view_get_page_position (self->tab_view, selected)
+               + offsets[self->prefetch_step++];
+
+      if (position < 0 || position >= n_pages)
+        continue;
+
+      page = adw_tab_view_get_nth_page (self->tab_view, position);
+      begin = g_get_monotonic_time ();
+
+      if (_ptyxis_tab_prefetch (PTYXIS_TAB (adw_tab_page_get_child (page)), active_tab))
+        {
+          /* Reflowing a large scrollback can take longer than a frame.
+           * If it did, do not risk a second hitch on the other side.
+           */
+          if (g_get_monotonic_time () - begin > PREFETCH_BUDGET_USEC)
+            break;
+
+          return G_SOURCE_CONTINUE;
+        }
+    }
+
+  self->prefetch_source = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ptyxis_window_queue_prefetch (PtyxisWindow *self)
+{
+  g_assert (PTYXIS_IS_WINDOW (self));
+
+  g_clear_handle_id (&self->prefetch_source, g_source_remove);
+
+  self->prefetch_step = 0;
+  self->prefetch_source = g_timeout_add_full (G_PRIORITY_LOW,
+                                              PREFETCH_DELAY_MSEC,
+                                              ptyxis_window_prefetch_cb,
+                                              self, NULL);
+}
+
+static gboolean
+ptyxis_window_key_pressed_cb (PtyxisWindow          *self,
+                              guint                  keyval,
+                              guint                  keycode,
+                              GdkModifierType        state,
+                              GtkEventControllerKey *controller)
+{
+  g_assert (PTYXIS_IS_WINDOW (self));
+  g_assert (GTK_IS_EVENT_CONTROLLER_KEY (controller));
+
+  ptyxis_window_cancel_prefetch (self);
+
+  return GDK_EVENT_PROPAGATE;
+}
+
 static void
 ptyxis_window_notify_selected_page_cb (PtyxisWindow *self,
                                        GParamSpec   *pspec,
                                        AdwTabView   *tab_view)
 {
+  g_autoptr(GPropertyAction) broadcast_group = NULL;
+  g_autoptr(GPropertyAction) broadcast_input = NULL;
   g_autoptr(GPropertyAction) read_only = NULL;
   PtyxisTerminal *terminal = NULL;
   AdwTabPage *page = NULL;
@@ -455,8 +550,11 @@ ptyxis_window_notify_selected_page_cb (PtyxisWindow *self,
       terminal = ptyxis_tab_get_terminal (tab);
 
       g_signal_group_set_target (self->active_tab_signals, tab);
+      g_signal_group_set_target (self->active_terminal_signals, terminal);
 
       read_only = g_property_action_new ("tab.read-only", tab, "read-only");
+      broadcast_group = g_property_action_new ("tab.broadcast-group", tab, "broadcast-group");
+      broadcast_input = g_property_action_new ("tab.broadcast-input", tab, "broadcast-input");
 
       adw_tab_page_set_needs_attention (page, FALSE);
 
@@ -465,6 +563,8 @@ ptyxis_window_notify_selected_page_cb (PtyxisWindow *self,
 
   if (terminal == NULL)
     {
+      ptyxis_window_cancel_prefetch (self);
+      g_signal_group_set_target (self->active_terminal_signals, NULL);
       gtk_revealer_set_reveal_child (self->find_bar_revealer, FALSE);
       gtk_window_set_title (GTK_WINDOW (self), ptyxis_app_name ());
     }
@@ -484,10 +584,21 @@ ptyxis_window_notify_selected_page_cb (PtyxisWindow *self,
   if (read_only != NULL)
     g_action_map_add_action (G_ACTION_MAP (self), G_ACTION (read_only));
 
+  g_action_map_remove_action (G_ACTION_MAP (self), "tab.broadcast-group");
+  if (broadcast_group != NULL)
+    g_action_map_add_action (G_ACTION_MAP (self), G_ACTION (broadcast_group));
+
+  g_action_map_remove_action (G_ACTION_MAP (self), "tab.broadcast-input");
+  if (broadcast_input != NULL)
+    g_action_map_add_action (G_ACTION_MAP (self), G_ACTION (broadcast_input));
+
   g_binding_group_set_source (self->active_tab_bindings, tab);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ACTIVE_TAB]);
 
+  if (has_page)
+    ptyxis_window_queue_prefetch (self);
+
   ptyxis_fullscreen_box_reveal (self->fullscreen_box);
 }
 
@@ -534,6 +645,19 @@ ptyxis_window_apply_current_settings (PtyxisWindow *self,
     }
 }
 
+static PtyxisTab *
+ptyxis_window_create_tab (PtyxisProfile *profile)
+{
+  PtyxisTabPool *tab_pool;
+
+  g_assert (PTYXIS_IS_PROFILE (profile));
+
+  if ((tab_pool = ptyxis_application_get_tab_pool (PTYXIS_APPLICATION_DEFAULT)))
+    return ptyxis_tab_pool_take (tab_pool, profile);
+
+  return ptyxis_tab_new (profile);
+}
+
 static PtyxisProfile *
 ptyxis_window_dup_profile_for_param (PtyxisWindow *self,
                                      const char   *profile_uuid)
@@ -569,7 +693,7 @@ ptyxis_window_tab_overview_create_tab_cb (PtyxisWindow   *self,
   g_assert (ADW_IS_TAB_OVERVIEW (tab_overview));
 
   profile = ptyxis_window_dup_profile_for_param (self, "default");
-  tab = ptyxis_tab_new (profile);
+  tab = ptyxis_window_create_tab (profile);
 
   ptyxis_window_add_tab (self, tab);
   ptyxis_window_set_active_tab (self, tab);
@@ -595,7 +719,7 @@ ptyxis_window_new_tab_action (GtkWidget  *widget,
   g_variant_get (param, "(&s&s)", &profile_uuid, &container_id);
   profile = ptyxis_window_dup_profile_for_param (self, profile_uuid);
 
-  tab = ptyxis_tab_new (profile);
+  tab = ptyxis_window_create_tab (profile);
   ptyxis_window_apply_current_settings (self, tab);
 
   if (!ptyxis_str_empty0 (container_id))
@@ -635,7 +759,7 @@ ptyxis_window_new_window_action (GtkWidget  *widget,
 
   settings = ptyxis_application_get_settings (PTYXIS_APPLICATION_DEFAULT);
 
-  tab = ptyxis_tab_new (profile);
+  tab = ptyxis_window_create_tab (profile);
   ptyxis_window_apply_current_settings (self, tab);
 
   if (!ptyxis_str_empty0 (container_id))
@@ -1130,14 +1254,20 @@ ptyxis_window_undo_close_tab_action (GtkWidget  *widget,
 
   g_assert (PTYXIS_IS_WINDOW (self));
 
+  /* Prefer tabs which are still alive in the parking lot. Otherwise fall
+   * back to recreating a tab from the history of expired tabs.
+   */
   if ((tab = ptyxis_parking_lot_pop (self->parking_lot)))
     {
       if (!ptyxis_tab_is_running (tab, NULL))
         ptyxis_tab_show_banner (tab);
-      ptyxis_window_add_tab (self, tab);
-      ptyxis_window_set_active_tab (self, tab);
-      gtk_widget_grab_focus (GTK_WIDGET (tab));
     }
+  else if (!(tab = ptyxis_parking_lot_restore (self->parking_lot)))
+    return;
+
+  ptyxis_window_add_tab (self, tab);
+  ptyxis_window_set_active_tab (self, tab);
+  gtk_widget_grab_focus (GTK_WIDGET (tab));
 }
 
 static void
@@ -1542,10 +1672,12 @@ ptyxis_window_dispose (GObject *object)
   gtk_widget_dispose_template (GTK_WIDGET (self), PTYXIS_TYPE_WINDOW);
 
   g_signal_group_set_target (self->active_tab_signals, NULL);
+  g_signal_group_set_target (self->active_terminal_signals, NULL);
   g_binding_group_set_source (self->active_tab_bindings, NULL);
   g_binding_group_set_source (self->profile_bindings, NULL);
   g_signal_group_set_target (self->selected_page_signals, NULL);
   g_clear_handle_id (&self->focus_active_tab_source, g_source_remove);
+  g_clear_handle_id (&self->prefetch_source, g_source_remove);
   g_clear_object (&self->parking_lot);
 
   G_OBJECT_CLASS (ptyxis_window_parent_class)->dispose (object);
@@ -1558,6 +1690,7 @@ ptyxis_window_finalize (GObject *object)
 
   g_clear_object (&self->active_tab_bindings);
   g_clear_object (&self->active_tab_signals);
+  g_clear_object (&self->active_terminal_signals);
   g_clear_object (&self->profile_bindings);
   g_clear_object (&self->selected_page_signals);
 
@@ -1705,6 +1838,7 @@ static void
 ptyxis_window_init (PtyxisWindow *self)
 {
   g_autoptr(GIcon) default_icon = NULL;
+  GtkEventControllerKey *key;
   GtkGestureClick *click;
 
   self->active_tab_bindings = g_binding_group_new ();
@@ -1744,6 +1878,14 @@ ptyxis_window_init (PtyxisWindow *self)
                                  self,
                                  G_CONNECT_SWAPPED);
 
+  /* Any output in the visible tab means it is busy, so stop warming */
+  self->active_terminal_signals = g_signal_group_new (PTYXIS_TYPE_TERMINAL);
+  g_signal_group_connect_object (self->active_terminal_signals,
+                                 "contents-changed",
+                                 G_CALLBACK (ptyxis_window_cancel_prefetch),
+                                 self,
+                                 G_CONNECT_SWAPPED);
+
   self->parking_lot = ptyxis_parking_lot_new ();
 
   self->shortcuts = g_object_ref (ptyxis_application_get_shortcuts (PTYXIS_APPLICATION_DEFAULT));
@@ -1785,6 +1927,17 @@ ptyxis_window_init (PtyxisWindow *self)
                            G_CONNECT_SWAPPED);
   gtk_widget_add_controller (GTK_WIDGET (self->tab_bar),
                              GTK_EVENT_CONTROLLER (g_steal_pointer (&click)));
+
+  key = GTK_EVENT_CONTROLLER_KEY (gtk_event_controller_key_new ());
+  gtk_event_controller_set_propagation_phase (GTK_EVENT_CONTROLLER (key),
+                                              GTK_PHASE_CAPTURE);
+  g_signal_connect_object (key,
+                           "key-pressed",
+                           G_CALLBACK (ptyxis_window_key_pressed_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+  gtk_widget_add_controller (GTK_WIDGET (self),
+                             GTK_EVENT_CONTROLLER (g_steal_pointer (&key)));
 }
 
 PtyxisTab *
@@ -1806,7 +1959,7 @@ ptyxis_window_add_tab_for_command (PtyxisWindow       *self,
       profile = default_profile;
     }
 
-  tab = ptyxis_tab_new (profile);
+  tab = ptyxis_window_create_tab (profile);
   ptyxis_tab_set_command (tab, argv);
 
   if (!ptyxis_str_empty0 (cwd_uri))
@@ -1848,7 +2001,7 @@ ptyxis_window_new_for_profile_and_command (PtyxisProfile      *profile,
                        "application", PTYXIS_APPLICATION_DEFAULT,
                        NULL);
 
-  tab = ptyxis_tab_new (profile);
+  tab = ptyxis_window_create_tab (profile);
   terminal = ptyxis_tab_get_terminal (tab);
 
   if (ptyxis_settings_get_restore_window_size (settings))